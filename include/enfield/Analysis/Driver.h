@@ -5,8 +5,12 @@
 
 #include <iostream>
 #include <string>
+#include <functional>
 
 namespace efd {
+    /// \brief Receives a chunk of top-level statements, in program order.
+    typedef std::function<void(NDStmtList::uRef)> ChunkHandler;
+
     struct ASTWrapper {
         // The parser input
         std::string mFile;
@@ -16,12 +20,40 @@ namespace efd {
         Node::Ref mAST;
         // Has parsed standard library
         bool mStdLibParsed;
+
+        // If set, the top-level statements are handed to it in chunks of
+        // mChunkSize statements, instead of being kept in mAST.
+        ChunkHandler mChunkHandler;
+        uint32_t mChunkSize;
     };
 
     /// \brief Parse \p filename at \p path.
     Node::uRef ParseFile(std::string filename, std::string path = "./", bool forceStdLib = true);
     /// \brief Parse the string \p program.
     Node::uRef ParseString(std::string program, bool forceStdLib = true);
+    /// \brief Parse \p filename at \p path, using \p threads threads.
+    ///
+    /// The file is split into (at most) \p threads chunks, at the end of top-level
+    /// statements. Each of them is parsed by its own scanner and parser in a
+    /// different thread. Then, their statements are joined, in order.
+    Node::uRef ParseFileParallel(std::string filename, std::string path,
+            uint32_t threads, bool forceStdLib = true);
+    /// \brief Parse \p filename at \p path, handing its top-level statements
+    /// to \p handler in chunks of (at most) \p chunkSize statements.
+    ///
+    /// Each chunk is handed as soon as it is parsed, so that the whole program
+    /// is never kept in memory. The returned AST has no statements left. It is
+    /// nullptr if the parsing failed.
+    Node::uRef ParseFileInChunks(std::string filename, std::string path,
+            uint32_t chunkSize, ChunkHandler handler, bool forceStdLib = true);
+
+    /// \brief Returns true if \p file is one of the embedded standard library files.
+    bool IsStdLib(std::string file);
+    /// \brief Returns the AST of the embedded standard library file \p file.
+    ///
+    /// The standard library is parsed only once per process, and the AST
+    /// returned is shared. Clone it before modifying it.
+    Node::Ref GetStdLibAST(std::string file);
 };
 
 #endif
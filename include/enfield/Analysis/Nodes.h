@@ -500,6 +500,7 @@ namespace efd {
         public:
             typedef NDGateSign* Ref;
             typedef std::unique_ptr<NDGateSign> uRef;
+            typedef std::shared_ptr<NDGateSign> sRef;
 
         protected:
             enum ChildType {
@@ -1053,7 +1054,7 @@ bool efd::NDValue<T>::ClassOf(const Node* node) {
 
 template <typename T>
 typename efd::NDValue<T>::uRef efd::NDValue<T>::Create(T val) {
-    return uRef(new NDValue<T>(val));
+    return uRef(new NDValue<T>(std::move(val)));
 }
 
 #endif
@@ -0,0 +1,53 @@
+#ifndef __EFD_ARCH_CACHE_H__
+#define __EFD_ARCH_CACHE_H__
+
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Support/ExpTSFinder.h"
+
+#include <mutex>
+
+namespace efd {
+    /// \brief Data that depends only on the architecture, and that the allocators
+    /// compute before allocating (e.g.: distances and token swapping tables).
+    ///
+    /// Each piece is computed lazily, only once, and is read-only afterwards. So,
+    /// one instance may be shared by every allocator of the same architecture,
+    /// even by the ones running in other threads.
+    class ArchCache {
+        public:
+            typedef ArchCache* Ref;
+            typedef std::shared_ptr<ArchCache> sRef;
+
+            typedef std::vector<std::vector<uint32_t>> Matrix;
+
+        private:
+            ArchGraph::sRef mArch;
+
+            std::once_flag mDistanceFlag;
+            Matrix mDistance;
+
+            std::once_flag mExpTSFinderFlag;
+            ExpTSFinder::uRef mExpTSFinder;
+
+        public:
+            ArchCache(ArchGraph::sRef arch);
+
+            /// \brief Returns the architecture graph.
+            ArchGraph::sRef getArchGraph() const;
+
+            /// \brief Returns the (undirected) distance between every pair of
+            /// physical qubits.
+            const Matrix& getDistance();
+            /// \brief Returns a shortest (undirected) path from \p u to \p v,
+            /// including both. It is empty if there is no such path.
+            std::vector<uint32_t> getPath(uint32_t u, uint32_t v);
+            /// \brief Returns a token swap finder with the optimal swaps between
+            /// every pair of permutations (only for small architectures).
+            ExpTSFinder& getExpTSFinder();
+
+            /// \brief Creates an instance of this class.
+            static sRef Create(ArchGraph::sRef arch);
+    };
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef __EFD_ALLOCATION_COUNTER_H__
+#define __EFD_ALLOCATION_COUNTER_H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace efd {
+    /// \brief Counts the memory allocated by each thread.
+    ///
+    /// Nothing is counted by itself: the allocation functions must be hooked,
+    /// so that they call \em Record (e.g.: the global operator new of the tools,
+    /// in tools/AllocationHooks.cpp). Deallocations are not tracked.
+    class AllocationCounter {
+        public:
+            /// \brief What was allocated by one thread, so far.
+            struct Counts {
+                uint64_t mBytes;
+                uint64_t mAllocations;
+            };
+
+            AllocationCounter() = delete;
+
+            /// \brief Records an allocation of \p bytes by this thread.
+            static void Record(std::size_t bytes);
+            /// \brief Returns what was allocated by this thread, so far.
+            static Counts Get();
+            /// \brief Returns true if any allocation was ever recorded.
+            static bool IsHooked();
+    };
+}
+
+#endif
@@ -2,12 +2,17 @@
 #define __EFD_GRAPH_H__
 
 #include <set>
+#include <string>
 #include <vector>
 #include <unordered_map>
 #include <memory>
 
 namespace efd {
     /// \brief Graph representation.
+    ///
+    /// Besides the successor and predecessor sets, the adjacency is kept in a
+    /// flat bitset (one bit per ordered pair of vertices), so that \em hasEdge
+    /// is O(1).
     class Graph {
         public:
             typedef Graph* Ref;
@@ -29,6 +34,7 @@ namespace efd {
 
             std::vector<std::set<uint32_t>> mSuccessors;
             std::vector<std::set<uint32_t>> mPredecessors;
+            std::vector<bool> mAdjacency;
 
             Graph(Kind k, uint32_t n, Type ty = Undirected);
 
@@ -56,7 +62,7 @@ namespace efd {
             /// an edge (j, i) in the predecessor's list.
             void putEdge(uint32_t i, uint32_t j);
             /// \brief Returns true whether it has an edge (i, j).
-            bool hasEdge(uint32_t i, uint32_t j); 
+            bool hasEdge(uint32_t i, uint32_t j) const;
 
             /// \brief Returns true if this is a weighted graph.
             bool isWeighted() const;
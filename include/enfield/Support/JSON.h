@@ -0,0 +1,14 @@
+#ifndef __EFD_JSON_H__
+#define __EFD_JSON_H__
+
+#include <string>
+
+namespace efd {
+    /// \brief Returns \p str as a (quoted) JSON string.
+    ///
+    /// Quotes, backslashes and control characters are escaped, so that
+    /// the result is always valid JSON.
+    std::string ToJSONString(const std::string& str);
+}
+
+#endif
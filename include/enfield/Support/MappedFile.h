@@ -0,0 +1,55 @@
+#ifndef __EFD_MAPPED_FILE_H__
+#define __EFD_MAPPED_FILE_H__
+
+#include <streambuf>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+namespace efd {
+    /// \brief Read-only memory mapping of a whole file.
+    ///
+    /// The file contents are accessed in place, i.e.: nothing is read into
+    /// memory until it is actually touched. The mapping is released when
+    /// this object is destroyed.
+    ///
+    /// Files that can't be mapped (e.g.: pipes and /dev/stdin) are read
+    /// into memory instead.
+    class MappedFile {
+        public:
+            typedef MappedFile* Ref;
+            typedef std::unique_ptr<MappedFile> uRef;
+
+        private:
+            const char* mData;
+            std::size_t mSize;
+            bool mIsMapped;
+            std::string mBuffer;
+
+            MappedFile(const char* data, std::size_t size);
+            MappedFile(std::string buffer);
+
+        public:
+            ~MappedFile();
+
+            /// \brief Returns a pointer to the beginning of the mapped file.
+            const char* data() const;
+            /// \brief Returns the size (in bytes) of the mapped file.
+            std::size_t size() const;
+
+            /// \brief Maps the file \p filepath into memory.
+            ///
+            /// Returns nullptr if it could not be opened (\em errno is set).
+            static uRef Open(std::string filepath);
+    };
+
+    /// \brief A std::streambuf that reads directly from a memory region.
+    ///
+    /// The region is not copied, so it must outlive this buffer.
+    class MemoryStreamBuf : public std::streambuf {
+        public:
+            MemoryStreamBuf(const char* data, std::size_t size);
+    };
+}
+
+#endif
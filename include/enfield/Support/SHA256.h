@@ -0,0 +1,40 @@
+#ifndef __EFD_SHA256_H__
+#define __EFD_SHA256_H__
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace efd {
+    /// \brief Incremental SHA-256 (FIPS 180-4) digest.
+    ///
+    /// Used for content addressing (e.g.: the keys of the \em CompilationCache),
+    /// where a collision would mean returning the wrong contents.
+    class SHA256 {
+        private:
+            uint32_t mState[8];
+            uint64_t mLength;
+            unsigned char mBlock[64];
+            uint32_t mBlockSize;
+
+            void compress(const unsigned char* block);
+
+        public:
+            SHA256();
+
+            /// \brief Appends \p size bytes of \p data to the message.
+            void update(const char* data, std::size_t size);
+            /// \brief Appends \p data to the message.
+            void update(const std::string& data);
+
+            /// \brief Finishes the message, and returns its digest in hexadecimal.
+            ///
+            /// Nothing should be appended afterwards.
+            std::string finish();
+
+            /// \brief Returns the digest of \p data, in hexadecimal.
+            static std::string Digest(const std::string& data);
+    };
+}
+
+#endif
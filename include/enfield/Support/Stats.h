@@ -3,9 +3,63 @@
 
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <vector>
+#include <map>
 
 namespace efd {
     class StatsPool;
+    class StatsContext;
+
+    /// \brief The formats in which the stats may be printed.
+    ///
+    /// In the text format, each line is 'value::name::description'. The JSON
+    /// format is an object with the list of every registered stat (zeroes
+    /// included), so that its shape does not depend on the input.
+    enum class StatsFormat { Text, JSON };
+
+    /// \brief Samples of a distribution (e.g.: the size of each swap chain).
+    ///
+    /// All samples are kept, so that the percentiles are exact.
+    class Distribution {
+        private:
+            // Sorted lazily, when a percentile is asked for.
+            mutable std::vector<double> mSamples;
+            mutable bool mSorted;
+
+            void sort() const;
+
+        public:
+            Distribution();
+
+            /// \brief Adds the sample \p val.
+            void add(double val);
+            /// \brief Adds all samples of \p other.
+            void merge(const Distribution& other);
+
+            /// \brief Returns the number of samples.
+            uint32_t size() const;
+            /// \brief Returns true if there is no sample.
+            bool empty() const;
+
+            double getSum() const;
+            double getMin() const;
+            double getMax() const;
+            double getMean() const;
+            /// \brief Returns the \p p-th percentile (from 0 to 100), using the
+            /// nearest-rank method.
+            double getPercentile(double p) const;
+
+            /// \brief Returns the number of samples per power of two bucket,
+            /// i.e.: -1 for [0, 1), 0 for [1, 2), 1 for [2, 4), ...
+            std::map<int32_t, uint32_t> getHistogram() const;
+
+            /// \brief Returns a summary of the samples.
+            /// e.g.: n=12,mean=2.5,p50=2,p90=5,p99=7,max=7
+            std::string toString() const;
+            /// \brief Prints the samples summary (and histogram) as a JSON object.
+            void printJSON(std::ostream& out) const;
+    };
 
     /// \brief Base class for stats.
     class StatBase {
@@ -15,6 +69,8 @@ namespace efd {
         protected:
             std::string mName;
             std::string mDescription;
+            /// \brief Index of this stat in every \em StatsContext.
+            uint32_t mId;
 
         public:
             StatBase(std::string name, std::string description);
@@ -23,24 +79,136 @@ namespace efd {
             std::string getName() const;
             /// \brief Gets the description of the stat.
             std::string getDescription() const;
+            /// \brief Gets the index of the stat.
+            uint32_t getId() const;
 
             virtual bool isZero() const = 0;
+            /// \brief Returns true if this is a \em DistributionStat.
+            virtual bool isDistribution() const;
+            /// \brief Returns the value of the stat, as a double.
+            virtual double getValue() const = 0;
 
             /// \brief Prints the stat in \p out (it prints what \p toString returns).
             void print(std::ostream& out);
             /// \brief Returns a string with the contents of the stat.
             /// e.g.: 35::CNOTNum::Number of CNOT nodes.
             virtual std::string toString() const = 0;
+            /// \brief Returns \p val, as a value of this stat, in a string.
+            virtual std::string format(double val) const = 0;
+    };
+
+    /// \brief The values of every stat, collected by one compilation.
+    ///
+    /// While a context is bound to a thread (see \em StatsScope), every \em Stat
+    /// used by that thread reads and writes the context, instead of its global
+    /// value. A context should be bound to only one thread at a time.
+    class StatsContext {
+        public:
+            typedef StatsContext* Ref;
+            typedef std::shared_ptr<StatsContext> sRef;
+
+        private:
+            std::vector<double> mValues;
+            std::vector<Distribution> mDistributions;
+
+        public:
+            /// \brief Gets the value of the stat \p id.
+            double get(uint32_t id) const;
+            /// \brief Sets the value of the stat \p id.
+            void set(uint32_t id, double val);
+            /// \brief Gets the samples of the distribution stat \p id.
+            Distribution getDistribution(uint32_t id) const;
+            /// \brief Adds \p val to the samples of the distribution stat \p id.
+            void addSample(uint32_t id, double val);
+
+            /// \brief Adds the values of \p other to this context, i.e.: as if both
+            /// compilations were collected by the same context.
+            void merge(const StatsContext& other);
+
+            /// \brief Prints the stats, in the same format as \em PrintStats.
+            void print(std::ostream& out = std::cout,
+                       StatsFormat format = StatsFormat::Text) const;
+
+            /// \brief Returns the context bound to this thread (or nullptr).
+            static Ref GetCurrent();
+            /// \brief Creates an instance of this class.
+            static sRef Create();
+
+            friend class StatsScope;
+    };
+
+    /// \brief Binds a \em StatsContext to this thread, while it is alive.
+    class StatsScope {
+        private:
+            StatsContext::Ref mPrevious;
+
+        public:
+            StatsScope(StatsContext::Ref context);
+            ~StatsScope();
+    };
+
+    /// \brief Aggregation of many \em StatsContext's (e.g.: one per file of a batch).
+    ///
+    /// Besides the sum, the minimum and the maximum of each stat, it keeps a
+    /// histogram of their values in power of two buckets, i.e.: [0, 1), [1, 2),
+    /// [2, 4), [4, 8), ...
+    class StatsAggregate {
+        public:
+            /// \brief What is known about one stat.
+            struct Summary {
+                uint32_t mCount;
+                double mSum;
+                double mMin;
+                double mMax;
+                /// \brief Number of values per bucket.
+                std::map<int32_t, uint32_t> mHistogram;
+            };
+
+        private:
+            std::vector<Summary> mSummaries;
+            std::vector<Distribution> mDistributions;
+            uint32_t mContexts;
+
+        public:
+            StatsAggregate();
+
+            /// \brief Adds the (non-zero) values of \p context.
+            void add(const StatsContext& context);
+            /// \brief Adds everything that was added to \p other.
+            void merge(const StatsAggregate& other);
+
+            /// \brief Returns the number of contexts added.
+            uint32_t getContexts() const;
+            /// \brief Returns the summary of the stat \p id.
+            Summary getSummary(uint32_t id) const;
+            /// \brief Returns all samples of the distribution stat \p id.
+            Distribution getDistribution(uint32_t id) const;
+
+            /// \brief Prints a summary of each stat, with its histogram (the
+            /// text format skips the ones that were always zero).
+            /// e.g.: 35::2::20::17.5::TotalCost::Total cost ...
+            /// (sum, min, max and mean, respectively). Distribution stats are
+            /// printed with all their samples merged.
+            void print(std::ostream& out = std::cout,
+                       StatsFormat format = StatsFormat::Text) const;
     };
 
     /// \brief Stats of a given type.
-    /// 
+    ///
     /// This should be used for collecting statistical results like elapsed time
     /// of some function, or uses of something else.
+    ///
+    /// If the thread has a \em StatsContext, it is used instead of the global
+    /// value. Otherwise, its operations are atomic, since more than one module
+    /// may be compiled at the same time.
     template <typename T>
         class Stat : public StatBase {
             private:
                 T mVal;
+                mutable std::mutex mMutex;
+
+                /// \brief Replaces the value by \p fn(value).
+                template <typename F> void update(F fn);
 
             public:
                 Stat(std::string name, std::string description);
@@ -55,68 +223,121 @@ namespace efd {
                 Stat<T>& operator/=(const T val);
 
                 bool isZero() const override;
+                double getValue() const override;
                 std::string toString() const override;
+                std::string format(double val) const override;
         };
 
+    /// \brief Stat that keeps a \em Distribution of samples, instead of a
+    /// single value (e.g.: the number of candidates of each layer).
+    ///
+    /// As \em Stat, it uses the \em StatsContext of the thread, if any.
+    class DistributionStat : public StatBase {
+        private:
+            Distribution mDistribution;
+            mutable std::mutex mMutex;
+
+        public:
+            DistributionStat(std::string name, std::string description);
+
+            /// \brief Adds the sample \p val.
+            void add(double val);
+            /// \brief Gets a copy of the samples.
+            Distribution getDistribution() const;
+
+            bool isZero() const override;
+            bool isDistribution() const override;
+            double getValue() const override;
+            std::string toString() const override;
+            std::string format(double val) const override;
+    };
+
     /// \brief Usually called in the end of the program, i.e. when all statistical
     /// data have already been collected.
-    void PrintStats(std::ostream& out = std::cout);
+    void PrintStats(std::ostream& out = std::cout, StatsFormat format = StatsFormat::Text);
 }
 
 template <typename T>
 efd::Stat<T>::Stat(std::string name, std::string description) : StatBase(name, description), mVal(0) {
 }
 
+template <typename T>
+template <typename F>
+void efd::Stat<T>::update(F fn) {
+    if (auto context = StatsContext::GetCurrent()) {
+        context->set(mId, fn(static_cast<T>(context->get(mId))));
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mVal = fn(mVal);
+}
+
 template <typename T>
 T efd::Stat<T>::getVal() const {
+    if (auto context = StatsContext::GetCurrent()) {
+        return static_cast<T>(context->get(mId));
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
     return mVal;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator=(const T val) {
-    mVal = val;
+    update([&](T) { return val; });
     return *this;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator+=(const T val) {
-    mVal += val;
+    update([&](T cur) { return cur + val; });
     return *this;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator-=(const T val) {
-    mVal -= val;
+    update([&](T cur) { return cur - val; });
     return *this;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator*=(const T val) {
-    mVal *= val;
+    update([&](T cur) { return cur * val; });
     return *this;
 }
 
 template <typename T>
 efd::Stat<T>& efd::Stat<T>::operator/=(const T val) {
-    mVal /= val;
+    update([&](T cur) { return cur / val; });
     return *this;
 }
 
 template <typename T>
 bool efd::Stat<T>::isZero() const {
     double episilon = 0.00001;
-    double dVal = mVal;
+    double dVal = getVal();
     return dVal >= -episilon && dVal <= episilon;
 }
 
+template <typename T>
+double efd::Stat<T>::getValue() const {
+    return getVal();
+}
+
 template <typename T>
 std::string efd::Stat<T>::toString() const {
     std::string s;
 
-    s += std::to_string(mVal) + "::";
+    s += format(getVal()) + "::";
     s += mName + "::";
     s += mDescription;
     return s;
 }
 
+template <typename T>
+std::string efd::Stat<T>::format(double val) const {
+    return std::to_string(static_cast<T>(val));
+}
+
 #endif
@@ -0,0 +1,55 @@
+#ifndef __EFD_TRACER_H__
+#define __EFD_TRACER_H__
+
+#include <iostream>
+#include <string>
+
+namespace efd {
+    /// \brief Records spans and counters of the compilation, and writes them in
+    /// the Chrome trace-event format (readable by Perfetto and chrome://tracing).
+    ///
+    /// Each thread records into its own buffer, so that it is shown in its own
+    /// track. Nothing is recorded until it is enabled.
+    class Tracer {
+        public:
+            Tracer() = delete;
+
+            /// \brief Starts (or stops) recording.
+            static void Enable(bool enable = true);
+            /// \brief Returns true if the events are being recorded.
+            static bool IsEnabled();
+
+            /// \brief Returns the microseconds elapsed since the tracer was created.
+            static double Now();
+
+            /// \brief Records the span \p name of this thread, from \p begin to \p end.
+            static void AddSpan(const std::string& name, double begin, double end);
+            /// \brief Records that the counter \p name has changed to \p value.
+            static void AddCounter(const std::string& name, double value);
+            /// \brief Names the track of this thread.
+            static void SetThreadName(const std::string& name);
+
+            /// \brief Removes every event recorded.
+            static void Clear();
+            /// \brief Writes the events recorded (as JSON) in \p out.
+            static void Write(std::ostream& out);
+            /// \brief Writes the events recorded in the file \p filepath.
+            static bool Write(const std::string& filepath);
+    };
+
+    /// \brief Records a span of \em Tracer from its construction to its
+    /// destruction, i.e.: the scope where it lives.
+    class TraceSpan {
+        private:
+            bool mEnabled;
+            std::string mName;
+            double mBegin;
+
+        public:
+            TraceSpan(const char* name);
+            TraceSpan(const std::string& name);
+            ~TraceSpan();
+    };
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef __EFD_UNIX_SOCKET_H__
+#define __EFD_UNIX_SOCKET_H__
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace efd {
+    /// \brief A stream socket in the Unix domain, that exchanges whole messages.
+    ///
+    /// Each message is its size (4 bytes, big endian) followed by its bytes.
+    /// The socket is closed when this object is destroyed.
+    class UnixSocket {
+        public:
+            typedef UnixSocket* Ref;
+            typedef std::unique_ptr<UnixSocket> uRef;
+
+            /// \brief Messages larger than this are refused (1 GiB).
+            static const uint32_t MaxMessageSize;
+
+        private:
+            int mFd;
+            std::string mUnlinkPath;
+
+            UnixSocket(int fd, std::string unlinkPath = "");
+
+        public:
+            ~UnixSocket();
+
+            /// \brief Waits for a new connection (only for listening sockets).
+            ///
+            /// Returns nullptr if it failed (\em errno is set).
+            uRef accept();
+
+            /// \brief Sends \p message. Returns false if it failed.
+            bool send(const std::string& message);
+            /// \brief Receives the next message into \p message.
+            ///
+            /// Returns false if the connection was closed (or it failed).
+            bool receive(std::string& message);
+
+            /// \brief Listens for connections at \p path, replacing any socket
+            /// left there. The file is removed when this object is destroyed.
+            ///
+            /// Returns nullptr if it failed (\em errno is set).
+            static uRef Listen(std::string path);
+            /// \brief Connects to the socket listening at \p path.
+            ///
+            /// Returns nullptr if it failed (\em errno is set).
+            static uRef Connect(std::string path);
+    };
+}
+
+#endif
@@ -2,24 +2,33 @@
 #define __EFD_WRAPPER_VAL_H__
 
 #include <string>
+#include <memory>
 
 namespace efd {
 
     /// \brief Wrapper for primitive values
     ///
     /// They are used mainly for keeping the right string representation of the
-    /// primitive values in the program.
+    /// primitive values in the program. In order to keep it compact, the string
+    /// representation is kept only if it is different from the canonical one
+    /// (i.e.: std::to_string of the value). In that case, it is shared by the
+    /// copies of the wrapper (so that copying never copies the string), and freed
+    /// with the last of them.
     template <typename T>
     struct WrapperVal {
         /// \brief The static representation.
         T mV;
-        /// \brief The string representation of the double.
-        std::string mStr;
+        /// \brief The string representation, or nullptr if it is the canonical one.
+        std::shared_ptr<const std::string> mStr;
 
         WrapperVal();
         /// \brief Parses the string to a double value.
         WrapperVal(std::string str);
 
+        /// \brief Returns the string representation of this value.
+        std::string getStr() const;
+
+        /// \brief Compares the values (not their string representation).
         bool operator==(const WrapperVal<T>& rhs) const;
         bool operator!=(const WrapperVal<T>& rhs) const;
     };
@@ -29,15 +38,20 @@ namespace efd {
 
     typedef WrapperVal<long long> IntVal;
     typedef WrapperVal<double> RealVal;
-
 };
 
 template <typename T>
-efd::WrapperVal<T>::WrapperVal() : mStr("") {}
+efd::WrapperVal<T>::WrapperVal() : mV(), mStr(nullptr) {}
+
+template <typename T>
+std::string efd::WrapperVal<T>::getStr() const {
+    if (mStr != nullptr) return *mStr;
+    return std::to_string(mV);
+}
 
 template <typename T>
 bool efd::WrapperVal<T>::operator==(const WrapperVal<T>& rhs) const{
-    return mStr == rhs.mStr;
+    return mV == rhs.mV;
 }
 
 template <typename T>
@@ -49,7 +63,7 @@ namespace std {
     /// \brief Overloading std::to_string to work with efd::WrapperVal.
     template <typename T>
         string to_string(const efd::WrapperVal<T>& val) {
-            return val.mStr;
+            return val.getStr();
         }
 };
 
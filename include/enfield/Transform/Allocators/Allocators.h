@@ -38,9 +38,10 @@ namespace efd {
     bool HasAllocator(EnumAllocator key);
     /// \brief Registers an allocator, mapping \p name to \p ctor.
     void RegisterQbitAllocator(EnumAllocator key, AllocatorRegistry::CtorTy ctor);
-    /// \brief Creates an allocator referenced by \p name with arguments \p arg.
+    /// \brief Creates an allocator referenced by \p name with arguments \p arg,
+    /// tuned by \p options.
     AllocatorRegistry::RetTy CreateQbitAllocator(EnumAllocator key, 
-            AllocatorRegistry::ArgTy arg);
+            AllocatorRegistry::ArgTy arg, AllocatorOptions options = AllocatorOptions());
 
 
 #define EFD_FIRSTLAST(_First_, _Last_)
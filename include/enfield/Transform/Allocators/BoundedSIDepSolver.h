@@ -44,7 +44,7 @@ namespace efd {
             TKSResult process(Mapping& last, Mapping& current);
             uint32_t getNearest(uint32_t u, Assign& assign);
 
-            uint32_t estimateCost(Mapping& previous, Mapping& current, Matrix& distance);
+            uint32_t estimateCost(Mapping& previous, Mapping& current, const Matrix& distance);
 
         public:
             /// \brief Create a new instance of this class.
@@ -22,7 +22,6 @@ namespace efd {
 
             uint32_t mPQubits;
             uint32_t mLQubits;
-            std::vector<std::vector<uint32_t>> mDist;
 
             AllocationResult tryAllocateLayer(Layer& layer, Mapping current,
                                               std::set<uint32_t> qubitsSet,
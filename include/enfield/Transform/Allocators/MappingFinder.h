@@ -13,6 +13,13 @@ namespace efd {
             typedef MappingFinder* Ref;
             typedef std::shared_ptr<MappingFinder> sRef;
 
+        protected:
+            AllocatorOptions mOptions;
+
+        public:
+            /// \brief Sets the tuning knobs of the allocation.
+            void setOptions(AllocatorOptions options) { mOptions = options; }
+
             /// \brief Returns a mapping generated from a set of dependencies.
             virtual Mapping find(ArchGraph::Ref g, DepsSet& deps) = 0;
     };
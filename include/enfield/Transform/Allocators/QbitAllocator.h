@@ -2,6 +2,7 @@
 #define __EFD_QBIT_ALLOCATOR_H__
 
 #include "enfield/Arch/ArchGraph.h"
+#include "enfield/Arch/ArchCache.h"
 #include "enfield/Transform/DependencyBuilderPass.h"
 #include "enfield/Support/CommandLine.h"
 #include "enfield/Support/Stats.h"
@@ -41,6 +42,31 @@ namespace efd {
         uint32_t mCost;
     };
 
+    /// \brief Tuning knobs of the allocators.
+    ///
+    /// Each compilation carries its own (see \em CompilationSettings), so that
+    /// compilations with different options may run at the same time.
+    struct AllocatorOptions {
+        /// \brief Cost of using a swap.
+        uint32_t swapCost;
+        /// \brief Cost of using a reverse edge.
+        uint32_t revCost;
+        /// \brief Cost of using a long cnot.
+        uint32_t lcxCost;
+        /// \brief Seed of the random choices (random and IBM allocators).
+        uint32_t seed;
+        /// \brief Number of times the IBM allocator tries each layer.
+        uint32_t trials;
+        /// \brief Max number of children per partial solution (bounded SI).
+        uint32_t maxChildren;
+        /// \brief Max number of partial solutions per step (bounded SI).
+        uint32_t maxPartialSolutions;
+
+        /// \brief Constructs the default options. The seed is taken from
+        /// the clock.
+        AllocatorOptions();
+    };
+
     /// \brief Base abstract class that allocates the qbits used in the program to
     /// the qbits that are in the physical architecture.
     class QbitAllocator : public PassT<Solution> {
@@ -64,11 +90,16 @@ namespace efd {
             /// the swaps generated by the compiler.
             void renameQbits();
 
+        private:
+            ArchCache::sRef mArchCache;
+
         protected:
             bool mInlineAll;
             ArchGraph::sRef mArchGraph;
             BasisVector mBasis;
             QModule::Ref mMod;
+            AllocatorOptions mOptions;
+            bool mCommute;
 
             uint32_t mVQubits;
             uint32_t mPQubits;
@@ -78,6 +109,10 @@ namespace efd {
             /// \brief Executes the allocation algorithm after the preprocessing.
             virtual Solution executeAllocation(QModule::Ref qmod) = 0;
 
+            /// \brief Returns the cache of the architecture. If none was set, a new
+            /// one is created (and used only by this allocator).
+            ArchCache::Ref getArchCache();
+
         public:
             bool run(QModule::Ref qmod) override;
 
@@ -86,6 +121,18 @@ namespace efd {
             void setInlineAll(BasisVector basis = {});
             /// \brief Flags the QbitAllocator not to inline.
             void setDontInline();
+            /// \brief Sets the cache of the architecture, which may be shared with
+            /// other allocators.
+            void setArchCache(ArchCache::sRef cache);
+
+            /// \brief Sets the tuning knobs of the allocation.
+            void setOptions(AllocatorOptions options);
+            /// \brief Returns the tuning knobs of the allocation.
+            const AllocatorOptions& getOptions() const;
+
+            /// \brief Lets the allocators that are able to reorder the gates
+            /// that commute.
+            void setCommute(bool commute = true);
     };
 
     /// \brief Generates an assignment mapping (maps the architecture's qubits
@@ -104,8 +151,5 @@ namespace efd {
 }
 
 extern efd::Stat<uint32_t> TotalCost;
-extern efd::Opt<uint32_t> SwapCost;
-extern efd::Opt<uint32_t> RevCost;
-extern efd::Opt<uint32_t> LCXCost;
 
 #endif
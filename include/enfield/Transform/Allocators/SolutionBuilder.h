@@ -21,12 +21,18 @@ namespace efd {
             typedef SolutionBuilder* Ref;
             typedef std::shared_ptr<SolutionBuilder> sRef;
 
+        protected:
+            AllocatorOptions mOptions;
+
         public:
             SolutionBuilder() {
                 set(SolutionBuilderOptions::ImproveInitial);
                 set(SolutionBuilderOptions::KeepStats);
             }
 
+            /// \brief Sets the tuning knobs of the allocation.
+            void setOptions(AllocatorOptions options) { mOptions = options; }
+
             /// \brief Constructs a solution (\em QbitAllocator::Solution) from the
             /// mapping \p initial, with \p deps dependencies in the architecture \p g.
             virtual Solution build(Mapping initial, DepsSet& deps, ArchGraph::Ref g) = 0;
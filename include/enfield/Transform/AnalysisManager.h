@@ -0,0 +1,111 @@
+#ifndef __EFD_ANALYSIS_MANAGER_H__
+#define __EFD_ANALYSIS_MANAGER_H__
+
+#include "enfield/Transform/Pass.h"
+#include "enfield/Transform/PassProfiler.h"
+
+#include <unordered_map>
+#include <mutex>
+
+namespace efd {
+    class QModule;
+
+    /// \brief Caches the passes that were run on one \em QModule.
+    ///
+    /// Every \em QModule owns one of these, so the cached passes are freed
+    /// together with it. Different modules may be compiled by different
+    /// threads at the same time.
+    ///
+    /// Every pass is run through the \em PassProfiler.
+    class AnalysisManager {
+        public:
+            typedef AnalysisManager* Ref;
+            typedef std::unique_ptr<AnalysisManager> uRef;
+
+            typedef std::unordered_map<uint8_t*, Pass::sRef> PassMap;
+
+        private:
+            QModule* mMod;
+            PassMap mPasses;
+            // Recursive, since passes may get other passes while running.
+            std::recursive_mutex mMutex;
+
+            AnalysisManager(QModule* qmod);
+
+            /// \brief Removes the non-preserved passes (lock must be held).
+            void invalidateImpl(const PreservedAnalyses& preserved);
+
+        public:
+            /// \brief Removes all cached passes.
+            void clear();
+
+            /// \brief Invalidates the cached passes, except the ones in \p preserved.
+            ///
+            /// Invalidation cascades: a pass whose dependencies are no longer
+            /// cached is invalidated as well.
+            void invalidate(const PreservedAnalyses& preserved = PreservedAnalyses::None());
+
+            /// \brief Returns true if the pass \p T was already run.
+            template <typename T>
+            bool has() {
+                std::lock_guard<std::recursive_mutex> lock(mMutex);
+                return mPasses.find(&T::ID) != mPasses.end();
+            }
+
+            /// \brief Runs the pass \p T.
+            ///
+            /// This will cache the pass run and return it if called without any
+            /// modifications to the module.
+            template <typename T>
+            void run() {
+                std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+                auto it = mPasses.find(&T::ID);
+                if (it != mPasses.end()) {
+                    PassProfiler::RecordHit(it->second.get());
+                    return;
+                }
+
+                Pass::sRef pass = T::Create();
+
+                // The module was modified, so we reset all passes already computed
+                // that were not preserved.
+                if (PassProfiler::Run(pass.get(), mMod)) invalidateImpl(pass->getPreserved());
+                else mPasses[&T::ID] = pass;
+            }
+
+            /// \brief Wrapper that runs a created pass.
+            ///
+            /// Should be used in order to maintain consistent the cached data.
+            template <typename T>
+            void run(T* pass) {
+                std::lock_guard<std::recursive_mutex> lock(mMutex);
+                if (PassProfiler::Run(pass, mMod)) invalidateImpl(pass->getPreserved());
+            }
+
+            /// \brief Gets the pass \p T. If it was not run yet, it runs it.
+            template <typename T>
+            T* get() {
+                std::lock_guard<std::recursive_mutex> lock(mMutex);
+                run<T>();
+                return (T*) mPasses[&T::ID].get();
+            }
+
+            /// \brief Gets a read-only snapshot of the data of the pass \p T.
+            ///
+            /// No copy is made. The snapshot keeps the pass alive, even if it is
+            /// invalidated afterwards.
+            template <typename T>
+            typename T::DataSnapshot getData() {
+                std::lock_guard<std::recursive_mutex> lock(mMutex);
+                run<T>();
+                auto pass = std::static_pointer_cast<T>(mPasses[&T::ID]);
+                return typename T::DataSnapshot(pass, &pass->getData());
+            }
+
+            /// \brief Creates an analysis manager for \p qmod.
+            static uRef Create(QModule* qmod);
+    };
+}
+
+#endif
@@ -9,6 +9,11 @@
 namespace efd {
     /// \brief Verifies if the CNOT relations between every qubit respects the architecture
     /// constraints.
+    ///
+    /// The physical qubits are resolved by register (name and index), instead of
+    /// by their string representation. Once they are, every statement can be checked
+    /// by itself. So, the statements are split in contiguous ranges, which are verified
+    /// in parallel.
     class ArchVerifierPass : public PassT<bool> {
         public:
             typedef ArchVerifierPass* Ref;
@@ -16,10 +21,14 @@ namespace efd {
 
         private:
             ArchGraph::sRef mArch;
+            uint32_t mThreads;
 
         public:
             ArchVerifierPass(ArchGraph::sRef ag);
 
+            /// \brief Sets the (maximum) number of threads used for verifying.
+            void setThreads(uint32_t threads);
+
             bool run(QModule* qmod) override;
 
             /// \brief Create a dynamic instance of this class.
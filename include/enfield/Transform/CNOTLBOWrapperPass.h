@@ -13,10 +13,12 @@ namespace efd {
             static uint8_t ID;
 
         protected:
-            Ordering generate(CircuitGraph& graph) override;
+            Ordering generate(CircuitGraph& graph, const CommutationDAG* dag) override;
 
         public:
-            static uRef Create();
+            CNOTLBOWrapperPass(bool commute = false);
+
+            static uRef Create(bool commute = false);
     };
 }
 
@@ -0,0 +1,106 @@
+#ifndef __EFD_CANONICAL_CIRCUIT_H__
+#define __EFD_CANONICAL_CIRCUIT_H__
+
+#include "enfield/Transform/QModule.h"
+#include "enfield/Transform/CircuitGraph.h"
+#include "enfield/Transform/CommutationDAG.h"
+
+#include <unordered_map>
+
+namespace efd {
+    /// \brief One statement of a flattened program, reduced to what defines its
+    /// semantics.
+    ///
+    /// The signature holds everything but the arguments. e.g.: the operation, its
+    /// real arguments and the 'if' condition. Every kind of CNOT (including the
+    /// reversed and the long ones) has the same signature.
+    struct CanonicalGate {
+        enum Kind { K_GATE, K_SWAP };
+
+        Kind mK;
+        std::string mSignature;
+        std::vector<uint32_t> mQubits;
+        std::vector<uint32_t> mCbits;
+    };
+
+    /// \brief Reduces the statements of a \em QModule to \em CanonicalGate's.
+    ///
+    /// Xbits are resolved by indexing their register by name, and numbered the
+    /// same way as \em XbitToNumber does.
+    class Canonicalizer {
+        public:
+            enum Result { R_GATE, R_NOT_QOP, R_INVALID };
+
+        private:
+            struct Register {
+                bool mIsQuantum;
+                uint32_t mBase;
+                uint32_t mSize;
+            };
+
+            std::unordered_map<std::string, Register> mRegs;
+            uint32_t mQubits;
+            uint32_t mCbits;
+
+            bool getUId(Node::Ref ref, bool isQuantum, uint32_t& uid) const;
+            bool appendRegUIds(const std::string& name, std::vector<uint32_t>& uids) const;
+
+        public:
+            Canonicalizer(QModule::Ref qmod);
+
+            /// \brief Returns the number of qubits.
+            uint32_t getQSize() const;
+            /// \brief Returns the number of cbits.
+            uint32_t getCSize() const;
+
+            /// \brief Fills \p gate with the canonical form of \p stmt.
+            ///
+            /// Returns \em R_NOT_QOP if \p stmt is not a quantum operation, and
+            /// \em R_INVALID if it refers to unknown (or out of bounds) xbits.
+            Result canonicalize(Node::Ref stmt, CanonicalGate& gate) const;
+    };
+
+    /// \brief Compact form of a flattened (and inlined) program, as the
+    /// \em SemanticVerifierPass sees it.
+    ///
+    /// It keeps only the \em CircuitGraph of the gates, one interned signature per
+    /// gate, and the \em CommutationDAG::Axis of each of its slots. The
+    /// \em Node::Ref's of the graph are null, since nothing points to the program.
+    class CanonicalCircuit {
+        public:
+            typedef CanonicalCircuit* Ref;
+            typedef std::unique_ptr<CanonicalCircuit> uRef;
+
+            /// \brief Returned instead of a signature id, when it is unknown.
+            static const uint32_t NoSignature;
+
+        private:
+            CircuitGraph mGraph;
+            std::vector<uint32_t> mGateSignature;
+            std::vector<CommutationDAG::Axis> mAxis;
+            std::unordered_map<std::string, uint32_t> mSignatureId;
+
+        public:
+            CanonicalCircuit(uint32_t qubits, uint32_t cbits);
+
+            /// \brief Appends \p gate, whose quantum arguments commute with \p axis.
+            void append(const CanonicalGate& gate, std::vector<CommutationDAG::Axis> axis);
+
+            /// \brief Returns the id of \p signature (or \em NoSignature).
+            uint32_t getSignatureId(const std::string& signature) const;
+            /// \brief Returns the signature id of \p gate.
+            uint32_t getSignature(uint32_t gate) const;
+
+            /// \brief Returns the circuit graph of the gates.
+            const CircuitGraph& getGraph() const;
+            /// \brief Returns the axis of every slot (see \em CommutationDAG::init).
+            const std::vector<CommutationDAG::Axis>& getAxis() const;
+
+            /// \brief Builds the canonical circuit of the flattened \p qmod.
+            ///
+            /// Returns nullptr if some statement could not be canonicalized.
+            static uRef Create(QModule::Ref qmod);
+    };
+}
+
+#endif
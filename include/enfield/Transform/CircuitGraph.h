@@ -3,7 +3,8 @@
 
 #include "enfield/Analysis/Nodes.h"
 
-#include <unordered_map>
+#include <vector>
+#include <limits>
 
 namespace efd {
     /// \brief Represents the id of one Quantum or Classical bit.
@@ -30,64 +31,70 @@ namespace efd {
     };
 
     /// \brief The Circuit representation of the \em QModule.
+    ///
+    /// The gates are kept in an array, in the order they were appended. Each
+    /// gate has one slot for each \em Xbit it uses. Slots live in flat arrays,
+    /// holding the previous and the next slot in the same \em Xbit wire.
     class CircuitGraph {
+        private:
+            /// \brief Slot index used for the beginning of every wire.
+            static const uint32_t InputSlot = std::numeric_limits<uint32_t>::max() - 1;
+            /// \brief Slot index used for the end of every wire.
+            static const uint32_t OutputSlot = std::numeric_limits<uint32_t>::max();
+
         public:
-            /// \brief Representation of a quantum operation.
-            struct CircuitNode {
-                public:
-                    typedef CircuitNode* Ref;
-                    typedef std::unique_ptr<CircuitNode> uRef;
-                    typedef std::shared_ptr<CircuitNode> sRef;
+            /// \brief Returned instead of a gate index, when there is no gate.
+            static const uint32_t NoGate = std::numeric_limits<uint32_t>::max();
 
+            /// \brief Handle to a quantum operation (or to the input/output of
+            /// the wires), inside a \em CircuitGraph.
+            ///
+            /// It is only a gate index. So, it should be passed by value.
+            class CircuitNode {
                 private:
-                    enum class Type { INPUT, OUTPUT, GATE };
-
-                    Type mType;
-                    Node::Ref mNode;
-                    std::unordered_map
-                        <uint32_t, std::pair<CircuitNode::sRef, CircuitNode::sRef>>
-                        mStepMap;
+                    const CircuitGraph* mGraph;
+                    uint32_t mGate;
 
-                    CircuitNode(Type type);
+                    CircuitNode(const CircuitGraph* graph, uint32_t gate);
 
                 public:
+                    /// \brief Creates a handle that points to no node.
+                    CircuitNode();
+
                     /// \brief Returns the \em Node::Ref associated with this circuit node.
-                    Node::Ref node();
+                    Node::Ref node() const;
 
                     /// \brief Returns the number of \p Xbit's in this node.
-                    uint32_t numberOfXbits();
+                    uint32_t numberOfXbits() const;
 
+                    /// \brief True if this handle points to a node.
+                    bool isValid() const;
                     /// \brief True if this node has reached the end (output node).
-                    bool isOutputNode();
+                    bool isOutputNode() const;
                     /// \brief True if this node is in the beginning (input node).
-                    bool isInputNode();
+                    bool isInputNode() const;
                     /// \brief True if this node is in the middle (gate node).
-                    bool isGateNode();
+                    bool isGateNode() const;
 
                     /// \brief Returns the \p Xbit ID's in this node.
-                    std::vector<uint32_t> getXbitsIds();
+                    std::vector<uint32_t> getXbitsIds() const;
+
+                    bool operator==(const CircuitNode& rhs) const;
+                    bool operator!=(const CircuitNode& rhs) const;
+                    bool operator<(const CircuitNode& rhs) const;
 
                     friend class CircuitGraph;
             };
 
-        private:
-            bool mInit;
-            uint32_t mQubits;
-            uint32_t mCbits;
-            std::vector<CircuitNode::sRef> mGraphHead;
-            std::vector<CircuitNode::sRef> mGraphTail;
-
-        public:
             /// \brief Abstracts the iteration of the \em CircuitGraph.
+            ///
+            /// It holds only the current slot of each \em Xbit.
             class Iterator {
                 private:
-                    uint32_t mQubits;
-                    uint32_t mCbits;
-                    std::vector<CircuitNode::sRef> mPtr;
+                    const CircuitGraph* mGraph;
+                    std::vector<uint32_t> mSlot;
 
-                    Iterator(uint32_t qubits,
-                             uint32_t cbits,
-                             std::vector<CircuitNode::sRef> ptr);
+                    Iterator(const CircuitGraph* graph);
 
                 public:
                     Iterator();
@@ -99,22 +106,47 @@ namespace efd {
                     bool back(Xbit xbit);
                     bool back(uint32_t id);
                     /// \brief Returns the \p Node::Ref for the bit \p xbit.
-                    Node::Ref get(Xbit xbit);
-                    Node::Ref get(uint32_t id);
+                    Node::Ref get(Xbit xbit) const;
+                    Node::Ref get(uint32_t id) const;
 
-                    CircuitNode::sRef operator[](Xbit xbit);
-                    CircuitNode::sRef operator[](uint32_t id);
+                    CircuitNode operator[](Xbit xbit) const;
+                    CircuitNode operator[](uint32_t id) const;
 
                     friend class CircuitGraph;
             };
 
+        private:
+            bool mInit;
+            uint32_t mQubits;
+            uint32_t mCbits;
+
+            // Per gate: its node, and the offset of its first slot.
+            // (mGateOffset has one extra element at the end)
+            std::vector<Node::Ref> mGateNode;
+            std::vector<uint32_t> mGateOffset;
+
+            // Per slot: its xbit, its gate, and the previous/next slot
+            // in the same wire.
+            std::vector<uint32_t> mSlotXbit;
+            std::vector<uint32_t> mSlotGate;
+            std::vector<uint32_t> mSlotPrev;
+            std::vector<uint32_t> mSlotNext;
+
+            // Per wire: its first and last slots.
+            std::vector<uint32_t> mWireFirst;
+            std::vector<uint32_t> mWireLast;
+
+            /// \brief Gets the gate (or the input/output) of \p slot.
+            uint32_t getGateOf(uint32_t slot) const;
+
+        public:
             CircuitGraph();
             CircuitGraph(uint32_t qubits, uint32_t cbits);
 
             /// \brief Initializes the CircuitGraph.
             void init(uint32_t qubits, uint32_t cbits);
             /// \brief Checks if the CircuitGraph is initialized. Exits with error if not.
-            void checkInitialized();
+            void checkInitialized() const;
 
             /// \breif Returns the number of qubits.
             uint32_t getQSize() const;
@@ -122,12 +154,70 @@ namespace efd {
             uint32_t getCSize() const;
             /// \breif Returns the number of bits.
             uint32_t size() const;
+            /// \brief Returns the number of gates.
+            uint32_t getNumberOfGates() const;
+
+            /// \brief Returns the \em Node::Ref of the gate \p gate.
+            Node::Ref getNode(uint32_t gate) const;
+            /// \brief Returns the number of \em Xbit's used by the gate \p gate.
+            uint32_t getNumberOfXbits(uint32_t gate) const;
+            /// \brief Returns the \p i-th \em Xbit id used by the gate \p gate.
+            uint32_t getXbit(uint32_t gate, uint32_t i) const;
+            /// \brief Returns the gate before \p gate in its \p i-th \em Xbit
+            /// wire (or \em NoGate).
+            uint32_t getPredGate(uint32_t gate, uint32_t i) const;
+            /// \brief Returns the gate after \p gate in its \p i-th \em Xbit
+            /// wire (or \em NoGate).
+            uint32_t getSuccGate(uint32_t gate, uint32_t i) const;
 
             /// \brief Appends a node to the bits \p xbits.
             void append(std::vector<Xbit> xbits, Node::Ref node);
 
             /// \brief Builds an iterator instance for this \p CircuitGraph.
-            Iterator build_iterator();
+            Iterator build_iterator() const;
+    };
+
+    class CommutationDAG;
+
+    /// \brief Topological traversal of a \em CircuitGraph (Kahn's algorithm).
+    ///
+    /// Keeps, for every gate, the number of its wires whose previous gate was
+    /// not emitted yet. Emitting a gate decrements that number for the gates
+    /// after it, and the ones that reach zero become ready. So, traversing the
+    /// whole circuit takes O(gates + wires).
+    ///
+    /// If a \em CommutationDAG is given, a wire is only released when the whole
+    /// block before it was emitted. The traversal is still linear.
+    class KahnScheduler {
+        private:
+            const CircuitGraph& mGraph;
+            const CommutationDAG* mDAG;
+            std::vector<uint32_t> mInDegree;
+            // Per block: the number of gates of the previous block not emitted yet.
+            std::vector<uint32_t> mPending;
+            std::vector<uint32_t> mReady;
+            uint32_t mEmitted;
+
+        public:
+            KahnScheduler(const CircuitGraph& graph, const CommutationDAG* dag = nullptr);
+
+            /// \brief Returns the gates that are ready at the beginning, in
+            /// gate order.
+            const std::vector<uint32_t>& getInitialReady() const;
+
+            /// \brief Emits the ready \p gate, and appends the gates that became
+            /// ready to \p ready.
+            void emit(uint32_t gate, std::vector<uint32_t>& ready);
+
+            /// \brief Returns true if every gate was emitted.
+            bool isDone() const;
+
+            /// \brief Splits the gates of \p graph in layers, as soon as possible.
+            ///
+            /// i.e.: each gate is in the layer after the last of its predecessors.
+            /// Gates inside a layer are in gate order.
+            static std::vector<std::vector<uint32_t>> BuildLayers(const CircuitGraph& graph,
+                                                                  const CommutationDAG* dag = nullptr);
     };
 }
 
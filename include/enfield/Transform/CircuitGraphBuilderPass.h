@@ -22,6 +22,7 @@ namespace efd {
             static uint8_t ID;
 
             bool run(QModule* qmod) override;
+            std::vector<uint8_t*> getDependencies() const override;
             static uRef Create();
     };
 }
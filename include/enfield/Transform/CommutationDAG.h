@@ -0,0 +1,67 @@
+#ifndef __EFD_COMMUTATION_DAG_H__
+#define __EFD_COMMUTATION_DAG_H__
+
+#include "enfield/Transform/CircuitGraph.h"
+
+namespace efd {
+    /// \brief Relaxed dependencies between the gates of a \em CircuitGraph.
+    ///
+    /// The gates of each wire are grouped in blocks of consecutive gates that
+    /// commute on that wire. A gate depends only on every gate of the previous
+    /// block of each of its wires, instead of on the gate right before it.
+    /// So, gates inside the same block may be executed in any order.
+    ///
+    /// e.g.: 'cx q[0], q[1]; rz q[0]; cx q[0], q[2];' has only one block
+    /// on 'q[0]', since all of them are diagonal on it.
+    class CommutationDAG {
+        public:
+            /// \brief The Pauli operator a gate commutes with, on one wire.
+            ///
+            /// Two gates that share some wires commute if they commute with the
+            /// same operator (other than \em NONE) on every one of them.
+            enum class Axis { NONE, Z, X };
+
+            /// \brief Returned instead of a block index, when there is no block.
+            static const uint32_t NoBlock;
+
+        private:
+            bool mInit;
+
+            // Per gate: the offset of its first slot (same order as in the
+            // CircuitGraph). (mGateOffset has one extra element at the end)
+            std::vector<uint32_t> mGateOffset;
+            // Per slot: the block it belongs to.
+            std::vector<uint32_t> mSlotBlock;
+
+            // Per block: the next block in the same wire, and the offset of its
+            // first gate. (mBlockOffset has one extra element at the end)
+            std::vector<uint32_t> mBlockNext;
+            std::vector<uint32_t> mBlockOffset;
+            std::vector<uint32_t> mBlockGates;
+
+        public:
+            CommutationDAG();
+
+            /// \brief Groups the gates of \p graph in blocks.
+            ///
+            /// \p axis has one element for each slot of \p graph, in gate order.
+            /// i.e.: the axis of the \p i-th \em Xbit of the gate \p g comes right
+            /// after the ones of the gate \p g - 1.
+            void init(const CircuitGraph& graph, const std::vector<Axis>& axis);
+            /// \brief Checks if the CommutationDAG is initialized. Exits with error if not.
+            void checkInitialized() const;
+
+            /// \brief Returns the number of blocks.
+            uint32_t getNumberOfBlocks() const;
+            /// \brief Returns the block of the \p i-th \em Xbit of the gate \p gate.
+            uint32_t getBlock(uint32_t gate, uint32_t i) const;
+            /// \brief Returns the block after \p block, in its wire (or \em NoBlock).
+            uint32_t getNextBlock(uint32_t block) const;
+            /// \brief Returns the number of gates inside \p block.
+            uint32_t getBlockSize(uint32_t block) const;
+            /// \brief Returns the \p i-th gate inside \p block (in gate order).
+            uint32_t getBlockGate(uint32_t block, uint32_t i) const;
+    };
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef __EFD_COMMUTATION_DAG_BUILDER_PASS_H__
+#define __EFD_COMMUTATION_DAG_BUILDER_PASS_H__
+
+#include "enfield/Transform/Pass.h"
+#include "enfield/Transform/QModule.h"
+#include "enfield/Transform/CommutationDAG.h"
+
+namespace efd {
+    /// \brief Builds the \em CommutationDAG of the \em QModule given.
+    ///
+    /// Only the standard library gates (and 'CX') are known to commute with
+    /// something. Everything else (including measurements, 'if' statements and
+    /// classical bits) keeps the order of the program.
+    class CommutationDAGBuilderPass : public PassT<CommutationDAG> {
+        public:
+            typedef CommutationDAGBuilderPass* Ref;
+            typedef std::unique_ptr<CommutationDAGBuilderPass> uRef;
+
+            static uint8_t ID;
+
+            bool run(QModule* qmod) override;
+            std::vector<uint8_t*> getDependencies() const override;
+            static uRef Create();
+    };
+
+    /// \brief Returns, for each quantum argument of \p node, the operator
+    /// it commutes with.
+    std::vector<CommutationDAG::Axis> GetCommutationAxis(Node::Ref node);
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef __EFD_COMPILATION_CACHE_H__
+#define __EFD_COMPILATION_CACHE_H__
+
+#include "enfield/Transform/Driver.h"
+#include "enfield/Support/Stats.h"
+
+#include <mutex>
+
+namespace efd {
+    /// \brief On-disk cache of compiled programs, addressed by the contents of
+    /// the source program and of everything that changes its output.
+    ///
+    /// Each entry is one file inside the cache directory, written to a
+    /// temporary file and renamed, so that readers never see a partial entry
+    /// (even from other processes). When the total size goes above the limit,
+    /// the least recently used entries are removed.
+    class CompilationCache {
+        public:
+            typedef CompilationCache* Ref;
+            typedef std::shared_ptr<CompilationCache> sRef;
+
+            /// \brief What is stored for each compilation.
+            struct Entry {
+                std::string mOutput;
+                std::string mStats;
+            };
+
+            /// \brief Default limit for the size of the cache (256 MiB).
+            static const uint64_t DefaultMaxSize;
+
+        private:
+            std::string mDir;
+            uint64_t mMaxSize;
+            std::mutex mEvictMutex;
+
+            CompilationCache(std::string dir, uint64_t maxSize);
+
+            std::string getPath(const std::string& key) const;
+            /// \brief Removes the least recently used entries, until the cache
+            /// fits in \em mMaxSize.
+            void evict();
+
+        public:
+            /// \brief Looks for \p key, filling \p entry in a hit.
+            bool lookup(const std::string& key, Entry& entry);
+            /// \brief Stores \p entry as \p key, replacing it if it exists.
+            bool store(const std::string& key, const Entry& entry);
+
+            /// \brief Returns the key of compiling \p program with \p settings
+            /// (printing it \p pretty, and its stats in \p statsFormat).
+            ///
+            /// The key is the SHA-256 of all of them, of the include path, and of
+            /// the contents of every file \p program includes (but the standard
+            /// library), which are looked for as the parser does (\p path being
+            /// the directory of \p program). The allocator options that the
+            /// allocator does not use (e.g.: the seed, for the deterministic ones)
+            /// are left out.
+            static std::string GetKey(const std::string& program,
+                                      const CompilationSettings& settings, bool pretty,
+                                      StatsFormat statsFormat = StatsFormat::Text,
+                                      const std::string& path = "./");
+
+            /// \brief Creates a cache in \p dir (creating it, if needed).
+            ///
+            /// Returns nullptr if the directory could not be created.
+            static sRef Create(std::string dir, uint64_t maxSize = DefaultMaxSize);
+    };
+}
+
+#endif
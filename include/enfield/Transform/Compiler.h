@@ -0,0 +1,47 @@
+#ifndef __EFD_COMPILER_H__
+#define __EFD_COMPILER_H__
+
+#include "enfield/Transform/Driver.h"
+#include "enfield/Arch/ArchCache.h"
+
+namespace efd {
+    /// \brief Compiles many \em QModule's with the same \em CompilationSettings.
+    ///
+    /// What depends only on the architecture (see \em ArchCache) is computed
+    /// once, by the first compilation that needs it, and reused by the others.
+    /// Compiling does not modify the compiler. So, it may be called from many
+    /// threads at the same time.
+    class Compiler {
+        public:
+            typedef Compiler* Ref;
+            typedef std::unique_ptr<Compiler> uRef;
+
+        private:
+            CompilationSettings mSettings;
+            ArchCache::sRef mCache;
+
+        public:
+            /// \brief Constructs a compiler that uses \p cache (which must be of
+            /// the same architecture). If it is null, a new one is created.
+            Compiler(CompilationSettings settings, ArchCache::sRef cache = nullptr);
+
+            /// \brief Returns the settings used for every compilation.
+            const CompilationSettings& getSettings() const;
+            /// \brief Returns the cache shared by every compilation.
+            ArchCache::sRef getArchCache() const;
+
+            /// \brief Compiles \p qmod in place.
+            ///
+            /// Returns false if it failed (and it was not forced). In that case,
+            /// \p qmod should not be used anymore.
+            bool compile(QModule::Ref qmod) const;
+            /// \brief Parses and compiles \p program, returning the compiled
+            /// program (or an empty string, if it failed).
+            std::string compile(const std::string& program) const;
+
+            /// \brief Creates an instance of this class.
+            static uRef Create(CompilationSettings settings, ArchCache::sRef cache = nullptr);
+    };
+}
+
+#endif
@@ -49,6 +49,84 @@ namespace efd {
         ConstIterator end() const;
     };
 
+    /// \brief Read-only view of a sequence of parallel dependencies, stored
+    /// contiguously somewhere else (e.g.: in a \em DepsSet).
+    struct DepsSpan {
+        typedef const Dep* Iterator;
+        typedef const Dep* ConstIterator;
+
+        const Dep* mBegin;
+        const Dep* mEnd;
+        Node::Ref mCallPoint;
+
+        /// \brief Gets the \p i-th dependency.
+        const Dep& operator[](uint32_t i) const;
+
+        /// \brief Returns true if there is no dependency.
+        bool isEmpty() const;
+        /// \brief Returns the number of dependencies.
+        uint32_t getSize() const;
+
+        /// \brief Pointer to the first dependency.
+        ConstIterator begin() const;
+        /// \brief Pointer past the last dependency.
+        ConstIterator end() const;
+    };
+
+    /// \brief Sequence of \em Dependencies.
+    ///
+    /// Every \em Dep is kept in one contiguous array. Each element of the
+    /// sequence is an (offset, length) pair into that array, and is accessed
+    /// as a \em DepsSpan. Thus, no copy is made when reading it.
+    class DepsSet {
+        private:
+            struct Entry {
+                uint32_t mOffset;
+                uint32_t mSize;
+                Node::Ref mCallPoint;
+            };
+
+            std::vector<Dep> mDeps;
+            std::vector<Entry> mEntries;
+
+        public:
+            /// \brief Iterates over the \em DepsSpan of a \em DepsSet.
+            class ConstIterator {
+                private:
+                    const DepsSet* mSet;
+                    uint32_t mI;
+                    DepsSpan mSpan;
+
+                public:
+                    ConstIterator(const DepsSet* set, uint32_t i);
+
+                    const DepsSpan& operator*();
+                    const DepsSpan* operator->();
+                    ConstIterator& operator++();
+                    bool operator==(const ConstIterator& rhs) const;
+                    bool operator!=(const ConstIterator& rhs) const;
+            };
+
+            typedef ConstIterator iterator;
+            typedef ConstIterator const_iterator;
+
+            /// \brief Returns the number of elements.
+            uint32_t size() const;
+            /// \brief Returns true if there is no element.
+            bool empty() const;
+
+            /// \brief Gets a view of the \p i-th element.
+            DepsSpan operator[](uint32_t i) const;
+
+            /// \brief Appends a copy of \p deps.
+            void push_back(const Dependencies& deps);
+            /// \brief Removes all elements.
+            void clear();
+
+            ConstIterator begin() const;
+            ConstIterator end() const;
+    };
+
     /// \brief Keep track of the dependencies of each qbit for the whole program,
     /// as well as the dependencies for every gate.
     ///
@@ -57,14 +135,18 @@ namespace efd {
     /// dependency that can't be broken down (unless the gate is inlined).
     struct DependencyBuilder {
         typedef DependencyBuilder* Ref;
-        typedef std::vector<Dependencies> DepsSet;
+        typedef efd::DepsSet DepsSet;
 
-        XbitToNumber mXbitToNumber;
+        XbitToNumberWrapperPass::DataSnapshot mXbitToNumber;
 
         std::unordered_map<NDGateDecl*, DepsSet> mLDeps;
-        std::map<Node*, Dependencies> mIDeps;
         DepsSet mGDeps;
 
+        /// \brief Dependencies of every instruction, in the order they were seen.
+        DepsSet mIDeps;
+        /// \brief Maps an instruction to its ordinal (i.e. its index in \em mIDeps).
+        std::unordered_map<Node*, uint32_t> mIOrdinal;
+
         DependencyBuilder();
 
         /// \brief Gets an unsingned id for \p ref.
@@ -75,18 +157,23 @@ namespace efd {
         DepsSet* getDepsSet(NDGateDecl::Ref gate = nullptr);
 
         /// \brief Returns the structure that mapped the qbits.
-        XbitToNumber& getXbitToNumber();
+        const XbitToNumber& getXbitToNumber() const;
         /// \brief Sets the structure that will map the qbits.
-        void setXbitToNumber(XbitToNumber& xtn);
+        void setXbitToNumber(XbitToNumberWrapperPass::DataSnapshot xtn);
 
         /// \brief Gets the dependencies for some gate declaration. If it is a
         /// nullptr, then it is returned the dependencies for the whole program.
         const DepsSet& getDependencies(NDGateDecl::Ref ref = nullptr) const;
         DepsSet& getDependencies(NDGateDecl::Ref ref = nullptr);
 
+        /// \brief Records \p deps as the dependencies of the instruction \p ref.
+        void setDeps(Node* ref, const Dependencies& deps);
+
         /// \brief Gets the dependencies for a specific instruction.
-        const Dependencies getDeps(Node* ref) const;
-        Dependencies getDeps(Node* ref);
+        ///
+        /// The non-const version returns an empty one if \p ref has none.
+        DepsSpan getDeps(Node* ref) const;
+        DepsSpan getDeps(Node* ref);
     };
 
     /// \brief WrapperPass that yields a \em DependencyBuilder structure.
@@ -99,6 +186,7 @@ namespace efd {
             static uint8_t ID;
 
             bool run(QModule::Ref qmod) override;
+            std::vector<uint8_t*> getDependencies() const override;
 
             /// \brief Returns a new instance of this class.
             static uRef Create();
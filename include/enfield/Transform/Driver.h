@@ -6,6 +6,10 @@
 #include "enfield/Transform/Allocators/Allocators.h"
 
 namespace efd {
+    /// \brief The basis the tools compile to by default: the intrinsic
+    /// operations plus 'cx', 'u1', 'u2', 'u3' and 'h'.
+    extern const std::vector<std::string> DefaultBasis;
+
     /// \brief Required information in order to compile a \em QModule.
     struct CompilationSettings {
         ArchGraph::sRef archGraph;
@@ -14,6 +18,13 @@ namespace efd {
         bool reorder;
         bool verify;
         bool force;
+        /// \brief Number of threads used by the architecture verifier.
+        uint32_t verifyThreads;
+        /// \brief Tuning knobs of the allocator.
+        AllocatorOptions allocatorOptions;
+        /// \brief Whether gates that commute may be reordered (by the
+        /// ordering, the allocators and the verifier).
+        bool commute;
     };
 
     /// \brief Compile \p qmod, and return the compiled version.
@@ -22,8 +33,16 @@ namespace efd {
     /// the allocator to use, the basis vector and whether to reorder the program or not.
     QModule::uRef Compile(QModule::uRef qmod, CompilationSettings settings);
 
-    /// \brief Parse file in the path \p filepath.
-    QModule::uRef ParseFile(std::string filepath);
+    /// \brief Parse file in the path \p filepath, using \p threads threads.
+    QModule::uRef ParseFile(std::string filepath, uint32_t threads = 1);
+
+    /// \brief Parse file in the path \p filepath in chunks of (at most) \p chunkSize
+    /// top-level statements, flattening and inlining (up to \p basis) each chunk
+    /// as soon as it is parsed.
+    ///
+    /// \p consumer is called once per chunk (see QModule::ParseInChunks).
+    QModule::uRef ProcessFileInChunks(std::string filepath, uint32_t chunkSize,
+            std::vector<std::string> basis, QModule::ChunkConsumer consumer);
 
     /// \brief Print \p qmod to an standard output stream \p o.
     void PrintToStream(QModule::Ref qmod, std::ostream& o = std::cout, bool pretty = true);
@@ -21,6 +21,7 @@ namespace efd {
 
         public:
             bool run(QModule::Ref qmod) override;
+            PreservedAnalyses getPreserved() const override;
 
             static uRef Create();
     };
@@ -21,6 +21,7 @@ namespace efd {
             InlineAllPass(std::vector<std::string> basis = std::vector<std::string>());
 
             bool run(QModule::Ref qmod) override;
+            PreservedAnalyses getPreserved() const override;
 
             /// \brief Creates an instance of this pass.
             static uRef Create(std::vector<std::string> basis = 
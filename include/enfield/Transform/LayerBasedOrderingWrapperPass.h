@@ -3,6 +3,7 @@
 
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
 #include "enfield/Transform/LayersBuilderPass.h"
+#include "enfield/Transform/CommutationDAG.h"
 #include <set>
 #include <unordered_map>
 
@@ -26,12 +27,21 @@ namespace efd {
 
         protected:
             std::unordered_map<Node::Ref, uint32_t> mStmtId;
+            bool mCommute;
+
+            /// \brief If \p commute is set, gates that commute may be reordered.
+            LayerBasedOrderingWrapperPass(bool commute);
 
             uint32_t getNodeId(Node::Ref ref);
-            virtual Ordering generate(CircuitGraph& graph) = 0;
+
+            /// \brief Generates the ordering of the gates in \p graph.
+            ///
+            /// \p dag is not null if gates that commute may be reordered.
+            virtual Ordering generate(CircuitGraph& graph, const CommutationDAG* dag) = 0;
 
         public:
             bool run(QModule* qmod) override;
+            PreservedAnalyses getPreserved() const override;
     };
 }
 
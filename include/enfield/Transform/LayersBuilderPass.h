@@ -13,6 +13,9 @@ namespace efd {
     typedef std::vector<Layer> Layers;
 
     /// \brief Create the layers of the 'QModule'.
+    ///
+    /// If \em commute is set, the layers are built over the \em CommutationDAG.
+    /// So, gates that commute may be in the same layer, even sharing a qubit.
     class LayersBuilderPass : public PassT<Layers> {
         public:
             typedef std::unique_ptr<LayersBuilderPass> uRef;
@@ -20,10 +23,17 @@ namespace efd {
 
             static uint8_t ID;
 
+        private:
+            bool mCommute;
+
+        public:
+            LayersBuilderPass(bool commute = false);
+
             bool run(QModule* qmod) override;
+            std::vector<uint8_t*> getDependencies() const override;
 
             /// \brief Create an instance of this class.
-            static uRef Create();
+            static uRef Create(bool commute = false);
     };
 }
 
@@ -2,10 +2,40 @@
 #define __EFD_PASS_H__
 
 #include <memory>
+#include <cstdint>
+#include <vector>
+#include <unordered_set>
 
 namespace efd {
     class QModule;
 
+    /// \brief Set of analyses (identified by their \em ID) that are still
+    /// valid after a pass has modified a \em QModule.
+    class PreservedAnalyses {
+        private:
+            std::unordered_set<uint8_t*> mIDs;
+
+        public:
+            /// \brief Marks the analysis with \p id as preserved.
+            void preserve(uint8_t* id);
+            /// \brief Returns true if the analysis with \p id is preserved.
+            bool isPreserved(uint8_t* id) const;
+
+            /// \brief Marks the analysis \p T as preserved.
+            template <typename T>
+            void preserve() { preserve(&T::ID); }
+            /// \brief Returns true if the analysis \p T is preserved.
+            template <typename T>
+            bool isPreserved() const { return isPreserved(&T::ID); }
+
+            /// \brief Creates a set where no analysis is preserved.
+            static PreservedAnalyses None();
+            /// \brief Creates the set of a pass that only changes statements, i.e.:
+            /// registers and gates are left untouched. So, the analyses of the
+            /// registers (\em XbitToNumberWrapperPass) are preserved.
+            static PreservedAnalyses StatementsOnly();
+    };
+
     /// \brief Base class for implementation of QModule passes.
     /// This information will be used when the QModule's function
     /// is called.
@@ -30,6 +60,15 @@ namespace efd {
             /// modified \p qmod.
             virtual bool run(QModule* qmod) = 0;
 
+            /// \brief Returns the analyses that are still valid after this pass
+            /// has modified the \em QModule. By default, none of them.
+            virtual PreservedAnalyses getPreserved() const;
+
+            /// \brief Returns the \em ID of the analyses this pass depends on.
+            ///
+            /// If any of them is invalidated, so is this pass' result.
+            virtual std::vector<uint8_t*> getDependencies() const;
+
             /// \brief Gets the kind of this pass.
             Kind getKind() const;
     };
@@ -43,6 +82,9 @@ namespace efd {
                 typedef std::shared_ptr<PassT<T>> sRef;
                 typedef std::unique_ptr<PassT<T>> uRef;
 
+                typedef T Data;
+                typedef std::shared_ptr<const T> DataSnapshot;
+
             protected:
                 T mData;
 
@@ -52,8 +94,8 @@ namespace efd {
                 /// \brief Gets the resulting data.
                 ///
                 /// This should return the data generated by the processing of the
-                /// \em run function of the \em Pass class.
-                T getData() const;
+                /// \em run function of the \em Pass class. No copy is made.
+                const T& getData() const;
                 T& getData();
 
                 static bool ClassOf(Pass* ref);
@@ -73,7 +115,7 @@ efd::PassT<T>::PassT() : Pass(K_GEN) {
 }
 
 template <typename T>
-T efd::PassT<T>::getData() const {
+const T& efd::PassT<T>::getData() const {
     return mData;
 }
 
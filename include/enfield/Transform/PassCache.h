@@ -3,74 +3,56 @@
 
 #include "enfield/Transform/Pass.h"
 #include "enfield/Transform/QModule.h"
-#include <set>
+#include "enfield/Transform/AnalysisManager.h"
 
 namespace efd {
-    /// \brief Static class that caches passes that were run by this compiler.
+    /// \brief Static front end to the \em AnalysisManager of each \em QModule.
     class PassCache {
-        public:
-            typedef std::unordered_map<uint8_t*, Pass::sRef> PassMap;
-            typedef std::unordered_map<QModule::Ref, PassMap> QModPassesMap;
-
-        private:
-            static QModPassesMap mPasses;
-
         public:
             PassCache() = delete;
 
-            /// \brief Clears the cache for a certain \p qmod, or simply clears all cache.
-            static void Clear(QModule::Ref qmod = nullptr) {
-                if (qmod != nullptr) {
-                    mPasses.erase(qmod);
-                } else {
-                    mPasses.clear();
-                }
+            /// \brief Clears the cache for \p qmod.
+            static void Clear(QModule::Ref qmod) {
+                qmod->getAnalysisManager().clear();
+            }
+
+            /// \brief Invalidates the passes cached for \p qmod, except the ones
+            /// in \p preserved.
+            static void Invalidate(QModule::Ref qmod,
+                    const PreservedAnalyses& preserved = PreservedAnalyses::None()) {
+                qmod->getAnalysisManager().invalidate(preserved);
             }
 
             /// \brief Returns true if this pass was already run for this module.
             template <typename T>
             static bool Has(QModule::Ref qmod) {
-                if (mPasses.find(qmod) == mPasses.end()) return false;
-
-                auto& passmap = mPasses[qmod];
-                if (passmap.find(&T::ID) == passmap.end())
-                    return false;
-
-                return true;
+                return qmod->getAnalysisManager().has<T>();
             }
 
             /// \brief Runs the pass \p T in \p qmod.
-            ///
-            /// This will cache the pass run and return it if called without  any
-            /// modifications to the module.
             template <typename T>
             static void Run(QModule::Ref qmod) {
-                if (Has<T>(qmod)) return;
-                if (mPasses.find(qmod) == mPasses.end()) mPasses[qmod] = PassMap();
-                Pass::sRef pass = T::Create();
-
-                // qmod was modified, so we reset all passes already computed
-                // in this cache.
-                if (pass->run(qmod)) mPasses[qmod].clear();
-                else mPasses[qmod][&T::ID] = pass;
+                qmod->getAnalysisManager().run<T>();
             }
 
             /// \brief Wrapper that runs a created pass.
-            ///
-            /// Should be used in order to maintain consistent the data in the
-            /// cache.
             template <typename T>
             static void Run(QModule::Ref qmod, T* pass) {
-                auto ans = pass->run(qmod);
-                if (ans) mPasses[qmod].clear();
+                qmod->getAnalysisManager().run(pass);
             }
 
-            /// \brief Gets a shared pointer to the pass \p T run in \p qmod. If it
-            /// does not exist, it tries to run.
+            /// \brief Gets the pass \p T run in \p qmod. If it does not exist,
+            /// it tries to run.
             template <typename T>
             static T* Get(QModule::Ref qmod) {
-                if (!Has<T>(qmod)) Run<T>(qmod);
-                return (T*) mPasses[qmod][&T::ID].get();
+                return qmod->getAnalysisManager().get<T>();
+            }
+
+            /// \brief Gets a read-only snapshot of the data of the pass \p T
+            /// run in \p qmod.
+            template <typename T>
+            static typename T::DataSnapshot GetData(QModule::Ref qmod) {
+                return qmod->getAnalysisManager().getData<T>();
             }
     };
 }
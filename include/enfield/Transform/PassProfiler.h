@@ -0,0 +1,58 @@
+#ifndef __EFD_PASS_PROFILER_H__
+#define __EFD_PASS_PROFILER_H__
+
+#include "enfield/Transform/Pass.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace efd {
+    /// \brief Profiles every pass run through the \em AnalysisManager (i.e.: the
+    /// \em PassCache), once enabled.
+    ///
+    /// For each kind of pass, it records the wall and the CPU time of its runs,
+    /// the number of runs and of cache hits, and what was allocated (see
+    /// \em AllocationCounter). Times and allocations exclude the passes run
+    /// inside another one, which are recorded apart.
+    ///
+    /// If the \em Tracer is enabled, each run is also traced as a span.
+    class PassProfiler {
+        public:
+            /// \brief What was recorded for one kind of pass.
+            struct Record {
+                std::string mName;
+                uint64_t mRuns;
+                uint64_t mHits;
+                double mWallTime;
+                double mCPUTime;
+                uint64_t mBytes;
+                uint64_t mAllocations;
+            };
+
+            PassProfiler() = delete;
+
+            /// \brief Starts (or stops) profiling.
+            static void Enable(bool enable = true);
+            /// \brief Returns true if the passes are being profiled.
+            static bool IsEnabled();
+
+            /// \brief Returns the name of the class of \p pass.
+            static std::string GetPassName(Pass::Ref pass);
+
+            /// \brief Runs \p pass in \p qmod, recording it if enabled.
+            static bool Run(Pass::Ref pass, QModule* qmod);
+            /// \brief Records that \p pass was found in the cache.
+            static void RecordHit(Pass::Ref pass);
+
+            /// \brief Returns the records, sorted by wall time (the greatest first).
+            static std::vector<Record> GetRecords();
+            /// \brief Removes all records.
+            static void Clear();
+
+            /// \brief Prints the records in a table, sorted by wall time.
+            static void Print(std::ostream& out = std::cout);
+    };
+}
+
+#endif
@@ -3,8 +3,11 @@
 
 #include "enfield/Analysis/Nodes.h"
 #include "enfield/Transform/Pass.h"
+#include "enfield/Transform/AnalysisManager.h"
 
 #include <unordered_map>
+#include <unordered_set>
+#include <functional>
 
 namespace efd {
     class Pass;
@@ -21,7 +24,8 @@ namespace efd {
             typedef std::vector<NDGateSign::Ref> GatesVector; 
 
             typedef std::unordered_map<std::string, NDRegDecl::uRef> RegsMap; 
-            typedef std::unordered_map<std::string, NDGateSign::uRef> GatesMap; 
+            typedef std::unordered_map<std::string, NDGateSign::sRef> GatesMap; 
+            typedef std::unordered_set<NDGateSign::Ref> GatesSet; 
 
             typedef std::unordered_map<std::string, NDId::Ref> IdMap;
             typedef std::unordered_map<NDGateDecl::Ref, IdMap> GateIdMap;
@@ -29,12 +33,16 @@ namespace efd {
             typedef Node::Iterator Iterator;
             typedef Node::ConstIterator ConstIterator;
 
+            typedef IncludeVector::const_iterator IncludeConstIterator;
+
             typedef RegsVector::iterator RegIterator;
             typedef RegsVector::const_iterator RegConstIterator;
 
             typedef GatesVector::iterator GateIterator;
             typedef GatesVector::const_iterator GateConstIterator;
 
+            typedef std::function<void(Ref)> ChunkConsumer;
+
         private:
             NDQasmVersion::uRef mVersion;
             IncludeVector mIncludes;
@@ -42,13 +50,18 @@ namespace efd {
             GateIdMap mGateIdMap;
             RegsMap mRegsMap; 
             GatesMap mGatesMap; 
+            GatesSet mSharedGates;
 
             RegsVector mRegs;
             GatesVector mGates;
             NDStmtList::uRef mStatements;
 
+            AnalysisManager::uRef mAnalysisManager;
+
             QModule();
 
+            void insertGateImpl(NDGateSign::sRef gate, bool isShared);
+
         public:
             ~QModule();
 
@@ -89,6 +102,11 @@ namespace efd {
 
             /// \brief Inserts a gate to the QModule.
             void insertGate(NDGateSign::uRef gate);
+            /// \brief Inserts a gate that is shared with other QModules.
+            ///
+            /// Shared gates are not cloned when cloning the QModule. So, they
+            /// should not be modified.
+            void insertGate(NDGateSign::sRef gate);
 
             /// \brief Returns the \p i-th statement.
             Node::Ref getStatement(uint32_t i);
@@ -100,6 +118,11 @@ namespace efd {
             /// \brief Return the number of statements.
             uint32_t getNumberOfStmts() const;
 
+            /// \brief ConstIterator to the beginning of the include node vector.
+            IncludeConstIterator include_begin() const;
+            /// \brief ConstIterator to the end of the include node vector.
+            IncludeConstIterator include_end() const;
+
             /// \brief Iterator to the beginning of the register node vector.
             RegIterator reg_begin();
             /// \brief ConstIterator to the beginning of the register node vector.
@@ -146,17 +169,34 @@ namespace efd {
             /// \brief Returns true if there is a quantum gate \p id.
             bool hasQGate(std::string id) const;
 
+            /// \brief Gets the manager of the passes run on this QModule.
+            AnalysisManager& getAnalysisManager();
+
             /// \brief Clones the current qmodule.
             uRef clone() const;
 
             /// \brief Create a new empty QModule.
             static uRef Create();
             /// \brief Process the AST in order to obtain the QModule.
+            ///
+            /// Returns nullptr if the program is not valid (see \em ProcessAST).
             static uRef GetFromAST(Node::uRef ref);
             /// \brief Parses the file \p filename and returns a QModule.
-            static uRef Parse(std::string filename, std::string path = "./");
+            ///
+            /// If \p threads is greater than one, the file is parsed in parallel.
+            static uRef Parse(std::string filename, std::string path = "./",
+                    uint32_t threads = 1);
             /// \brief Parses the string \p program and returns a QModule.
             static uRef ParseString(std::string program);
+            /// \brief Parses the file \p filename in chunks of (at most) \p chunkSize
+            /// top-level statements.
+            ///
+            /// Each chunk is processed into the QModule as soon as it is parsed. Then,
+            /// \p consumer receives the QModule, which holds every declaration seen so
+            /// far, but only the statements of that chunk. They are removed once
+            /// \p consumer returns. So, the returned QModule has no statements.
+            static uRef ParseInChunks(std::string filename, std::string path,
+                    uint32_t chunkSize, ChunkConsumer consumer);
     };
 }
 
@@ -21,6 +21,7 @@ namespace efd {
 
         public:
             bool run(QModule::Ref qmod) override;
+            PreservedAnalyses getPreserved() const override;
 
             /// \brief Create an instance of this class.
             static uRef Create(ArchGraph::sRef graph);
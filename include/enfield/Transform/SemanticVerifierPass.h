@@ -3,6 +3,7 @@
 
 #include "enfield/Transform/Pass.h"
 #include "enfield/Transform/QModule.h"
+#include "enfield/Transform/CanonicalCircuit.h"
 #include "enfield/Support/Defs.h"
 
 namespace efd {
@@ -13,6 +14,11 @@ namespace efd {
     /// Note that it only knows how to verify CNOT gates (for gates that use more than one
     /// qubit). If it is not the case for the given module, one should either \em flatten it
     /// or transform the gate into single qubit gates.
+    ///
+    /// Both programs are reduced to \em CanonicalGate's. Each gate of the given
+    /// \em QModule must match (signature and mapped xbits) one of the ready gates
+    /// of the source, while the swaps only update an integer permutation. So,
+    /// it runs in linear time.
     class SemanticVerifierPass : public PassT<bool> {
         public:
             typedef SemanticVerifierPass* Ref;
@@ -20,22 +26,37 @@ namespace efd {
 
         private:
             QModule::uRef mSrc;
+            CanonicalCircuit::uRef mCanonical;
             Mapping mInitial;
+            bool mCommute;
+            bool mInlineAll;
             std::vector<std::string> mBasis;
 
         public:
             /// \brief Constructs a verifier from a clone of the original semantics
             /// (the \p src QModule).
-            SemanticVerifierPass(QModule::uRef src, Mapping initial);
+            ///
+            /// If \p commute is set, gates that commute may have been reordered.
+            SemanticVerifierPass(QModule::uRef src, Mapping initial, bool commute = false);
+            /// \brief Constructs a verifier from a snapshot of the original
+            /// semantics (already flattened and inlined).
+            SemanticVerifierPass(CanonicalCircuit::uRef src, Mapping initial,
+                                 bool commute = false);
 
             /// \brief Flags the verifier to inline all gates, but those inside the
             /// \p basis vector, before mapping.
             void setInlineAll(std::vector<std::string> basis = {});
+            /// \brief Flags the verifier not to flatten nor inline the source, i.e.:
+            /// it was already done.
+            void setDontInline();
 
             bool run(QModule* dst) override;
 
             /// \brief Create a dynamic instance of this class.
-            static uRef Create(QModule::uRef src, Mapping initial);
+            static uRef Create(QModule::uRef src, Mapping initial, bool commute = false);
+            /// \brief Create a dynamic instance of this class.
+            static uRef Create(CanonicalCircuit::uRef src, Mapping initial,
+                               bool commute = false);
     };
 }
 
@@ -9,10 +9,23 @@ namespace efd {
     void InlineGate(QModule::Ref qmod, NDQOp::Ref qop);
     /// \brief Processes the \p root node, and transform the entire AST into
     /// a QModule.
-    void ProcessAST(QModule::Ref qmod, Node::Ref root);
+    ///
+    /// Returns false if any statement refers to a register (or an index of it)
+    /// or to a gate that was not declared, or has the wrong number of arguments.
+    /// Such statements are left out of \p qmod.
+    bool ProcessAST(QModule::Ref qmod, Node::Ref root);
 
     /// \brief Returns a vector with the intrinsic gates implementation.
-    std::vector<NDGateSign::uRef> GetIntrinsicGates();
+    ///
+    /// The intrinsic gates are parsed only once per process, and shared
+    /// among all modules. They should not be modified.
+    std::vector<NDGateSign::sRef> GetIntrinsicGates();
+    /// \brief Returns a vector with the gates declared in the standard
+    /// library file \p file.
+    ///
+    /// As the intrinsic gates, they are created only once per process,
+    /// and shared among all modules. They should not be modified.
+    std::vector<NDGateSign::sRef> GetStdLibGates(std::string file);
 
     /// \brief Creates a call to the intrinsic swap function.
     NDQOp::uRef CreateISwap(Node::uRef lhs, Node::uRef rhs);
@@ -125,7 +125,7 @@ efd::Node::uRef efd::Node::clone() const {
 // -------------- Value Specializations -----------------
 // -------------- Value<efd::IntVal> -----------------
 template <> 
-efd::NDValue<efd::IntVal>::NDValue(efd::IntVal val) : Node(K_LIT_INT), mVal(val) {
+efd::NDValue<efd::IntVal>::NDValue(efd::IntVal val) : Node(K_LIT_INT), mVal(std::move(val)) {
 }
 
 template <> 
@@ -140,7 +140,7 @@ void efd::NDValue<efd::IntVal>::apply(NodeVisitor::Ref visitor) {
 
 // -------------- Value<efd::RealVal> -----------------
 template <> 
-efd::NDValue<efd::RealVal>::NDValue(efd::RealVal val) : Node(K_LIT_REAL), mVal(val) {
+efd::NDValue<efd::RealVal>::NDValue(efd::RealVal val) : Node(K_LIT_REAL), mVal(std::move(val)) {
 }
 
 template <> 
@@ -155,7 +155,7 @@ void efd::NDValue<efd::RealVal>::apply(NodeVisitor::Ref visitor) {
 
 // -------------- Value<std::string> -----------------
 template <> 
-efd::NDValue<std::string>::NDValue(std::string val) : Node(K_LIT_STRING), mVal(val) {
+efd::NDValue<std::string>::NDValue(std::string val) : Node(K_LIT_STRING), mVal(std::move(val)) {
 }
 
 template <> 
@@ -6,6 +6,7 @@
     #include "enfield/Support/WrapperVal.h"
     #include "enfield/Support/RTTI.h"
     #include "enfield/Support/CommandLine.h"
+    #include "enfield/Support/Tracer.h"
 
     namespace efd {
         class EfdScanner;
@@ -49,8 +50,14 @@
 
     namespace efd {
         class EfdScanner : public yyFlexLexer {
+            private:
+                /// \brief The location of the last token scanned.
+                yy::location loc;
+
             public:
-                EfdScanner(std::istream* iStream, std::ostream* oStream);
+                /// \brief Constructs a scanner whose input begins at \p start.
+                EfdScanner(std::istream* iStream, std::ostream* oStream,
+                        yy::position start = yy::position());
                 yy::EfdParser::symbol_type lex();
         };
     }
@@ -61,8 +68,24 @@
 }
 
 %code {
-    efd::EfdScanner::EfdScanner(std::istream* iStream, std::ostream* oStream)
-       : yyFlexLexer(iStream, oStream) {
+    #include "enfield/Support/MappedFile.h"
+
+    #include <thread>
+
+    efd::EfdScanner::EfdScanner(std::istream* iStream, std::ostream* oStream,
+            yy::position start) : yyFlexLexer(iStream, oStream), loc(start, start) {
+    }
+
+    // Hands the statements parsed so far to the chunk handler.
+    static void FlushChunk(efd::ASTWrapper& ast, efd::NDStmtList::Ref stmts) {
+        auto chunk = efd::NDStmtList::Create();
+
+        for (auto& stmt : *stmts) {
+            chunk->addChild(std::move(stmt));
+        }
+
+        stmts->clear();
+        ast.mChunkHandler(std::move(chunk));
     }
 
     void efd::yy::EfdParser::error(efd::yy::location const& loc, std::string const& err) {
@@ -169,12 +192,18 @@ program: stmtlist                   { $$ = $1; ast.mAST = $$; }
                                         ast.mAST = $$;
                                     }
 
-stmtlist: stmtlist_ EOF { $$ = $1; }
+stmtlist: stmtlist_ EOF {
+                            $$ = $1;
+                            if (ast.mChunkHandler) FlushChunk(ast, $$);
+                        }
        ;
 stmtlist_: %empty                { $$ = efd::NDStmtList::Create().release(); }
          | stmtlist_ statement   {
                                      efd::dynCast<efd::NDStmtList>($1)->addChild(efd::Node::uRef($2));
                                      $$ = $1;
+
+                                     if (ast.mChunkHandler && $$->getChildNumber() >= ast.mChunkSize)
+                                         FlushChunk(ast, $$);
                                  }
 
 statement: decl         { $$ = $1; }
@@ -187,44 +216,45 @@ statement: decl         { $$ = $1; }
          ;
 
 include: INCLUDE string ";"     {
-                                    std::istream* istr = nullptr;
-                                    std::ifstream ifs;
-                                    std::istringstream iss;
-                                    efd::ASTWrapper _ast;
-
                                     std::string file = efd::dynCast<efd::NDString>($2)->getVal();
 
-                                    if (StdLib.find(file) != StdLib.end()) {
-                                        _ast = efd::ASTWrapper { file, "./", nullptr, false };
-                                        iss.str(StdLib[file]);
-                                        istr = &iss;
+                                    if (efd::IsStdLib(file)) {
+                                        // The standard library is neither re-parsed nor cloned.
+                                        // Its include is left empty, since its (shared) gates
+                                        // are taken from 'GetStdLibGates' instead.
                                         ast.mStdLibParsed = true;
+                                        $$ = efd::NDInclude::Create
+                                            (efd::NDString::uRef($2), efd::NDStmtList::Create())
+                                            .release();
                                     } else {
+                                        efd::MappedFile::uRef mapped;
+                                        efd::ASTWrapper _ast;
+
                                         std::vector<std::string> includePaths = IncludePath.getVal();
                                         includePaths.push_back(ast.mPath);
 
                                         for (auto path : includePaths) {
                                             _ast = efd::ASTWrapper { file, path, nullptr, false };
-                                            ifs.open((_ast.mPath + _ast.mFile).c_str());
-                                            if (!ifs.fail()) {
-                                                istr = &ifs;
-                                                break;
-                                            }
+                                            mapped = efd::MappedFile::Open(_ast.mPath + _ast.mFile);
+                                            if (mapped.get() != nullptr) break;
                                         }
-                                    }
 
-                                    if (istr == nullptr) {
-                                        error(@$, "Could not open file: " + _ast.mPath + _ast.mFile);
-                                        error(@$, "Error: " + std::string(strerror(errno)));
-                                        return 1;
-                                    }
+                                        if (mapped.get() == nullptr) {
+                                            error(@$, "Could not open file: " + _ast.mPath + _ast.mFile);
+                                            error(@$, "Error: " + std::string(strerror(errno)));
+                                            return 1;
+                                        }
+
+                                        efd::MemoryStreamBuf buf(mapped->data(), mapped->size());
+                                        std::istream in(&buf);
 
-                                    efd::yy::EfdParser parser(_ast, scanner);
-                                    scanner.yypush_buffer_state(scanner.yy_create_buffer(istr, YY_BUF_SIZE));
-                                    if (parser.parse()) return 1;
-                                    scanner.yypop_buffer_state();
+                                        efd::yy::EfdParser parser(_ast, scanner);
+                                        scanner.yypush_buffer_state(scanner.yy_create_buffer(&in, YY_BUF_SIZE));
+                                        if (parser.parse()) return 1;
+                                        scanner.yypop_buffer_state();
 
-                                    $$ = efd::NDInclude::Create(efd::NDString::uRef($2), efd::Node::uRef(_ast.mAST)).release();
+                                        $$ = efd::NDInclude::Create(efd::NDString::uRef($2), efd::Node::uRef(_ast.mAST)).release();
+                                    }
                                 }
         ;
 
@@ -379,46 +409,57 @@ idref: id "[" integer "]"   {
                             }
      ;
 
-id: ID { $$ = efd::NDId::Create($1).release(); }
+id: ID { $$ = efd::NDId::Create(std::move($1)).release(); }
   ;
 
-integer: INT { $$ = efd::NDInt::Create($1).release(); }
+integer: INT { $$ = efd::NDInt::Create(std::move($1)).release(); }
        ;
 
 string: STRING { $$ = efd::NDString::Create($1.substr(1, $1.length() - 2)).release(); }
 
-real: REAL { $$ = efd::NDReal::Create($1).release(); }
+real: REAL { $$ = efd::NDReal::Create(std::move($1)).release(); }
     ;
 
 %%
 
-static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib) {
-    efd::EfdScanner scanner(&istr, nullptr);
+static void InsertStdLib(efd::NDStmtList* stmts) {
+    for (auto pair : StdLib) {
+        auto refInclude = efd::NDInclude::Create
+            (efd::NDString::Create(pair.first), efd::NDStmtList::Create());
+        auto inclNode = efd::Node::uRef(refInclude.release());
+
+        auto it = stmts->begin();
+        stmts->addChild(it, std::move(inclNode));
+    }
+}
+
+static efd::NDStmtList* GetStatements(efd::Node::Ref root) {
+    efd::NDStmtList* stmts = nullptr;
+
+    if (auto versionNode = efd::dynCast<efd::NDQasmVersion>(root))
+        stmts = versionNode->getStatements();
+    else if (auto stmtsNode = efd::dynCast<efd::NDStmtList>(root))
+        stmts = stmtsNode;
+    else {
+        // One should not be able to reach this point.
+        // This means that the first node of the AST is neither a
+        // statements list nor a qasm version node.
+        assert(false && "Unreacheable.");
+    }
+
+    return stmts;
+}
+
+// Parses \p istr, whose locations begin at \p start (e.g.: the file name, if any).
+static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib,
+        efd::yy::position start = efd::yy::position()) {
+    efd::EfdScanner scanner(&istr, nullptr, start);
     efd::yy::EfdParser parser(ast, scanner);
 
     int ret = parser.parse();
 
     if (!ret && forceStdLib && !ast.mStdLibParsed) {
-        efd::NDStmtList* stmts = nullptr;
-        if (auto versionNode = efd::dynCast<efd::NDQasmVersion>(ast.mAST))
-            stmts = versionNode->getStatements();
-        else if (auto stmtsNode = efd::dynCast<efd::NDStmtList>(ast.mAST))
-            stmts = stmtsNode;
-        else {
-            // One should not be able to reach this point.
-            // This means that the first node of the AST is neither a
-            // statements list nor a qasm version node.
-            assert(false && "Unreacheable.");
-        }
-
-        for (auto pair : StdLib) {
-            auto refInclude = efd::NDInclude::Create
-                (efd::NDString::Create(pair.first), efd::ParseString(pair.second, false));
-            auto inclNode = efd::Node::uRef(refInclude.release());
-
-            auto it = stmts->begin();
-            stmts->addChild(it, std::move(inclNode));
-        }
+        InsertStdLib(GetStatements(ast.mAST));
     }
 
     return ret;
@@ -427,16 +468,22 @@ static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib) {
 efd::Node::uRef efd::ParseFile(std::string filename, std::string path, bool forceStdLib) {
     ASTWrapper ast { filename, path, nullptr, false };
 
-    std::ifstream ifs((ast.mPath + ast.mFile).c_str());
-    if (ifs.fail()) {
+    // The file is mapped into memory, and read through MemoryStreamBuf. That
+    // way, we avoid the intermediate copies of std::ifstream. Flex still copies
+    // it, block by block, into its own buffer: a C++ scanner ('%option c++')
+    // has no 'yy_scan_buffer' to scan the mapping in place.
+    auto mapped = efd::MappedFile::Open(ast.mPath + ast.mFile);
+    if (mapped.get() == nullptr) {
         std::cerr << "Could not open file: " << ast.mPath + ast.mFile << std::endl;
         std::cerr << "Error: " << strerror(errno) << std::endl;
         return nullptr;
     }
 
-    if (Parse(ifs, ast, forceStdLib)) return efd::Node::uRef(nullptr);
+    efd::MemoryStreamBuf buf(mapped->data(), mapped->size());
+    std::istream in(&buf);
 
-    ifs.close();
+    if (Parse(in, ast, forceStdLib, efd::yy::position(&ast.mFile)))
+        return efd::Node::uRef(nullptr);
     return efd::Node::uRef(ast.mAST);
 }
 
@@ -451,3 +498,189 @@ efd::Node::uRef efd::ParseString(std::string program, bool forceStdLib) {
     if (ret) return efd::Node::uRef(nullptr);
     return efd::Node::uRef(ast.mAST);
 }
+
+efd::Node::uRef efd::ParseFileInChunks(std::string filename, std::string path,
+        uint32_t chunkSize, ChunkHandler handler, bool forceStdLib) {
+    assert(chunkSize > 0 && "Chunks must have at least one statement.");
+
+    ASTWrapper ast { filename, path, nullptr, false };
+
+    auto mapped = efd::MappedFile::Open(ast.mPath + ast.mFile);
+    if (mapped.get() == nullptr) {
+        std::cerr << "Could not open file: " << ast.mPath + ast.mFile << std::endl;
+        std::cerr << "Error: " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+
+    bool isFirstChunk = true;
+    bool stdLibInserted = false;
+
+    // The standard library is inserted in the first chunk, if it was not
+    // included until then. Its includes in later chunks are, then, dropped
+    // so that it is not inserted twice.
+    ast.mChunkSize = chunkSize;
+    ast.mChunkHandler = [&](efd::NDStmtList::uRef chunk) {
+        if (isFirstChunk && forceStdLib && !ast.mStdLibParsed) {
+            InsertStdLib(chunk.get());
+            stdLibInserted = true;
+        } else if (stdLibInserted) {
+            for (auto it = chunk->begin(); it != chunk->end();) {
+                auto include = efd::dynCast<efd::NDInclude>(it->get());
+
+                if (include != nullptr && efd::IsStdLib(include->getFilename()->getVal())) {
+                    it = chunk->removeChild(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        isFirstChunk = false;
+        handler(std::move(chunk));
+    };
+
+    efd::MemoryStreamBuf buf(mapped->data(), mapped->size());
+    std::istream in(&buf);
+
+    if (Parse(in, ast, false, efd::yy::position(&ast.mFile)))
+        return efd::Node::uRef(nullptr);
+    return efd::Node::uRef(ast.mAST);
+}
+
+namespace {
+    /// \brief A piece of the input that can be parsed on its own.
+    struct InputChunk {
+        const char* mBegin;
+        const char* mEnd;
+        efd::yy::position mStart;
+    };
+}
+
+// Splits the input into (at most) \p n chunks of similar size. They are cut only
+// at the end of top-level statements, i.e.: right after a ';' or a '}' that is
+// not inside a gate body, a comment, or a string.
+static std::vector<InputChunk> SplitInput(const char* data, std::size_t size,
+        uint32_t n, std::string* filename) {
+    std::vector<InputChunk> chunks;
+    std::size_t chunkSize = size / n + 1;
+
+    const char* begin = data;
+    efd::yy::position start(filename);
+
+    uint32_t depth = 0;
+    uint32_t line = 1, column = 1;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        bool isStmtEnd = false;
+
+        if (c == '\n') {
+            ++line;
+            column = 1;
+            continue;
+        }
+
+        if (c == '/' && i + 1 < size && data[i + 1] == '/') {
+            // Comment: skip until the end of the line.
+            for (; i + 1 < size && data[i + 1] != '\n'; ++i, ++column);
+        } else if (c == '"') {
+            // String: as the scanner does, go until the last '"' in this line.
+            std::size_t last = i;
+            for (std::size_t j = i + 1; j < size && data[j] != '\n'; ++j)
+                if (data[j] == '"') last = j;
+            column += last - i;
+            i = last;
+        } else if (c == '{') {
+            ++depth;
+        } else if (c == '}' && depth > 0) {
+            isStmtEnd = (--depth == 0);
+        } else if (c == ';') {
+            isStmtEnd = (depth == 0);
+        }
+
+        ++column;
+
+        if (isStmtEnd && chunks.size() + 1 < n &&
+                (std::size_t) (data + i + 1 - begin) >= chunkSize) {
+            chunks.push_back(InputChunk { begin, data + i + 1, start });
+            begin = data + i + 1;
+            start = efd::yy::position(filename, line, column);
+        }
+    }
+
+    chunks.push_back(InputChunk { begin, data + size, start });
+    return chunks;
+}
+
+efd::Node::uRef efd::ParseFileParallel(std::string filename, std::string path,
+        uint32_t threads, bool forceStdLib) {
+    if (threads <= 1) return ParseFile(filename, path, forceStdLib);
+
+    ASTWrapper ast { filename, path, nullptr, false };
+
+    auto mapped = efd::MappedFile::Open(ast.mPath + ast.mFile);
+    if (mapped.get() == nullptr) {
+        std::cerr << "Could not open file: " << ast.mPath + ast.mFile << std::endl;
+        std::cerr << "Error: " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+
+    auto chunks = SplitInput(mapped->data(), mapped->size(), threads, &ast.mFile);
+    uint32_t nofChunks = chunks.size();
+
+    std::vector<ASTWrapper> asts(nofChunks, ast);
+    std::vector<int> rets(nofChunks, 0);
+    std::vector<std::thread> workers;
+
+    // Each chunk has its own scanner and parser, starting at the
+    // location where the chunk begins.
+    for (uint32_t i = 0; i < nofChunks; ++i) {
+        workers.push_back(std::thread([&, i]() {
+            efd::TraceSpan span("parse: chunk");
+            efd::MemoryStreamBuf buf(chunks[i].mBegin, chunks[i].mEnd - chunks[i].mBegin);
+            std::istream in(&buf);
+
+            efd::EfdScanner scanner(&in, nullptr, chunks[i].mStart);
+            efd::yy::EfdParser parser(asts[i], scanner);
+            rets[i] = parser.parse();
+        }));
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<efd::Node::uRef> roots;
+    bool failed = false;
+
+    for (uint32_t i = 0; i < nofChunks; ++i) {
+        roots.push_back(efd::Node::uRef(asts[i].mAST));
+        failed = failed || rets[i];
+
+        if (!rets[i] && i > 0 && efd::instanceOf<efd::NDQasmVersion>(asts[i].mAST)) {
+            std::cerr << filename << ":" << chunks[i].mStart.line << ":"
+                << chunks[i].mStart.column << ": "
+                << "OPENQASM version must be the first statement." << std::endl;
+            failed = true;
+        }
+
+        ast.mStdLibParsed = ast.mStdLibParsed || asts[i].mStdLibParsed;
+    }
+
+    if (failed) return efd::Node::uRef(nullptr);
+
+    // Stitching the statements of all chunks together, in order.
+    auto stmts = GetStatements(roots[0].get());
+
+    for (uint32_t i = 1; i < nofChunks; ++i) {
+        for (auto& stmt : *roots[i]) {
+            stmts->addChild(std::move(stmt));
+        }
+    }
+
+    if (forceStdLib && !ast.mStdLibParsed) {
+        InsertStdLib(stmts);
+    }
+
+    return std::move(roots[0]);
+}
@@ -1,6 +1,8 @@
+#include "enfield/Analysis/Driver.h"
 #include "enfield/Support/CommandLine.h"
 
 #include <unordered_map>
+#include <cassert>
 
 static std::string Qelib1 =
 #define EFD_LIB(...) #__VA_ARGS__
@@ -14,3 +16,29 @@ efd::Opt<std::vector<std::string>> IncludePath
 std::unordered_map<std::string, std::string> StdLib = {
     { "qelib1.inc", Qelib1 }
 };
+
+typedef std::unordered_map<std::string, efd::Node::uRef> StdLibASTMap;
+
+static StdLibASTMap ParseStdLib() {
+    StdLibASTMap asts;
+
+    for (auto& pair : StdLib) {
+        asts[pair.first] = efd::ParseString(pair.second, false);
+        assert(asts[pair.first].get() != nullptr && "Could not parse standard library.");
+    }
+
+    return asts;
+}
+
+bool efd::IsStdLib(std::string file) {
+    return StdLib.find(file) != StdLib.end();
+}
+
+efd::Node::Ref efd::GetStdLibAST(std::string file) {
+    // Every standard library file is parsed the first time any of them is
+    // requested. From then on, only the cached AST is used.
+    static StdLibASTMap ASTs = ParseStdLib();
+
+    assert(ASTs.find(file) != ASTs.end() && "Not a standard library file.");
+    return ASTs.at(file).get();
+}
@@ -0,0 +1,92 @@
+#include "enfield/Arch/ArchCache.h"
+#include "enfield/Support/Defs.h"
+
+#include <queue>
+#include <cassert>
+
+using namespace efd;
+
+static std::vector<uint32_t> CalculateDistance(uint32_t u, ArchGraph::Ref graph) {
+    uint32_t size = graph->size();
+    std::vector<uint32_t> distance(size, _undef);
+    std::queue<uint32_t> q;
+    std::vector<bool> visited(size, false);
+
+    q.push(u);
+    visited[u] = true;
+    distance[u] = 0;
+
+    while (!q.empty()) {
+        uint32_t u = q.front();
+        q.pop();
+
+        for (uint32_t v : graph->adj(u)) {
+            if (!visited[v]) {
+                visited[v] = true;
+                distance[v] = distance[u] + 1;
+                q.push(v);
+            }
+        }
+    }
+
+    return distance;
+}
+
+ArchCache::ArchCache(ArchGraph::sRef arch) : mArch(arch) {}
+
+ArchGraph::sRef ArchCache::getArchGraph() const {
+    return mArch;
+}
+
+const ArchCache::Matrix& ArchCache::getDistance() {
+    std::call_once(mDistanceFlag, [this]() {
+        for (uint32_t i = 0, e = mArch->size(); i < e; ++i) {
+            mDistance.push_back(CalculateDistance(i, mArch.get()));
+        }
+    });
+
+    return mDistance;
+}
+
+std::vector<uint32_t> ArchCache::getPath(uint32_t u, uint32_t v) {
+    auto& distance = getDistance();
+    if (distance[u][v] == _undef) return std::vector<uint32_t>();
+
+    std::vector<uint32_t> path { u };
+
+    // Any neighbour one step closer to 'v' is in a shortest path.
+    auto isCloser = [&](uint32_t w, uint32_t x) {
+        return distance[w][v] + 1 == distance[x][v];
+    };
+
+    while (path.back() != v) {
+        uint32_t x = path.back(), next = x;
+
+        for (uint32_t w : mArch->succ(x)) {
+            if (isCloser(w, x)) { next = w; break; }
+        }
+
+        if (next == x) {
+            for (uint32_t w : mArch->pred(x)) {
+                if (isCloser(w, x)) { next = w; break; }
+            }
+        }
+
+        assert(next != x && "Distances inconsistent with the architecture.");
+        path.push_back(next);
+    }
+
+    return path;
+}
+
+ExpTSFinder& ArchCache::getExpTSFinder() {
+    std::call_once(mExpTSFinderFlag, [this]() {
+        mExpTSFinder = ExpTSFinder::Create(mArch);
+    });
+
+    return *mExpTSFinder;
+}
+
+ArchCache::sRef ArchCache::Create(ArchGraph::sRef arch) {
+    return sRef(new ArchCache(arch));
+}
@@ -58,7 +58,7 @@ void efd::ArchGraph::putReg(std::string id, std::string size) {
 
 uint32_t efd::ArchGraph::getUId(std::string s) {
     assert(hasSId(s) && "No such vertex with this string id.");
-    return mStrToId[s];
+    return mStrToId.find(s)->second;
 }
 
 bool efd::ArchGraph::hasSId(std::string s) const {
@@ -71,9 +71,7 @@ std::string efd::ArchGraph::getSId(uint32_t i) {
 }
 
 bool efd::ArchGraph::isReverseEdge(uint32_t i, uint32_t j) {
-    auto& succ = mSuccessors[i];
-    auto& pred = mPredecessors[i];
-    return succ.find(j) == succ.end() && pred.find(j) != pred.end();
+    return !hasEdge(i, j) && hasEdge(j, i);
 }
 
 bool efd::ArchGraph::isGeneric() {
@@ -0,0 +1,26 @@
+#include "enfield/Support/AllocationCounter.h"
+
+#include <atomic>
+
+// Trivial types only, since they are touched by operator new (i.e.: even
+// before the thread is done constructing anything else).
+static thread_local uint64_t AllocatedBytes = 0;
+static thread_local uint64_t Allocations = 0;
+static std::atomic<bool> Hooked(false);
+
+void efd::AllocationCounter::Record(std::size_t bytes) {
+    AllocatedBytes += bytes;
+    ++Allocations;
+
+    if (!Hooked.load(std::memory_order_relaxed)) {
+        Hooked.store(true, std::memory_order_relaxed);
+    }
+}
+
+efd::AllocationCounter::Counts efd::AllocationCounter::Get() {
+    return Counts { AllocatedBytes, Allocations };
+}
+
+bool efd::AllocationCounter::IsHooked() {
+    return Hooked.load(std::memory_order_relaxed);
+}
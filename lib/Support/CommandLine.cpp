@@ -245,6 +245,22 @@ void efd::ParseArguments(const int argc, const char **argv) {
             arg = arg.substr(1);
         }
 
+        // Options with one argument may also be given as '-name=value'.
+        auto equals = arg.find('=');
+
+        if (Parser->mArgMap.find(arg) == Parser->mArgMap.end() && equals != std::string::npos) {
+            auto name = arg.substr(0, equals);
+            auto it = Parser->mArgMap.find(name);
+
+            if (it != Parser->mArgMap.end() && it->second[0]->argsConsumed() == 1) {
+                for (OptBase *opt : it->second) {
+                    opt->parse({ arg.substr(equals + 1) });
+                }
+
+                continue;
+            }
+        }
+
         if (Parser->mArgMap.find(arg) != Parser->mArgMap.end()) {
             std::vector<OptBase*>& optVector = Parser->mArgMap[arg];
 
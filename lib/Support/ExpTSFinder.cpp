@@ -31,7 +31,10 @@ uint32_t efd::ExpTSFinder::getTargetId(Assign source, Assign target) {
         realtgt[i] = translator[target[i]];
     }
 
-    return mMapId[realtgt];
+    // Only looking up, so that many threads may use the same finder.
+    auto it = mMapId.find(realtgt);
+    assert(it != mMapId.end() && "Assignment is not a permutation.");
+    return it->second;
 }
 
 // Pre-process the architechture graph, calculating the optimal swaps from every
@@ -9,11 +9,13 @@
 efd::Graph::Graph(Kind k, uint32_t n, Type ty) : mK(k), mN(n), mTy(ty) {
     mSuccessors.assign(n, std::set<uint32_t>());
     mPredecessors.assign(n, std::set<uint32_t>());
+    mAdjacency.assign(n * n, false);
 }
 
 efd::Graph::Graph(uint32_t n, Type ty) : mK(K_GRAPH), mN(n), mTy(ty) {
     mSuccessors.assign(n, std::set<uint32_t>());
     mPredecessors.assign(n, std::set<uint32_t>());
+    mAdjacency.assign(n * n, false);
 }
 
 std::string efd::Graph::vertexToString(uint32_t i) const {
@@ -55,18 +57,19 @@ std::set<uint32_t> efd::Graph::adj(uint32_t i) const {
     return adj;
 }
 
-bool efd::Graph::hasEdge(uint32_t i, uint32_t j) {
-    std::set<uint32_t>& succ = this->succ(i);
-    return succ.find(j) != succ.end();
+bool efd::Graph::hasEdge(uint32_t i, uint32_t j) const {
+    return mAdjacency[i * mN + j];
 }
 
 void efd::Graph::putEdge(uint32_t i, uint32_t j) {
     mSuccessors[i].insert(j);
     mPredecessors[j].insert(i);
+    mAdjacency[i * mN + j] = true;
 
     if (!isDirectedGraph()) {
         mSuccessors[j].insert(i);
         mPredecessors[i].insert(j);
+        mAdjacency[j * mN + i] = true;
     }
 }
 
@@ -0,0 +1,27 @@
+#include "enfield/Support/JSON.h"
+
+#include <cstdio>
+
+std::string efd::ToJSONString(const std::string& str) {
+    std::string escaped = "\"";
+
+    for (char c : str) {
+        switch (c) {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if ((unsigned char) c < 0x20) {
+                    char hex[8];
+                    snprintf(hex, sizeof(hex), "\\u%04x", (unsigned char) c);
+                    escaped += hex;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+
+    return escaped + "\"";
+}
@@ -0,0 +1,86 @@
+#include "enfield/Support/MappedFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+efd::MappedFile::MappedFile(const char* data, std::size_t size)
+    : mData(data), mSize(size), mIsMapped(size > 0) {}
+
+efd::MappedFile::MappedFile(std::string buffer)
+    : mIsMapped(false), mBuffer(std::move(buffer)) {
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+}
+
+efd::MappedFile::~MappedFile() {
+    if (mIsMapped) {
+        munmap(const_cast<char*>(mData), mSize);
+    }
+}
+
+static bool ReadWhole(int fd, std::string& buffer) {
+    char chunk[1 << 16];
+
+    for (ssize_t n; (n = read(fd, chunk, sizeof(chunk))) != 0;) {
+        if (n < 0) return false;
+        buffer.append(chunk, n);
+    }
+
+    return true;
+}
+
+const char* efd::MappedFile::data() const {
+    return mData;
+}
+
+std::size_t efd::MappedFile::size() const {
+    return mSize;
+}
+
+efd::MappedFile::uRef efd::MappedFile::Open(std::string filepath) {
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) return uRef(nullptr);
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return uRef(nullptr);
+    }
+
+    if (!S_ISREG(st.st_mode)) {
+        std::string buffer;
+        bool success = ReadWhole(fd, buffer);
+        close(fd);
+
+        if (!success) return uRef(nullptr);
+        return uRef(new MappedFile(std::move(buffer)));
+    }
+
+    std::size_t size = st.st_size;
+    const char* data = nullptr;
+
+    // Empty files can't be mapped. But they are still valid files.
+    if (size > 0) {
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (addr == MAP_FAILED) {
+            close(fd);
+            return uRef(nullptr);
+        }
+
+        // The scanner reads it only once, from the beginning to the end.
+        madvise(addr, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(addr);
+    }
+
+    // The mapping is kept even after closing the file descriptor.
+    close(fd);
+    return uRef(new MappedFile(data, size));
+}
+
+efd::MemoryStreamBuf::MemoryStreamBuf(const char* data, std::size_t size) {
+    char* begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+}
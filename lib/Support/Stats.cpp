@@ -1,7 +1,11 @@
 #include "enfield/Support/Stats.h"
+#include "enfield/Support/JSON.h"
 
 #include <memory>
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
 #include <map>
 
 namespace efd {
@@ -10,24 +14,53 @@ namespace efd {
             typedef std::map<std::string, StatBase*> StatMap;
 
             StatMap mMap;
+            std::vector<StatBase*> mStats;
 
         public:
-            void addStat(StatBase* stat);
+            /// \brief Adds \p stat, and returns its index.
+            uint32_t addStat(StatBase* stat);
             bool hasStat(std::string name);
 
+            /// \brief Returns the number of stats.
+            uint32_t size() const;
+            /// \brief Returns the stat with index \p id.
+            StatBase* getStat(uint32_t id) const;
+            /// \brief Returns the stats, sorted by name.
+            const StatMap& getSorted() const;
+
             void print(std::ostream& out);
     };
 }
 
-void efd::StatsPool::addStat(StatBase* stat) {
+static const double Epsilon = 0.00001;
+
+static bool IsZero(double val) {
+    return val >= -Epsilon && val <= Epsilon;
+}
+
+uint32_t efd::StatsPool::addStat(StatBase* stat) {
     assert(!hasStat(stat->getName()) && "Stat with the same name already defined.");
     mMap[stat->getName()] = stat;
+    mStats.push_back(stat);
+    return mStats.size() - 1;
 }
 
 bool efd::StatsPool::hasStat(std::string name) {
     return mMap.find(name) != mMap.end();
 }
 
+uint32_t efd::StatsPool::size() const {
+    return mStats.size();
+}
+
+efd::StatBase* efd::StatsPool::getStat(uint32_t id) const {
+    return mStats[id];
+}
+
+const efd::StatsPool::StatMap& efd::StatsPool::getSorted() const {
+    return mMap;
+}
+
 void efd::StatsPool::print(std::ostream& out) {
     for (auto pair : mMap) {
         if (!pair.second->isZero())
@@ -40,10 +73,217 @@ static std::shared_ptr<efd::StatsPool> getPool() {
     return Pool;
 }
 
+static void PrintHeader(std::ostream& out) {
+    out << std::endl;
+    out << " ==-------------- Stats --------------==" << std::endl;
+}
+
+static void PrintFooter(std::ostream& out) {
+    out << " ==-----------------------------------==" << std::endl;
+}
+
+/// \brief Returns the histogram bucket of \p val: -1 for [0, 1), and
+/// floor(log2(val)) otherwise.
+static int32_t GetBucket(double val) {
+    val = std::fabs(val);
+    if (val < 1) return -1;
+    return static_cast<int32_t>(std::floor(std::log2(val)));
+}
+
+static double GetBucketBegin(int32_t bucket) {
+    return (bucket < 0) ? 0 : std::ldexp(1, bucket);
+}
+
+static double GetBucketEnd(int32_t bucket) {
+    return std::ldexp(1, bucket + 1);
+}
+
+static std::string ToJSONNumber(double val) {
+    if (!std::isfinite(val)) return "null";
+
+    std::ostringstream ss;
+    ss.precision(10);
+    ss << val;
+    return ss.str();
+}
+
+static void PrintJSONHistogram(std::ostream& out, const std::map<int32_t, uint32_t>& histogram) {
+    out << "[";
+
+    bool first = true;
+    for (auto bucket : histogram) {
+        if (!first) out << ",";
+        first = false;
+
+        out << "{\"begin\":" << ToJSONNumber(GetBucketBegin(bucket.first))
+            << ",\"end\":" << ToJSONNumber(GetBucketEnd(bucket.first))
+            << ",\"count\":" << bucket.second << "}";
+    }
+
+    out << "]";
+}
+
+namespace {
+    /// \brief One stat to be printed.
+    struct StatEntry {
+        efd::StatBase* mStat;
+        double mValue;
+        efd::Distribution mDistribution;
+
+        bool isZero() const {
+            return mStat->isDistribution() ? mDistribution.empty() : IsZero(mValue);
+        }
+    };
+}
+
+// Prints the 'entries' (sorted by name), either as 'value::name::description'
+// lines (skipping the zeroes), or as a JSON object (with every entry).
+static void PrintEntries(std::ostream& out, const std::vector<StatEntry>& entries,
+                         efd::StatsFormat format) {
+    if (format == efd::StatsFormat::Text) {
+        PrintHeader(out);
+
+        for (auto& entry : entries) {
+            if (entry.isZero()) continue;
+
+            auto stat = entry.mStat;
+            auto value = stat->isDistribution() ? entry.mDistribution.toString()
+                                                : stat->format(entry.mValue);
+            out << value << "::" << stat->getName() << "::" << stat->getDescription() << std::endl;
+        }
+
+        PrintFooter(out);
+        return;
+    }
+
+    out << "{\"stats\":[";
+
+    for (uint32_t i = 0, e = entries.size(); i < e; ++i) {
+        auto& entry = entries[i];
+        auto stat = entry.mStat;
+
+        out << (i ? ",\n" : "\n")
+            << "{\"name\":" << efd::ToJSONString(stat->getName())
+            << ",\"description\":" << efd::ToJSONString(stat->getDescription());
+
+        if (stat->isDistribution()) {
+            out << ",\"distribution\":";
+            entry.mDistribution.printJSON(out);
+        } else {
+            out << ",\"value\":" << ToJSONNumber(entry.mValue);
+        }
+
+        out << "}";
+    }
+
+    out << "\n]}" << std::endl;
+}
+
+// ----------------------------------------------------------------
+// ---------------------- Distribution Class ----------------------
+// ----------------------------------------------------------------
+
+efd::Distribution::Distribution() : mSorted(true) {
+}
+
+void efd::Distribution::sort() const {
+    if (mSorted) return;
+
+    std::sort(mSamples.begin(), mSamples.end());
+    mSorted = true;
+}
+
+void efd::Distribution::add(double val) {
+    mSorted = mSorted && (mSamples.empty() || mSamples.back() <= val);
+    mSamples.push_back(val);
+}
+
+void efd::Distribution::merge(const Distribution& other) {
+    mSamples.insert(mSamples.end(), other.mSamples.begin(), other.mSamples.end());
+    mSorted = mSorted && other.mSamples.empty();
+}
+
+uint32_t efd::Distribution::size() const {
+    return mSamples.size();
+}
+
+bool efd::Distribution::empty() const {
+    return mSamples.empty();
+}
+
+double efd::Distribution::getSum() const {
+    double sum = 0;
+    for (double val : mSamples) sum += val;
+    return sum;
+}
+
+double efd::Distribution::getMin() const {
+    if (empty()) return 0;
+    sort();
+    return mSamples.front();
+}
+
+double efd::Distribution::getMax() const {
+    if (empty()) return 0;
+    sort();
+    return mSamples.back();
+}
+
+double efd::Distribution::getMean() const {
+    if (empty()) return 0;
+    return getSum() / size();
+}
+
+double efd::Distribution::getPercentile(double p) const {
+    if (empty()) return 0;
+    sort();
+
+    double rank = std::ceil(p / 100.0 * size());
+    uint32_t idx = std::min<double>(std::max(rank, 1.0), size()) - 1;
+    return mSamples[idx];
+}
+
+std::map<int32_t, uint32_t> efd::Distribution::getHistogram() const {
+    std::map<int32_t, uint32_t> histogram;
+    for (double val : mSamples) ++histogram[GetBucket(val)];
+    return histogram;
+}
+
+std::string efd::Distribution::toString() const {
+    std::ostringstream ss;
+
+    ss << "n=" << size()
+       << ",mean=" << getMean()
+       << ",p50=" << getPercentile(50)
+       << ",p90=" << getPercentile(90)
+       << ",p99=" << getPercentile(99)
+       << ",max=" << getMax();
+
+    return ss.str();
+}
+
+void efd::Distribution::printJSON(std::ostream& out) const {
+    out << "{\"count\":" << size()
+        << ",\"sum\":" << ToJSONNumber(getSum())
+        << ",\"min\":" << ToJSONNumber(getMin())
+        << ",\"max\":" << ToJSONNumber(getMax())
+        << ",\"mean\":" << ToJSONNumber(getMean())
+        << ",\"p50\":" << ToJSONNumber(getPercentile(50))
+        << ",\"p90\":" << ToJSONNumber(getPercentile(90))
+        << ",\"p99\":" << ToJSONNumber(getPercentile(99))
+        << ",\"histogram\":";
+    PrintJSONHistogram(out, getHistogram());
+    out << "}";
+}
+
+// ----------------------------------------------------------------
+// ------------------------ StatBase Class ------------------------
+// ----------------------------------------------------------------
+
 efd::StatBase::StatBase(std::string name, std::string description) :
     mName(name), mDescription(description) {
     mPool = getPool();
-    mPool->addStat(this);
+    mId = mPool->addStat(this);
 }
 
 void efd::StatBase::print(std::ostream& out) {
@@ -58,11 +298,315 @@ std::string efd::StatBase::getDescription() const {
     return mDescription;
 }
 
-void efd::PrintStats(std::ostream& out) {
+uint32_t efd::StatBase::getId() const {
+    return mId;
+}
+
+bool efd::StatBase::isDistribution() const {
+    return false;
+}
+
+// ----------------------------------------------------------------
+// -------------------- DistributionStat Class --------------------
+// ----------------------------------------------------------------
+
+efd::DistributionStat::DistributionStat(std::string name, std::string description)
+    : StatBase(name, description) {
+}
+
+void efd::DistributionStat::add(double val) {
+    if (auto context = StatsContext::GetCurrent()) {
+        context->addSample(mId, val);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDistribution.add(val);
+}
+
+efd::Distribution efd::DistributionStat::getDistribution() const {
+    if (auto context = StatsContext::GetCurrent()) {
+        return context->getDistribution(mId);
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDistribution;
+}
+
+bool efd::DistributionStat::isZero() const {
+    return getDistribution().empty();
+}
+
+bool efd::DistributionStat::isDistribution() const {
+    return true;
+}
+
+double efd::DistributionStat::getValue() const {
+    return getDistribution().size();
+}
+
+std::string efd::DistributionStat::toString() const {
+    return getDistribution().toString() + "::" + mName + "::" + mDescription;
+}
+
+std::string efd::DistributionStat::format(double val) const {
+    std::ostringstream ss;
+    ss << val;
+    return ss.str();
+}
+
+// ----------------------------------------------------------------
+// ---------------------- StatsContext Class ----------------------
+// ----------------------------------------------------------------
+
+static thread_local efd::StatsContext::Ref CurrentContext = nullptr;
+
+double efd::StatsContext::get(uint32_t id) const {
+    if (id >= mValues.size()) return 0;
+    return mValues[id];
+}
+
+void efd::StatsContext::set(uint32_t id, double val) {
+    if (id >= mValues.size()) mValues.resize(getPool()->size(), 0);
+    mValues[id] = val;
+}
+
+efd::Distribution efd::StatsContext::getDistribution(uint32_t id) const {
+    if (id >= mDistributions.size()) return Distribution();
+    return mDistributions[id];
+}
+
+void efd::StatsContext::addSample(uint32_t id, double val) {
+    if (id >= mDistributions.size()) mDistributions.resize(getPool()->size());
+    mDistributions[id].add(val);
+}
+
+void efd::StatsContext::merge(const StatsContext& other) {
+    if (mValues.size() < other.mValues.size()) mValues.resize(other.mValues.size(), 0);
+    if (mDistributions.size() < other.mDistributions.size())
+        mDistributions.resize(other.mDistributions.size());
+
+    for (uint32_t i = 0, e = other.mValues.size(); i < e; ++i) {
+        mValues[i] += other.mValues[i];
+    }
+
+    for (uint32_t i = 0, e = other.mDistributions.size(); i < e; ++i) {
+        mDistributions[i].merge(other.mDistributions[i]);
+    }
+}
+
+void efd::StatsContext::print(std::ostream& out, StatsFormat format) const {
+    std::vector<StatEntry> entries;
+
+    for (auto pair : getPool()->getSorted()) {
+        auto stat = pair.second;
+        uint32_t id = stat->getId();
+
+        if (stat->isDistribution()) {
+            entries.push_back({ stat, 0, getDistribution(id) });
+        } else {
+            entries.push_back({ stat, get(id), Distribution() });
+        }
+    }
+
+    PrintEntries(out, entries, format);
+}
+
+efd::StatsContext::Ref efd::StatsContext::GetCurrent() {
+    return CurrentContext;
+}
+
+efd::StatsContext::sRef efd::StatsContext::Create() {
+    return sRef(new StatsContext());
+}
+
+// ----------------------------------------------------------------
+// ----------------------- StatsScope Class -----------------------
+// ----------------------------------------------------------------
+
+efd::StatsScope::StatsScope(StatsContext::Ref context) : mPrevious(CurrentContext) {
+    CurrentContext = context;
+}
+
+efd::StatsScope::~StatsScope() {
+    CurrentContext = mPrevious;
+}
+
+// ----------------------------------------------------------------
+// --------------------- StatsAggregate Class ---------------------
+// ----------------------------------------------------------------
+
+efd::StatsAggregate::StatsAggregate() : mContexts(0) {
+}
+
+void efd::StatsAggregate::add(const StatsContext& context) {
+    uint32_t size = getPool()->size();
+    if (mSummaries.size() < size) mSummaries.resize(size, Summary { 0, 0, 0, 0, {} });
+    if (mDistributions.size() < size) mDistributions.resize(size);
+
+    ++mContexts;
+
+    for (uint32_t i = 0; i < size; ++i) {
+        mDistributions[i].merge(context.getDistribution(i));
+
+        double val = context.get(i);
+        if (IsZero(val)) continue;
+
+        auto& summary = mSummaries[i];
+
+        if (summary.mCount == 0) {
+            summary.mMin = summary.mMax = val;
+        } else {
+            summary.mMin = std::min(summary.mMin, val);
+            summary.mMax = std::max(summary.mMax, val);
+        }
+
+        ++summary.mCount;
+        summary.mSum += val;
+        ++summary.mHistogram[GetBucket(val)];
+    }
+}
+
+void efd::StatsAggregate::merge(const StatsAggregate& other) {
+    if (mSummaries.size() < other.mSummaries.size())
+        mSummaries.resize(other.mSummaries.size(), Summary { 0, 0, 0, 0, {} });
+    if (mDistributions.size() < other.mDistributions.size())
+        mDistributions.resize(other.mDistributions.size());
+
+    mContexts += other.mContexts;
+
+    for (uint32_t i = 0, e = other.mDistributions.size(); i < e; ++i) {
+        mDistributions[i].merge(other.mDistributions[i]);
+    }
+
+    for (uint32_t i = 0, e = other.mSummaries.size(); i < e; ++i) {
+        auto& theirs = other.mSummaries[i];
+        auto& ours = mSummaries[i];
+
+        if (theirs.mCount == 0) continue;
+
+        if (ours.mCount == 0) {
+            ours = theirs;
+            continue;
+        }
+
+        ours.mCount += theirs.mCount;
+        ours.mSum += theirs.mSum;
+        ours.mMin = std::min(ours.mMin, theirs.mMin);
+        ours.mMax = std::max(ours.mMax, theirs.mMax);
+
+        for (auto pair : theirs.mHistogram) {
+            ours.mHistogram[pair.first] += pair.second;
+        }
+    }
+}
+
+uint32_t efd::StatsAggregate::getContexts() const {
+    return mContexts;
+}
+
+efd::StatsAggregate::Summary efd::StatsAggregate::getSummary(uint32_t id) const {
+    if (id >= mSummaries.size()) return Summary { 0, 0, 0, 0, {} };
+    return mSummaries[id];
+}
+
+efd::Distribution efd::StatsAggregate::getDistribution(uint32_t id) const {
+    if (id >= mDistributions.size()) return Distribution();
+    return mDistributions[id];
+}
+
+void efd::StatsAggregate::print(std::ostream& out, StatsFormat format) const {
+    if (format == StatsFormat::JSON) {
+        out << "{\"compilations\":" << mContexts << ",\"stats\":[";
+
+        bool first = true;
+        for (auto pair : getPool()->getSorted()) {
+            auto stat = pair.second;
+            auto summary = getSummary(stat->getId());
+            auto distribution = getDistribution(stat->getId());
+
+            out << (first ? "\n" : ",\n")
+                << "{\"name\":" << ToJSONString(stat->getName())
+                << ",\"description\":" << ToJSONString(stat->getDescription());
+            first = false;
+
+            if (stat->isDistribution()) {
+                out << ",\"distribution\":";
+                distribution.printJSON(out);
+            } else {
+                double mean = summary.mCount ? summary.mSum / summary.mCount : 0;
+                out << ",\"count\":" << summary.mCount
+                    << ",\"sum\":" << ToJSONNumber(summary.mSum)
+                    << ",\"min\":" << ToJSONNumber(summary.mMin)
+                    << ",\"max\":" << ToJSONNumber(summary.mMax)
+                    << ",\"mean\":" << ToJSONNumber(mean)
+                    << ",\"histogram\":";
+                PrintJSONHistogram(out, summary.mHistogram);
+            }
+
+            out << "}";
+        }
+
+        out << "\n]}" << std::endl;
+        return;
+    }
+
+    PrintHeader(out);
+    out << " (" << mContexts << " compilations: sum::min::max::mean::name::description)" << std::endl;
+
+    for (auto pair : getPool()->getSorted()) {
+        auto stat = pair.second;
+        auto summary = getSummary(stat->getId());
+        std::map<int32_t, uint32_t> histogram;
+
+        if (stat->isDistribution()) {
+            auto distribution = getDistribution(stat->getId());
+            if (distribution.empty()) continue;
+
+            out << distribution.toString() << "::"
+                << stat->getName() << "::" << stat->getDescription() << std::endl;
+            histogram = distribution.getHistogram();
+        } else {
+            if (summary.mCount == 0) continue;
+
+            out << stat->format(summary.mSum) << "::"
+                << stat->format(summary.mMin) << "::"
+                << stat->format(summary.mMax) << "::"
+                << summary.mSum / summary.mCount << "::"
+                << stat->getName() << "::" << stat->getDescription() << std::endl;
+            histogram = summary.mHistogram;
+        }
+
+        for (auto bucket : histogram) {
+            out << "    [" << GetBucketBegin(bucket.first) << ", " << GetBucketEnd(bucket.first)
+                << "): " << bucket.second << std::endl;
+        }
+    }
+
+    PrintFooter(out);
+}
+
+void efd::PrintStats(std::ostream& out, StatsFormat format) {
     auto Pool = getPool();
 
-    out << std::endl;
-    out << " ==-------------- Stats --------------==" << std::endl;
-    Pool->print(out);
-    out << " ==-----------------------------------==" << std::endl;
+    if (format == StatsFormat::Text) {
+        PrintHeader(out);
+        Pool->print(out);
+        PrintFooter(out);
+        return;
+    }
+
+    std::vector<StatEntry> entries;
+
+    for (auto pair : Pool->getSorted()) {
+        auto stat = pair.second;
+
+        if (stat->isDistribution()) {
+            entries.push_back({ stat, 0, static_cast<DistributionStat*>(stat)->getDistribution() });
+        } else {
+            entries.push_back({ stat, stat->getValue(), Distribution() });
+        }
+    }
+
+    PrintEntries(out, entries, format);
 }
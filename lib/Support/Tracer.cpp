@@ -0,0 +1,162 @@
+#include "enfield/Support/Tracer.h"
+#include "enfield/Support/JSON.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+
+using namespace efd;
+
+namespace {
+    struct Event {
+        char mPhase;
+        std::string mName;
+        double mTimestamp;
+        double mValue;
+    };
+
+    /// \brief The events of one thread. It outlives the thread, so that its
+    /// events are still written.
+    struct ThreadBuffer {
+        uint32_t mId;
+        std::string mName;
+        std::vector<Event> mEvents;
+        // Only contended while writing (or clearing) the trace.
+        std::mutex mMutex;
+    };
+}
+
+static std::atomic<bool> Enabled(false);
+static const auto Epoch = std::chrono::steady_clock::now();
+
+static std::mutex BuffersMutex;
+static std::vector<std::shared_ptr<ThreadBuffer>> Buffers;
+static thread_local std::shared_ptr<ThreadBuffer> CurrentBuffer;
+
+static ThreadBuffer& GetBuffer() {
+    if (CurrentBuffer.get() == nullptr) {
+        std::lock_guard<std::mutex> lock(BuffersMutex);
+
+        CurrentBuffer.reset(new ThreadBuffer());
+        CurrentBuffer->mId = Buffers.size() + 1;
+        CurrentBuffer->mName = "thread " + std::to_string(CurrentBuffer->mId);
+        Buffers.push_back(CurrentBuffer);
+    }
+
+    return *CurrentBuffer;
+}
+
+static void AddEvent(Event event) {
+    auto& buffer = GetBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mMutex);
+    buffer.mEvents.push_back(std::move(event));
+}
+
+void Tracer::Enable(bool enable) {
+    Enabled.store(enable);
+}
+
+bool Tracer::IsEnabled() {
+    return Enabled.load(std::memory_order_relaxed);
+}
+
+double Tracer::Now() {
+    auto elapsed = std::chrono::steady_clock::now() - Epoch;
+    return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(elapsed).count();
+}
+
+void Tracer::AddSpan(const std::string& name, double begin, double end) {
+    if (!IsEnabled()) return;
+    AddEvent(Event { 'X', name, begin, end - begin });
+}
+
+void Tracer::AddCounter(const std::string& name, double value) {
+    if (!IsEnabled()) return;
+    AddEvent(Event { 'C', name, Now(), value });
+}
+
+void Tracer::SetThreadName(const std::string& name) {
+    if (!IsEnabled()) return;
+
+    auto& buffer = GetBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mMutex);
+    buffer.mName = name;
+}
+
+void Tracer::Clear() {
+    std::lock_guard<std::mutex> lock(BuffersMutex);
+
+    for (auto& buffer : Buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mMutex);
+        buffer->mEvents.clear();
+    }
+}
+
+void Tracer::Write(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(BuffersMutex);
+    char number[64];
+    bool first = true;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (auto& buffer : Buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mMutex);
+        auto tid = std::to_string(buffer->mId);
+
+        out << (first ? "\n" : ",\n");
+        first = false;
+
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":" << ToJSONString(buffer->mName) << "}}";
+
+        for (auto& event : buffer->mEvents) {
+            out << ",\n{\"name\":" << ToJSONString(event.mName) << ",\"ph\":\"" << event.mPhase
+                << "\",\"pid\":1,\"tid\":" << tid;
+
+            snprintf(number, sizeof(number), "%.3f", event.mTimestamp);
+            out << ",\"ts\":" << number;
+
+            snprintf(number, sizeof(number), "%.3f", event.mValue);
+
+            if (event.mPhase == 'X') {
+                out << ",\"dur\":" << number << "}";
+            } else {
+                out << ",\"args\":{\"value\":" << number << "}}";
+            }
+        }
+    }
+
+    out << "\n]}" << std::endl;
+}
+
+bool Tracer::Write(const std::string& filepath) {
+    std::ofstream out(filepath);
+    if (!out.is_open()) return false;
+
+    Write(out);
+    return out.good();
+}
+
+TraceSpan::TraceSpan(const char* name) : mEnabled(Tracer::IsEnabled()), mBegin(0) {
+    if (mEnabled) {
+        mName = name;
+        mBegin = Tracer::Now();
+    }
+}
+
+TraceSpan::TraceSpan(const std::string& name) : mEnabled(Tracer::IsEnabled()), mBegin(0) {
+    if (mEnabled) {
+        mName = name;
+        mBegin = Tracer::Now();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (mEnabled) {
+        Tracer::AddSpan(mName, mBegin, Tracer::Now());
+    }
+}
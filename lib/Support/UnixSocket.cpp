@@ -0,0 +1,129 @@
+#include "enfield/Support/UnixSocket.h"
+
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+const uint32_t efd::UnixSocket::MaxMessageSize = 1u << 30;
+
+efd::UnixSocket::UnixSocket(int fd, std::string unlinkPath)
+    : mFd(fd), mUnlinkPath(unlinkPath) {}
+
+efd::UnixSocket::~UnixSocket() {
+    close(mFd);
+    if (!mUnlinkPath.empty()) unlink(mUnlinkPath.c_str());
+}
+
+// Sends (or receives) exactly 'size' bytes, even if interrupted.
+static bool WriteAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        data += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+static bool ReadAll(int fd, char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = ::recv(fd, data, size, 0);
+
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        data += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+static bool FillAddress(const std::string& path, struct sockaddr_un& addr) {
+    if (path.size() >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    return true;
+}
+
+efd::UnixSocket::uRef efd::UnixSocket::accept() {
+    int fd;
+
+    do {
+        fd = ::accept(mFd, nullptr, nullptr);
+    } while (fd < 0 && errno == EINTR);
+
+    if (fd < 0) return uRef(nullptr);
+    return uRef(new UnixSocket(fd));
+}
+
+bool efd::UnixSocket::send(const std::string& message) {
+    if (message.size() > MaxMessageSize) return false;
+
+    uint32_t size = message.size();
+    char header[4] = {
+        (char) (size >> 24), (char) (size >> 16), (char) (size >> 8), (char) size
+    };
+
+    return WriteAll(mFd, header, 4) && WriteAll(mFd, message.data(), size);
+}
+
+bool efd::UnixSocket::receive(std::string& message) {
+    unsigned char header[4];
+    if (!ReadAll(mFd, (char*) header, 4)) return false;
+
+    uint32_t size = ((uint32_t) header[0] << 24) | ((uint32_t) header[1] << 16) |
+                    ((uint32_t) header[2] << 8) | (uint32_t) header[3];
+    if (size > MaxMessageSize) return false;
+
+    message.resize(size);
+    return size == 0 || ReadAll(mFd, &message[0], size);
+}
+
+efd::UnixSocket::uRef efd::UnixSocket::Listen(std::string path) {
+    struct sockaddr_un addr;
+    if (!FillAddress(path, addr)) return uRef(nullptr);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return uRef(nullptr);
+
+    unlink(path.c_str());
+
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return uRef(nullptr);
+    }
+
+    return uRef(new UnixSocket(fd, path));
+}
+
+efd::UnixSocket::uRef efd::UnixSocket::Connect(std::string path) {
+    struct sockaddr_un addr;
+    if (!FillAddress(path, addr)) return uRef(nullptr);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return uRef(nullptr);
+
+    if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return uRef(nullptr);
+    }
+
+    return uRef(new UnixSocket(fd));
+}
@@ -1,11 +1,13 @@
 #include "enfield/Support/WrapperVal.h"
 
 template <>
-efd::WrapperVal<long long>::WrapperVal(std::string str) : mStr(str) {
+efd::WrapperVal<long long>::WrapperVal(std::string str) : mStr(nullptr) {
     mV = std::stoll(str);
+    if (std::to_string(mV) != str) mStr = std::make_shared<const std::string>(str);
 }
 
 template <>
-efd::WrapperVal<double>::WrapperVal(std::string str) : mStr(str) {
+efd::WrapperVal<double>::WrapperVal(std::string str) : mStr(nullptr) {
     mV = std::stod(str);
+    if (std::to_string(mV) != str) mStr = std::make_shared<const std::string>(str);
 }
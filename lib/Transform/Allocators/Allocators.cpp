@@ -60,8 +60,11 @@ void efd::RegisterQbitAllocator(EnumAllocator key, AllocatorRegistry::CtorTy cto
 }
 
 efd::AllocatorRegistry::RetTy
-efd::CreateQbitAllocator(EnumAllocator key, AllocatorRegistry::ArgTy arg) {
-    return GetRegistry()->createObj(key, arg);
+efd::CreateQbitAllocator(EnumAllocator key, AllocatorRegistry::ArgTy arg,
+                         AllocatorOptions options) {
+    auto allocator = GetRegistry()->createObj(key, arg);
+    allocator->setOptions(options);
+    return allocator;
 }
 
 // -------------- Allocator Functions -----------------
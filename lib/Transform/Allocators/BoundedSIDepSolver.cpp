@@ -3,6 +3,8 @@
 #include "enfield/Support/CommandLine.h"
 #include "enfield/Support/Defs.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/Stats.h"
+#include "enfield/Support/Tracer.h"
 
 #include <cstdlib>
 #include <algorithm>
@@ -11,13 +13,8 @@
 
 using namespace efd;
 
-static Opt<uint32_t> MaxChildren
-("-bsi-max-children", "Limits the max number of children per partial solution.",
- std::numeric_limits<uint32_t>::max(), false);
-
-static Opt<uint32_t> MaxPartialSolutions
-("-bsi-max-partial", "Limits the max number of partial solutions per step.",
- std::numeric_limits<uint32_t>::max(), false);
+static DistributionStat LayerCandidates
+("BSILayerCandidates", "The number of candidate mappings of each layer.");
 
 namespace bsi {
     struct TracebackInfo {
@@ -27,32 +24,6 @@ namespace bsi {
     };
 }
 
-static std::vector<uint32_t> CalculateDistance(uint32_t u, efd::ArchGraph::Ref graph) {
-    uint32_t size = graph->size();
-    std::vector<uint32_t> distance(size, _undef);
-    std::queue<uint32_t> q;
-    std::vector<bool> visited(size, false);
-
-    q.push(u);
-    visited[u] = true;
-    distance[u] = 0;
-
-    while (!q.empty()) {
-        uint32_t u = q.front();
-        q.pop();
-
-        for (uint32_t v : graph->adj(u)) {
-            if (!visited[v]) {
-                visited[v] = true;
-                distance[v] = distance[u] + 1;
-                q.push(v);
-            }
-        }
-    }
-
-    return distance;
-}
-
 BoundedSIDepSolver::BoundedSIDepSolver(ArchGraph::sRef archGraph)
     : DepSolverQAllocator(archGraph) {}
 
@@ -72,13 +43,12 @@ Solution BoundedSIDepSolver::solve(DepsSet& deps) {
     std::vector<CandidatesTy> candidatesCollection;
     std::vector<bool> mapped(mVQubits, false);
 
-    Matrix distance(mPQubits, std::vector<uint32_t>(mPQubits, _undef));
-    for (uint32_t i = 0; i < mPQubits; ++i) {
-        distance[i] = CalculateDistance(i, mArchGraph.get());
-    }
+    auto& distance = getArchCache()->getDistance();
 
     bool isFirst = true;
 
+    std::unique_ptr<TraceSpan> phaseSpan(new TraceSpan("BSI: first phase"));
+
     // First Phase:
     //     in this phase, we divide the program in layers, such that each layer is satisfied
     //     by any of the mappings inside 'candidates'.
@@ -112,17 +82,22 @@ Solution BoundedSIDepSolver::solve(DepsSet& deps) {
 
         INF << "Dep (" << dep.mFrom << ", " << dep.mTo << ")" << std::endl;
         INF << "Candidate number: " << candidates.size() << std::endl;
+        Tracer::AddCounter("BSI: candidates", candidates.size());
     }
     candidatesCollection.push_back(candidates);
 
+    phaseSpan.reset(new TraceSpan("BSI: gluing"));
+
     // Second Phase:
     //     here, the idea is to use, perhaps, dynamic programming to test all possibilities
     //     for 'glueing' the sequence of candidatesCollection together.
     uint32_t nofLayers = candidatesCollection.size();
     uint32_t layerMaxSize = 0;
 
-    for (uint32_t i = 0; i < nofLayers; ++i)
+    for (uint32_t i = 0; i < nofLayers; ++i) {
         layerMaxSize = std::max(layerMaxSize, (uint32_t) candidatesCollection[i].size());
+        LayerCandidates.add(candidatesCollection[i].size());
+    }
     
     INF << "Dynamic Programming PHASE" << std::endl;
     INF << "Layers: " << nofLayers << std::endl;
@@ -138,6 +113,7 @@ Solution BoundedSIDepSolver::solve(DepsSet& deps) {
         for (uint32_t i = 1; i < nofLayers; ++i) {
             INF << "Beginning: " << i << " of " << nofLayers << " layers." << std::endl;
             uint32_t jLayerSize = candidatesCollection[i].size();
+            Tracer::AddCounter("BSI: layer candidates", jLayerSize);
             for (uint32_t j = 0; j < jLayerSize; ++j) {
                 Timer jt;
                 jt.start();
@@ -174,6 +150,8 @@ Solution BoundedSIDepSolver::solve(DepsSet& deps) {
                 best = mem[lastLayer][i];
         }
 
+        phaseSpan.reset(new TraceSpan("BSI: traceback"));
+
         std::vector<bsi::TracebackInfo> infoVector;
 
         {
@@ -266,7 +244,7 @@ Solution BoundedSIDepSolver::solve(DepsSet& deps) {
                     opVector.push_back({ Operation::K_OP_SWAP, a, b });
                 }
 
-                sol.mCost += (SwapCost.getVal() * swaps.size());
+                sol.mCost += (mOptions.swapCost * swaps.size());
 
                 for (uint32_t i = 0; i < mVQubits; ++i) {
                     if (realToDummy[i] == _undef && newInfo.m[i] != _undef) {
@@ -288,7 +266,7 @@ Solution BoundedSIDepSolver::solve(DepsSet& deps) {
                 op.mK = Operation::K_OP_CNOT;
             } else if (mArchGraph->hasEdge(v, u)) {
                 op.mK = Operation::K_OP_REV;
-                sol.mCost += RevCost.getVal();
+                sol.mCost += mOptions.revCost;
             } else {
                 ERR << "Mapping " << MappingToString(info.m) << " not able to satisfy dependency "
                     << "(" << a << "{" << u << "}, " << b << "{" << v << "})" << std::endl;
@@ -322,7 +300,7 @@ Solution BoundedSIDepSolver::solve(DepsSet& deps) {
 
 uint32_t BoundedSIDepSolver::estimateCost(Mapping& previous,
                                           Mapping& current,
-                                          Matrix& distance) {
+                                          const Matrix& distance) {
     auto prevAssign = GenAssignment(mPQubits, previous, false);
     auto curAssign = GenAssignment(mPQubits, current, false);
 
@@ -386,7 +364,7 @@ BoundedSIDepSolver::extendCandidates(Dep& dep, std::vector<bool>& mapped,
                                      CandidatesTy& candidates, bool isFirst) {
     CandidatesTy newCandidates;
     uint32_t a = dep.mFrom, b = dep.mTo;
-    uint32_t remainingSolutions = MaxPartialSolutions.getVal();
+    uint32_t remainingSolutions = mOptions.maxPartialSolutions;
 
     bool bothUnmapped = !mapped[a] && !mapped[b];
     bool hasUnmapped = !mapped[a] || !mapped[b];
@@ -400,8 +378,8 @@ BoundedSIDepSolver::extendCandidates(Dep& dep, std::vector<bool>& mapped,
         auto candPair = candidates[i];
         auto assign = GenAssignment(mPQubits, candPair.m, false);
 
-        uint32_t remainingChildren = MaxChildren.getVal();
-        if (isFirst) remainingChildren = MaxPartialSolutions.getVal();
+        uint32_t remainingChildren = mOptions.maxChildren;
+        if (isFirst) remainingChildren = mOptions.maxPartialSolutions;
 
         uint32_t maxMappingsAB = std::min(remainingChildren, remainingSolutions);
         std::vector<std::pair<uint32_t, uint32_t>> mappingsForAB;
@@ -444,7 +422,7 @@ BoundedSIDepSolver::extendCandidates(Dep& dep, std::vector<bool>& mapped,
             nCand.m[b] = mappingCand.second;
 
             if (!mArchGraph->hasEdge(mappingCand.first, mappingCand.second)) {
-                nCand.cost += RevCost.getVal();
+                nCand.cost += mOptions.revCost;
             }
             
             newCandidates.push_back(nCand);
@@ -7,7 +7,7 @@ DepSolverQAllocator::DepSolverQAllocator(ArchGraph::sRef archGraph) : QbitAlloca
 
 Solution DepSolverQAllocator::executeAllocation(QModule::Ref qmod) {
     auto depPass = PassCache::Get<DependencyBuilderWrapperPass>(mMod);
-    auto depBuilder = depPass->getData();
+    auto& depBuilder = depPass->getData();
     auto& deps = depBuilder.getDependencies();
 
     return solve(deps);
@@ -52,13 +52,13 @@ uint32_t efd::DynprogDepSolver::getIntermediateV(uint32_t u, uint32_t v) {
 }
 
 efd::Solution efd::DynprogDepSolver::solve(DepsSet& deps) {
-    ExpTSFinder tsp(mArchGraph);
-    auto permutations = tsp.mAssigns;
+    auto& tsp = getArchCache()->getExpTSFinder();
+    auto& permutations = tsp.mAssigns;
 
     uint32_t archQ = mArchGraph->size();
-    const uint32_t SWAP_COST = SwapCost.getVal();
-    const uint32_t REV_COST = RevCost.getVal();
-    const uint32_t LCX_COST = LCXCost.getVal();
+    const uint32_t SWAP_COST = mOptions.swapCost;
+    const uint32_t REV_COST = mOptions.revCost;
+    const uint32_t LCX_COST = mOptions.lcxCost;
 
     uint32_t permN = permutations.size();
     uint32_t depN = deps.size();
@@ -82,7 +82,7 @@ efd::Solution efd::DynprogDepSolver::solve(DepsSet& deps) {
     for (uint32_t i = 1; i <= depN; ++i) {
         assert(deps[i-1].getSize() == 1 &&
                 "Trying to allocate qbits to a gate with more than one dependency.");
-        efd::Dep dep = deps[i-1].mDeps[0];
+        efd::Dep dep = deps[i-1][0];
 
         for (uint32_t tgt = 0; tgt < permN; ++tgt) {
             // Check if target tgtPermutation has the dependency required.
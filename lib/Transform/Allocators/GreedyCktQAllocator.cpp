@@ -1,8 +1,8 @@
 #include "enfield/Transform/Allocators/GreedyCktQAllocator.h"
 #include "enfield/Transform/Allocators/WeightedSIMappingFinder.h"
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
+#include "enfield/Transform/CommutationDAGBuilderPass.h"
 #include "enfield/Transform/PassCache.h"
-#include "enfield/Support/BFSPathFinder.h"
 #include "enfield/Support/Defs.h"
 
 #include <algorithm>
@@ -12,7 +12,7 @@ using namespace efd;
 enum PropKind { K_SWP, K_FRZ } type;
 
 struct AllocProps {
-    CircuitGraph::CircuitNode::sRef cnode;
+    uint32_t gate;
     uint32_t cost;
     std::vector<uint32_t> path;
 
@@ -33,17 +33,19 @@ GreedyCktQAllocator::GreedyCktQAllocator(ArchGraph::sRef ag) : QbitAllocator(ag)
 
 Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
     auto depPass = PassCache::Get<DependencyBuilderWrapperPass>(mMod);
-    auto depBuilder = depPass->getData();
+    auto& depBuilder = depPass->getData();
     auto& depsSet = depBuilder.getDependencies();
 
     auto cgbpass = PassCache::Get<CircuitGraphBuilderPass>(qmod);
-    auto cgraph = cgbpass->getData();
-    auto it = cgraph.build_iterator();
+    auto& cgraph = cgbpass->getData();
 
-    auto xbitNumber = cgraph.size();
-    auto qubitNumber = cgraph.getQSize();
+    const CommutationDAG* dag = nullptr;
+
+    if (mCommute) {
+        dag = &PassCache::Get<CommutationDAGBuilderPass>(qmod)->getData();
+    }
 
-    BFSPathFinder bfs;
+    auto qubitNumber = cgraph.getQSize();
 
     auto mapfinder = WeightedSIMappingFinder::Create();
     auto mapping = mapfinder->find(mArchGraph.get(), depsSet);
@@ -52,99 +54,86 @@ Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
     Solution sol { mapping, Solution::OpSequences(depsSet.size()), 0 };
 
     std::vector<Node::uRef> allocatedStatements;
-    std::map<Node::Ref, uint32_t> reached;
-    std::vector<bool> marked(xbitNumber, false);
     std::vector<bool> frozen(qubitNumber, false);
 
-    uint32_t t = 0;
-
-    for (uint32_t i = 0; i < xbitNumber; ++i) {
-        it.next(i);
-    }
+    // Ready gates, split by the number of xbits they use.
+    KahnScheduler scheduler(cgraph, dag);
+    std::vector<uint32_t> uGates, cGates, newReady;
 
-    while (allocatedStatements.size() < qmod->getNumberOfStmts()) {
-        bool changed, redo = false;
-
-        do {
-            changed = false;
-
-            for (uint32_t i = 0; i < xbitNumber; ++i) {
-                auto cnode = it[i];
+    auto addReady = [&](const std::vector<uint32_t>& ready) {
+        for (uint32_t g : ready) {
+            if (cgraph.getNumberOfXbits(g) <= 1) uGates.push_back(g);
+            else cGates.push_back(g);
+        }
+    };
 
-                if (cnode->isGateNode() && cnode->numberOfXbits() <= 1) {
-                    allocatedStatements.push_back(cnode->node()->clone());
-                    it.next(i);
-                    changed = true;
-                }
-            }
+    auto emit = [&](uint32_t g) {
+        allocatedStatements.push_back(cgraph.getNode(g)->clone());
+        newReady.clear();
+        scheduler.emit(g, newReady);
+        addReady(newReady);
+    };
 
-            redo = redo || changed;
-        } while (changed);
+    uint32_t t = 0;
 
-        if (redo) continue;
-        redo = false;
+    addReady(scheduler.getInitialReady());
 
-        // Reach gates with non-marked xbitNumber and mark them.
-        for (uint32_t i = 0; i < xbitNumber; ++i) {
-            auto cnode = it[i];
-            auto node = cnode->node();
+    while (!scheduler.isDone()) {
+        // Gates that use only one xbit are emitted right away, one round at
+        // a time, by the order of their xbits.
+        if (!uGates.empty()) {
+            std::vector<uint32_t> gates;
+            gates.swap(uGates);
 
-            if (cnode->isGateNode() && !marked[i]) {
-                marked[i] = true;
+            std::sort(gates.begin(), gates.end(), [&](uint32_t a, uint32_t b) {
+                uint32_t xa = cgraph.getXbit(a, 0), xb = cgraph.getXbit(b, 0);
+                return xa < xb || (xa == xb && a < b);
+            });
 
-                if (reached.find(node) == reached.end())
-                    reached[node] = cnode->numberOfXbits();
-                --reached[node];
-            }
+            for (uint32_t g : gates) emit(g);
+            continue;
         }
 
-        std::set<CircuitGraph::CircuitNode::sRef> allocatable;
+        assert(!cGates.empty() && "Every step has to be one allocatable node.");
 
-        // Advance the xbitNumber' cgraph and unmark them.
-        for (uint32_t i = 0; i < xbitNumber; ++i) {
-            auto cnode = it[i];
-            auto node = cnode->node();
+        std::vector<uint32_t> allocatable;
+        allocatable.swap(cGates);
+        std::sort(allocatable.begin(), allocatable.end());
 
-            if (cnode->isGateNode() && !reached[node]) {
-                allocatable.insert(cnode);
-            }
-        }
-
-        assert(allocatable.size() >= 1 && "Every step has to be one allocatable node.");
+        bool redo = false;
 
         // Removing instructions that don't use only one qubit, but do not have any dependencies
-        for (auto cnode : allocatable) {
-            auto node = cnode->node();
+        for (uint32_t g : allocatable) {
+            auto node = cgraph.getNode(g);
             auto dep = depBuilder.getDeps(node);
 
             if (dep.getSize() == 0) {
                 redo = true;
-                allocatedStatements.push_back(node->clone());
 
-                // for (uint32_t q : cnode->qargsid) {
-                for (uint32_t i : cnode->getXbitsIds()) {
-                    if (i < qubitNumber) frozen[i] = true;
-                    marked[i] = false;
-                    it.next(i);
+                for (uint32_t i = 0, e = cgraph.getNumberOfXbits(g); i < e; ++i) {
+                    uint32_t x = cgraph.getXbit(g, i);
+                    if (x < qubitNumber) frozen[x] = true;
                 }
 
-                // for (uint32_t c : cnode->cargsid) {
-                //     marked[c] = false;
-                //     cgraph[c] = cgraph[c]->child[c];
-                // }
+                emit(g);
+            } else {
+                cGates.push_back(g);
             }
         }
 
         if (redo) continue;
 
+        allocatable.swap(cGates);
+        cGates.clear();
+
         AllocProps best;
-        best.cnode = nullptr;
+        best.gate = CircuitGraph::NoGate;
         best.cost = _undef;
 
-        for (auto cnode : allocatable) {
-            // Calculate cost for allocating cnode->node;
+        for (uint32_t g : allocatable) {
+            // Calculate cost for allocating the node of 'g';
 
-            auto node = cnode->node();
+            auto node = cgraph.getNode(g);
             auto dep = depBuilder.getDeps(node);
 
             assert(dep.getSize() <= 1 && "Can only allocate gates with at most one depenency.");
@@ -153,7 +142,7 @@ Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
             uint32_t u = mapping[a], v = mapping[b];
 
             AllocProps props;
-            props.cnode = cnode;
+            props.gate = g;
             props.cost = 0;
             props.path = {};
 
@@ -166,7 +155,7 @@ Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
                 props.type = K_SWP;
             } else if (!hasEdge && hasReverseEdge) {
                 props.type = K_SWP;
-                props.cost = RevCost.getVal();
+                props.cost = mOptions.revCost;
             } else {
                 bool foundFrozen = false;
 
@@ -195,7 +184,7 @@ Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
                                 props.u.frz.to = otherNotFrozen;
 
                                 if (!mArchGraph->hasEdge(u, mapping[otherNotFrozen]))
-                                    props.cost = RevCost.getVal();
+                                    props.cost = mOptions.revCost;
 
                                 foundFrozen = true;
                                 break;
@@ -209,11 +198,14 @@ Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
                 if (!foundFrozen) {
                     props.type = K_SWP;
 
-                    auto bfspath = bfs.find(mArchGraph.get(), u, v);
+                    auto bfspath = getArchCache()->getPath(u, v);
                     uint32_t pathsize = bfspath.size();
 
+                    // Not connected: this gate can not be allocated.
+                    if (pathsize == 0) continue;
+
                     props.path = bfspath;
-                    props.cost = (bfspath.size() - 2) * SwapCost.getVal();
+                    props.cost = (bfspath.size() - 2) * mOptions.swapCost;
 
                     bool hasEdgeFromU = mArchGraph->hasEdge(bfspath[0], bfspath[1]);
                     bool hasEdgeToV = mArchGraph->hasEdge(bfspath[pathsize - 2], bfspath[pathsize - 1]);
@@ -222,7 +214,7 @@ Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
                     else if (!hasEdgeFromU && hasEdgeToV)
                         props.u.swp.mvTgtSrc = false;
                     else if (!hasEdgeFromU && !hasEdgeToV)
-                        props.cost += RevCost.getVal();
+                        props.cost += mOptions.revCost;
                 }
             }
 
@@ -230,16 +222,20 @@ Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
                 best = props;
         }
 
-        assert(best.cnode.get() != nullptr && "There must be a 'best' node.");
+        assert(best.gate != CircuitGraph::NoGate && "There must be a 'best' node.");
 
         // Allocate best node;
         // Setting the 'stop' flag;
         auto& ops = sol.mOpSeqs[t++];
-        auto node = best.cnode->node();
-        auto newNode = node->clone();
+        auto node = cgraph.getNode(best.gate);
+
+        // The others are still ready.
+        for (uint32_t g : allocatable) {
+            if (g != best.gate) cGates.push_back(g);
+        }
 
-        ops.first = newNode.get();
-        allocatedStatements.push_back(std::move(newNode));
+        emit(best.gate);
+        ops.first = allocatedStatements.back().get();
 
         if (best.type == K_SWP) {
             if (best.u.swp.mvTgtSrc)
@@ -280,17 +276,6 @@ Solution GreedyCktQAllocator::executeAllocation(QModule::Ref qmod) {
             ops.second.push_back({ Operation::K_OP_REV, a, b });
         }
 
-        // for (uint32_t q : best.cnode->qargsid) {
-        for (uint32_t i : best.cnode->getXbitsIds()) {
-            marked[i] = false;
-            it.next(i);
-        }
-
-        // for (uint32_t c : best.cnode->cargsid) {
-        //     marked[c] = true;
-        //     cgraph[c] = cgraph[c]->child[c];
-        // }
-
         sol.mCost += best.cost;
     }
 
@@ -1,14 +1,15 @@
 #include "enfield/Transform/Allocators/IBMQAllocator.h"
 #include "enfield/Transform/PassCache.h"
-#include "enfield/Support/BFSPathFinder.h"
+#include "enfield/Support/Stats.h"
+#include "enfield/Support/Tracer.h"
 
 #include <random>
 
 using namespace efd;
 
-extern Opt<uint32_t> Seed;
-static Opt<uint32_t> Trials
-("trials", "Number of times that IBMQAllocator should try.", 20, false);
+static DistributionStat TrialSuccesses
+("IBMTrialSuccesses", "The number of successful trials of each (non-trivial) layer.");
+
 
 IBMQAllocator::IBMQAllocator(ArchGraph::sRef archGraph) : QbitAllocator(archGraph) {}
 
@@ -20,8 +21,9 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
 (Layer& layer, Mapping current, std::set<uint32_t> qubitsSet, DependencyBuilder& depData) {
     AllocationResult result { current, true, {}, false };
     Assign assign = GenAssignment(mPQubits, current);
+    auto& distance = getArchCache()->getDistance();
 
-    std::default_random_engine generator(Seed.getVal());
+    std::default_random_engine generator(mOptions.seed);
     std::normal_distribution<double> distribution(0.0, (double) (1 / (double) mPQubits));
 
     std::vector<Dep> deps;
@@ -40,7 +42,7 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
     uint32_t dist = 0;
     for (auto dep : deps) {
         uint32_t u = current[dep.mFrom], v = current[dep.mTo];
-        dist += mDist[u][v];
+        dist += distance[u][v];
     }
 
     if (dist == deps.size()) {
@@ -49,12 +51,15 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
         return result;
     }
 
+    TraceSpan span("IBM: layer trials");
+
     uint32_t bestD = _undef;
     Mapping bestMap;
     Solution::OpVector bestOpv;
     bool found = false;
+    uint32_t successes = 0;
 
-    uint32_t trials = Trials.getVal();
+    uint32_t trials = mOptions.trials;
     for (uint32_t i = 0; i < trials; ++i) {
 
         auto trialMap = current;
@@ -65,7 +70,7 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
         for (uint32_t i = 0; i < mPQubits; ++i)
             for (uint32_t j = 0; j < mPQubits; ++j) {
                 double scale = 1 + distribution(generator);
-                rDist[i][j] = scale * mDist[i][j] * mDist[i][j];
+                rDist[i][j] = scale * distance[i][j] * distance[i][j];
                 rDist[j][i] = rDist[i][j];
             }
 
@@ -130,7 +135,7 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
             uint32_t dist = 0;
             for (auto dep : deps) {
                 uint32_t u = trialMap[dep.mFrom], v = trialMap[dep.mTo];
-                dist += mDist[u][v];
+                dist += distance[u][v];
             }
 
             if (dist == deps.size()) {
@@ -143,9 +148,11 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
         uint32_t dist = 0;
         for (auto dep : deps) {
             uint32_t u = trialMap[dep.mFrom], v = trialMap[dep.mTo];
-            dist += mDist[u][v];
+            dist += distance[u][v];
         }
 
+        if (dist == deps.size()) ++successes;
+
         if (dist == deps.size() && d < bestD) {
             found = true;
             bestMap = trialMap;
@@ -154,6 +161,9 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
         }
     }
 
+    Tracer::AddCounter("IBM: successful trials", successes);
+    TrialSuccesses.add(successes);
+
     if (found) {
         result.success = true;
         result.opv = bestOpv;
@@ -166,28 +176,19 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
 }
 
 Solution IBMQAllocator::executeAllocation(QModule::Ref qmod) {
-    std::srand(Seed.getVal());
-
     Solution sol;
     sol.mCost = 0;
 
     auto dbwPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod);
-    auto depData = dbwPass->getData();
+    auto& depData = dbwPass->getData();
 
-    auto lbPass = PassCache::Get<LayersBuilderPass>(qmod);
-    auto layers = lbPass->getData();
-
-    BFSPathFinder bfs;
+    // Not cached: the layers depend on whether gates may commute.
+    auto lbPass = LayersBuilderPass::Create(mCommute);
+    PassCache::Run(qmod, lbPass.get());
+    auto& layers = lbPass->getData();
 
     mPQubits = mArchGraph->size();
-    mLQubits = depData.mXbitToNumber.getQSize();
-    mDist.assign(mPQubits, std::vector<uint32_t>(mPQubits, _undef));
-
-    for (uint32_t i = 0; i < mPQubits; ++i) {
-        for (uint32_t j = 0; j < mPQubits; ++j) {
-            mDist[i][j] = bfs.find(mArchGraph.get(), i, j).size() - 1;
-        }
-    }
+    mLQubits = depData.getXbitToNumber().getQSize();
 
     Mapping current(mPQubits, 0);
     std::vector<bool> allocated(mPQubits, false);
@@ -239,7 +240,7 @@ Solution IBMQAllocator::executeAllocation(QModule::Ref qmod) {
                         op = { Operation::K_OP_CNOT, dep.mFrom, dep.mTo };
                     } else if (mArchGraph->hasEdge(v, u)) {
                         op = { Operation::K_OP_REV, dep.mFrom, dep.mTo };
-                        sol.mCost += RevCost.getVal();
+                        sol.mCost += mOptions.revCost;
                     } else {
                         ERR << "If we found one configuration, it should not reach this point."
                             << std::endl;
@@ -253,7 +254,7 @@ Solution IBMQAllocator::executeAllocation(QModule::Ref qmod) {
             }
 
             if (sol.mOpSeqs.size() != opsSeqIdx) {
-                sol.mCost += (SwapCost.getVal() * result.opv.size());
+                sol.mCost += (mOptions.swapCost * result.opv.size());
                 sol.mOpSeqs[opsSeqIdx].second.insert(sol.mOpSeqs[opsSeqIdx].second.begin(),
                                                      result.opv.begin(), result.opv.end());
             } else if (!result.opv.empty()) {
@@ -301,7 +302,7 @@ Solution IBMQAllocator::executeAllocation(QModule::Ref qmod) {
                         op = { Operation::K_OP_CNOT, dep.mFrom, dep.mTo };
                     } else if (mArchGraph->hasEdge(v, u)) {
                         op = { Operation::K_OP_REV, dep.mFrom, dep.mTo };
-                        sol.mCost += RevCost.getVal();
+                        sol.mCost += mOptions.revCost;
                     } else {
                         ERR << "If we found one configuration, it should not reach this point."
                             << std::endl;
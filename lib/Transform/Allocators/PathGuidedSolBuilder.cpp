@@ -11,6 +11,8 @@ static efd::Stat<double> MeanSwapsSize
 ("MeanSwapsSize", "The mean of swap sequence size.");
 static efd::Stat<uint32_t> SerialSwapsCount
 ("SerialSwapsCount", "The mean of swap sequence size.");
+static efd::DistributionStat SwapChainLength
+("SwapChainLength", "The number of swaps inserted for each dependency.");
 
 struct DepComp {
     bool operator()(const efd::Dep& lhs, const efd::Dep& rhs) const {
@@ -55,6 +57,8 @@ efd::Solution efd::PathGuidedSolBuilder::build(Mapping initial,
         uint32_t u = match[a], v = match[b];
 
         auto assign = GenAssignment(g->size(), match);
+        uint32_t swaps = 0;
+
         auto path = mPathFinder->find(g, u, v);
 
         if (path.size() > 2) {
@@ -94,11 +98,12 @@ efd::Solution efd::PathGuidedSolBuilder::build(Mapping initial,
                     // ------ Stats
                     SerialSwapsCount += 1;
                     MeanSwapsSize += ops.second.size();
-                    TotalSwapCost += SwapCost.getVal() * ops.second.size();
+                    TotalSwapCost += mOptions.swapCost * ops.second.size();
                     // --------------------
                 }
 
-                solution.mCost += (SwapCost.getVal() * ops.second.size());
+                swaps = ops.second.size();
+                solution.mCost += (mOptions.swapCost * ops.second.size());
             }
 
             u = match[a], v = match[b];
@@ -107,10 +112,13 @@ efd::Solution efd::PathGuidedSolBuilder::build(Mapping initial,
         if (g->hasEdge(u, v)) {
             ops.second.push_back({ Operation::K_OP_CNOT, a, b });
         } else {
-            solution.mCost += RevCost.getVal();
+            solution.mCost += mOptions.revCost;
             ops.second.push_back({ Operation::K_OP_REV, a, b });
         }
 
+        // Dependencies that needed no swaps are sampled as well (as 0).
+        if (keepStats) SwapChainLength.add(swaps);
+
         frozen[u] = true;
         frozen[v] = true;
 
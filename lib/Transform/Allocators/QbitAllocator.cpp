@@ -8,9 +8,12 @@
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/Tracer.h"
 
 #include <iterator>
 #include <cassert>
+#include <chrono>
+#include <limits>
 
 // ------------------ Solution Implementer ----------------------
 namespace efd {
@@ -18,7 +21,7 @@ namespace efd {
         private:
             Solution& mData;
 
-            XbitToNumber mXbitToNumber;
+            XbitToNumberWrapperPass::DataSnapshot mXbitToNumber;
             std::vector<Node::Ref> mMap;
 
             std::unordered_map<Node::Ref, std::vector<Node::uRef>> mReplVector;
@@ -36,6 +39,7 @@ namespace efd {
             SolutionImplPass(Solution& sol) : mData(sol) {}
 
             bool run(QModule::Ref qmod) override;
+            PreservedAnalyses getPreserved() const override;
             void visit(NDQOpMeasure::Ref ref) override;
             void visit(NDQOpReset::Ref ref) override;
             void visit(NDQOpU::Ref ref) override;
@@ -48,7 +52,7 @@ namespace efd {
 }
 
 efd::Node::uRef efd::SolutionImplPass::getMappedNode(Node::Ref ref) {
-    uint32_t id = mXbitToNumber.getQUId(ref->toString());
+    uint32_t id = mXbitToNumber->getQUId(ref->toString());
     return mMap[id]->clone();
 }
 
@@ -138,13 +142,11 @@ void efd::SolutionImplPass::applyOperations(NDQOp::Ref qop, NDIfStmt::Ref ifstmt
 
 bool efd::SolutionImplPass::run(QModule::Ref qmod) {
     INF << "Initial Configuration: " << MappingToString(mData.mInitial) << std::endl;
-    auto xtonpass = PassCache::Get<XbitToNumberWrapperPass>(qmod);
+    mXbitToNumber = PassCache::GetData<XbitToNumberWrapperPass>(qmod);
+    mMap.assign(mXbitToNumber->getQSize(), nullptr);
 
-    mXbitToNumber = xtonpass->getData();
-    mMap.assign(mXbitToNumber.getQSize(), nullptr);
-
-    for (uint32_t i = 0, e = mXbitToNumber.getQSize(); i < e; ++i) {
-        mMap[i] = mXbitToNumber.getQNode(mData.mInitial[i]);
+    for (uint32_t i = 0, e = mXbitToNumber->getQSize(); i < e; ++i) {
+        mMap[i] = mXbitToNumber->getQNode(mData.mInitial[i]);
     }
 
     mDepIdx = 0;
@@ -160,6 +162,10 @@ bool efd::SolutionImplPass::run(QModule::Ref qmod) {
     return true;
 }
 
+efd::PreservedAnalyses efd::SolutionImplPass::getPreserved() const {
+    return PreservedAnalyses::StatementsOnly();
+}
+
 void efd::SolutionImplPass::visit(NDQOpMeasure::Ref ref) {
     applyOperations(ref);
 }
@@ -209,15 +215,18 @@ static efd::Stat<double> RenameTime
 
 efd::Stat<uint32_t> TotalCost
 ("TotalCost", "Total cost after allocating the qubits.");
-efd::Opt<uint32_t> SwapCost
-("-swap-cost", "Cost of using a swap function.", 7, false);
-efd::Opt<uint32_t> RevCost
-("-rev-cost", "Cost of using a reverse edge.", 4, false);
-efd::Opt<uint32_t> LCXCost
-("-lcx-cost", "Cost of using long cnot gate.", 10, false);
+
+efd::AllocatorOptions::AllocatorOptions() :
+    swapCost(7),
+    revCost(4),
+    lcxCost(10),
+    seed(std::chrono::system_clock::now().time_since_epoch().count()),
+    trials(20),
+    maxChildren(std::numeric_limits<uint32_t>::max()),
+    maxPartialSolutions(std::numeric_limits<uint32_t>::max()) {}
 
 efd::QbitAllocator::QbitAllocator(ArchGraph::sRef archGraph) 
-    : mInlineAll(false), mArchGraph(archGraph) {
+    : mInlineAll(false), mArchGraph(archGraph), mCommute(false) {
 }
 
 void efd::QbitAllocator::inlineAllGates() {
@@ -230,7 +239,7 @@ void efd::QbitAllocator::replaceWithArchSpecs() {
     RenameQbitPass::ArchMap toArchMap;
 
     auto xtn = PassCache::Get<XbitToNumberWrapperPass>(mMod);
-    auto xbitToNumber = xtn->getData();
+    auto& xbitToNumber = xtn->getData();
 
     for (uint32_t i = 0, e = xbitToNumber.getQSize(); i < e; ++i) {
         toArchMap[xbitToNumber.getQStrId(i)] = mArchGraph->getNode(i);
@@ -245,6 +254,9 @@ void efd::QbitAllocator::replaceWithArchSpecs() {
     for (auto it = mArchGraph->reg_begin(), e = mArchGraph->reg_end(); it != e; ++it)
         mMod->insertReg(NDRegDecl::CreateQ
                 (NDId::Create(it->first), NDInt::Create(std::to_string(it->second))));
+
+    // The registers were modified outside a pass.
+    PassCache::Invalidate(mMod);
 }
 
 bool efd::QbitAllocator::run(QModule::Ref qmod) {
@@ -272,7 +284,10 @@ bool efd::QbitAllocator::run(QModule::Ref qmod) {
     timer.start();
     // ---------------------------------
 
-    replaceWithArchSpecs();
+    {
+        TraceSpan span("QbitAllocator: replace with arch specs");
+        replaceWithArchSpecs();
+    }
 
     // Stopping timer and setting the stat -----------------
     timer.stop();
@@ -282,24 +297,27 @@ bool efd::QbitAllocator::run(QModule::Ref qmod) {
     // Getting the new information, since it can be the case that the qmodule
     // was modified.
     auto depPass = PassCache::Get<DependencyBuilderWrapperPass>(mMod);
-    auto depBuilder = depPass->getData();
+    auto& depBuilder = depPass->getData();
     auto& deps = depBuilder.getDependencies();
 
     // Counting total dependencies.
     uint32_t totalDeps = 0;
     for (auto& d : deps)
-        totalDeps += d.mDeps.size();
+        totalDeps += d.getSize();
     DepStat = totalDeps;
 
     // Filling Qubit information.
-    mVQubits = depBuilder.mXbitToNumber.getQSize();
+    mVQubits = depBuilder.getXbitToNumber().getQSize();
     mPQubits = mArchGraph->size();
 
     // Setting up timer ----------------
     timer.start();
     // ---------------------------------
 
-    mData = executeAllocation(mMod);
+    {
+        TraceSpan span("QbitAllocator: allocation");
+        mData = executeAllocation(mMod);
+    }
 
     // Stopping timer and setting the stat -----------------
     timer.stop();
@@ -332,6 +350,32 @@ void efd::QbitAllocator::setDontInline() {
     mInlineAll = false;
 }
 
+efd::ArchCache::Ref efd::QbitAllocator::getArchCache() {
+    if (mArchCache.get() == nullptr) {
+        mArchCache = ArchCache::Create(mArchGraph);
+    }
+
+    return mArchCache.get();
+}
+
+void efd::QbitAllocator::setOptions(AllocatorOptions options) {
+    mOptions = options;
+}
+
+const efd::AllocatorOptions& efd::QbitAllocator::getOptions() const {
+    return mOptions;
+}
+
+void efd::QbitAllocator::setCommute(bool commute) {
+    mCommute = commute;
+}
+
+void efd::QbitAllocator::setArchCache(ArchCache::sRef cache) {
+    assert(cache->getArchGraph() == mArchGraph &&
+           "Cache built for another architecture.");
+    mArchCache = cache;
+}
+
 efd::Assign efd::GenAssignment(uint32_t archQ, Mapping mapping, bool fill) {
     uint32_t progQ = mapping.size();
     // 'archQ' is the number of qubits from the architecture.
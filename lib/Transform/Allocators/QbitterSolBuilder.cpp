@@ -23,10 +23,10 @@ efd::Solution efd::QbitterSolBuilder::build
         if (g->hasEdge(u, v)) {
             operation = { Operation::K_OP_CNOT, a, b };
         } else if (g->isReverseEdge(u, v)) {
-            solution.mCost += RevCost.getVal();
+            solution.mCost += mOptions.revCost;
             operation = { Operation::K_OP_REV, a, b };
         } else {
-            solution.mCost += LCXCost.getVal();
+            solution.mCost += mOptions.lcxCost;
             operation = { Operation::K_OP_LCNOT, a, b };
 
             auto path = finder->find(g, u, v);
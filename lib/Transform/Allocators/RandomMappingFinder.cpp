@@ -4,17 +4,11 @@
 #include <algorithm>
 #include <chrono>
 #include <random>
+#include <memory>
 
-efd::Opt<uint32_t> Seed ("seed", "Seed to be used in the RandomQbitAllocator.",
-std::chrono::system_clock::now().time_since_epoch().count(), false);
 efd::Stat<uint32_t> SeedStat
 ("seed", "Seed used in the random allocator.");
 
-int rnd(int i) {
-    static std::default_random_engine generator(Seed.getVal());
-    static std::uniform_int_distribution<int> distribution(0, i - 1);
-    return distribution(generator);
-}
 
 efd::MappingFinder::Mapping
 efd::RandomMappingFinder::find(ArchGraph::Ref g, DepsSet& deps) {
@@ -26,7 +20,20 @@ efd::RandomMappingFinder::find(ArchGraph::Ref g, DepsSet& deps) {
     }
 
     // "Generating" the initial mapping.
-    SeedStat = Seed.getVal();
+    // The generator is local, so that each call (and each thread) draws the
+    // same sequence for the same seed.
+    std::default_random_engine generator(mOptions.seed);
+    std::unique_ptr<std::uniform_int_distribution<int>> distribution;
+
+    auto rnd = [&](int i) {
+        if (distribution.get() == nullptr) {
+            distribution.reset(new std::uniform_int_distribution<int>(0, i - 1));
+        }
+
+        return (*distribution)(generator);
+    };
+
+    SeedStat = mOptions.seed;
     std::random_shuffle(mapping.begin(), mapping.end(), rnd);
 
     return mapping;
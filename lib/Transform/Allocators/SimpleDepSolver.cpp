@@ -5,6 +5,9 @@ efd::SimpleDepSolver::SimpleDepSolver(ArchGraph::sRef agraph) :
 }
 
 efd::Solution efd::SimpleDepSolver::solve(DepsSet& deps) {
+    mMapFinder->setOptions(mOptions);
+    mSolBuilder->setOptions(mOptions);
+
     auto initial = mMapFinder->find(mArchGraph.get(), deps);
     return mSolBuilder->build(initial, deps, mArchGraph.get());
 }
@@ -13,7 +13,7 @@ efd::WeightedSIMappingFinder::find(ArchGraph::Ref g, DepsSet& deps) {
 
     std::map<std::pair<uint32_t, uint32_t>, WeightTy> wMap;
     for (auto& dep : deps) {
-        Dep d = dep.mDeps[0];
+        Dep d = dep[0];
 
         auto pair = std::make_pair(d.mFrom, d.mTo);
         if (wMap.find(pair) == wMap.end()) wMap[pair] = 0;
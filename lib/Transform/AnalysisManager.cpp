@@ -0,0 +1,47 @@
+#include "enfield/Transform/AnalysisManager.h"
+
+efd::AnalysisManager::AnalysisManager(QModule* qmod) : mMod(qmod) {
+}
+
+void efd::AnalysisManager::invalidateImpl(const PreservedAnalyses& preserved) {
+    for (auto it = mPasses.begin(); it != mPasses.end();) {
+        if (preserved.isPreserved(it->first)) ++it;
+        else it = mPasses.erase(it);
+    }
+
+    // Removing the passes that depend on removed ones, until nothing
+    // else changes.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (auto it = mPasses.begin(); it != mPasses.end();) {
+            bool valid = true;
+
+            for (auto dep : it->second->getDependencies()) {
+                valid = valid && mPasses.find(dep) != mPasses.end();
+            }
+
+            if (valid) {
+                ++it;
+            } else {
+                it = mPasses.erase(it);
+                changed = true;
+            }
+        }
+    }
+}
+
+void efd::AnalysisManager::clear() {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    mPasses.clear();
+}
+
+void efd::AnalysisManager::invalidate(const PreservedAnalyses& preserved) {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    invalidateImpl(preserved);
+}
+
+efd::AnalysisManager::uRef efd::AnalysisManager::Create(QModule* qmod) {
+    return uRef(new AnalysisManager(qmod));
+}
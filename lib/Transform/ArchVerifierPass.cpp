@@ -1,23 +1,40 @@
 #include "enfield/Transform/ArchVerifierPass.h"
 #include "enfield/Transform/Utils.h"
 #include "enfield/Analysis/NodeVisitor.h"
+#include "enfield/Support/RTTI.h"
+#include "enfield/Support/Tracer.h"
 
+#include <atomic>
+#include <thread>
 #include <cassert>
+#include <algorithm>
+#include <unordered_map>
 
 using namespace efd;
 
+/// \brief Minimum number of statements verified by each thread.
+static const uint32_t MinStmtsPerThread = 4096;
+
+namespace {
+    /// \brief The registers of the architecture (by name), with the uid of each
+    /// of their qubits.
+    typedef std::unordered_map<std::string, std::vector<uint32_t>> ArchRegisters;
+}
+
 namespace efd {
     class ArchVerifierVisitor : public NodeVisitor {
         private:
             struct SemanticCNOT { uint32_t u, v; };
 
-            ArchGraph::sRef mArch;
+            const ArchGraph* mArch;
+            const ArchRegisters& mRegs;
 
+            uint32_t getUId(Node::Ref qarg);
             bool checkCNOT(SemanticCNOT cnot);
             bool visitNDQOp(NDQOp::Ref qop);
 
         public:
-            ArchVerifierVisitor(ArchGraph::sRef ag);
+            ArchVerifierVisitor(const ArchGraph* ag, const ArchRegisters& regs);
 
             void visit(NDQOpMeasure::Ref ref) override;
             void visit(NDQOpReset::Ref ref) override;
@@ -31,7 +48,21 @@ namespace efd {
     };
 }
 
-ArchVerifierVisitor::ArchVerifierVisitor(ArchGraph::sRef ag) : mArch(ag), mSuccess(true) {}
+ArchVerifierVisitor::ArchVerifierVisitor(const ArchGraph* ag, const ArchRegisters& regs)
+    : mArch(ag), mRegs(regs), mSuccess(true) {}
+
+uint32_t ArchVerifierVisitor::getUId(Node::Ref qarg) {
+    auto idref = dynCast<NDIdRef>(qarg);
+    if (idref == nullptr) return _undef;
+
+    auto name = idref->getId()->getVal();
+    uint32_t n = idref->getN()->getVal().mV;
+
+    auto it = mRegs.find(name);
+    if (it == mRegs.end()) return _undef;
+
+    return (n < it->second.size()) ? it->second[n] : _undef;
+}
 
 bool ArchVerifierVisitor::checkCNOT(SemanticCNOT cnot) {
     return mArch->hasEdge(cnot.u, cnot.v);
@@ -42,10 +73,10 @@ bool ArchVerifierVisitor::visitNDQOp(NDQOp::Ref qop) {
 
     std::vector<uint32_t> qUIds;
     for (auto& qarg : *qop->getQArgs()) {
-        auto qargStr = qarg->toString(false);
+        uint32_t uid = getUId(qarg.get());
 
-        if (mArch->hasSId(qargStr)) {
-            qUIds.push_back(mArch->getUId(qargStr));
+        if (uid != _undef) {
+            qUIds.push_back(uid);
         } else {
             // If there is some quantum operation that uses an inexistent qubit, we already
             // may return false!
@@ -120,23 +151,65 @@ void ArchVerifierVisitor::visit(NDIfStmt::Ref ref) {
 // --------------------- ArchVerifierPass -------------------------
 // ----------------------------------------------------------------
 
-ArchVerifierPass::ArchVerifierPass(ArchGraph::sRef ag) : mArch(ag) {
+ArchVerifierPass::ArchVerifierPass(ArchGraph::sRef ag) : mArch(ag), mThreads(1) {
     mData = false;
 }
 
 bool ArchVerifierPass::run(QModule* qmod) {
-    mData = true;
-    ArchVerifierVisitor visitor(mArch);
+    // Interning the uids of the architecture qubits, by register.
+    ArchRegisters regs;
+
+    for (auto it = mArch->reg_begin(), end = mArch->reg_end(); it != end; ++it) {
+        auto& uids = regs[it->first];
+
+        for (uint32_t i = 0; i < it->second; ++i) {
+            auto sid = it->first + "[" + std::to_string(i) + "]";
+            uids.push_back(mArch->hasSId(sid) ? mArch->getUId(sid) : _undef);
+        }
+    }
+
+    auto begin = qmod->stmt_begin();
+    uint32_t stmts = qmod->stmt_end() - begin;
+    uint32_t threads = std::max(1u, std::min(mThreads, stmts / MinStmtsPerThread));
 
-    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end();
-            it != end && mData; ++it) {
-        (*it)->apply(&visitor);
-        mData = mData && visitor.mSuccess;
+    std::atomic<bool> success(true);
+
+    auto verify = [&](uint32_t from, uint32_t to) {
+        TraceSpan span("ArchVerifier: chunk");
+        ArchVerifierVisitor visitor(mArch.get(), regs);
+
+        for (auto it = begin + from, end = begin + to;
+                it != end && visitor.mSuccess && success; ++it) {
+            (*it)->apply(&visitor);
+        }
+
+        if (!visitor.mSuccess) success = false;
+    };
+
+    if (threads == 1) {
+        verify(0, stmts);
+    } else {
+        std::vector<std::thread> workers;
+
+        for (uint32_t i = 0; i < threads; ++i) {
+            workers.push_back(std::thread(verify,
+                                          (uint64_t) stmts * i / threads,
+                                          (uint64_t) stmts * (i + 1) / threads));
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
     }
 
+    mData = success;
     return false;
 }
 
+void ArchVerifierPass::setThreads(uint32_t threads) {
+    mThreads = std::max(1u, threads);
+}
+
 ArchVerifierPass::uRef ArchVerifierPass::Create(ArchGraph::sRef ag) {
     return uRef(new ArchVerifierPass(ag));
 }
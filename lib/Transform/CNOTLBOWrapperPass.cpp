@@ -2,112 +2,97 @@
 #include "enfield/Transform/QModule.h"
 #include "enfield/Support/RTTI.h"
 
-uint8_t efd::CNOTLBOWrapperPass::ID = 0;
+#include <algorithm>
 
-efd::Ordering efd::CNOTLBOWrapperPass::generate(CircuitGraph& graph) {
-    auto& layers = mData.layers;
+uint8_t efd::CNOTLBOWrapperPass::ID = 0;
 
-    auto xbitNumber = graph.size();
-    auto qubitNumber = graph.getQSize();
-    auto cbitNumber = graph.getCSize();
+efd::CNOTLBOWrapperPass::CNOTLBOWrapperPass(bool commute)
+    : LayerBasedOrderingWrapperPass(commute) {
+}
 
-    bool stop, ugate;
-    auto marked = std::vector<bool>(xbitNumber, false);
-    auto reached = std::unordered_map<Node::Ref, uint32_t>();
+efd::Ordering efd::CNOTLBOWrapperPass::generate(CircuitGraph& graph,
+                                                 const CommutationDAG* dag) {
+    auto& layers = mData.layers;
     auto order = Ordering();
-    auto it = graph.build_iterator();
 
-    std::set<Node::Ref> processed;
-    std::vector<Xbit> xbits;
+    KahnScheduler scheduler(graph, dag);
 
-    for (uint32_t i = 0; i < qubitNumber; ++i) {
-        it.next(i);
-        xbits.push_back(Xbit::Q(i));
-    }
+    // Ready gates, split by the number of xbits they use.
+    std::vector<uint32_t> uGates, cGates, newReady;
 
-    for (uint32_t i = 0; i < cbitNumber; ++i) {
-        it.next(i + qubitNumber);
-        xbits.push_back(Xbit::C(i));
-    }
+    auto addReady = [&](const std::vector<uint32_t>& ready) {
+        for (uint32_t g : ready) {
+            if (graph.getNumberOfXbits(g) == 1) uGates.push_back(g);
+            else cGates.push_back(g);
+        }
+    };
+
+    // Smallest xbit used by the gate, which defines its place inside a layer.
+    auto firstXbit = [&](uint32_t g) {
+        uint32_t first = graph.getXbit(g, 0);
+        for (uint32_t i = 1, e = graph.getNumberOfXbits(g); i < e; ++i)
+            first = std::min(first, graph.getXbit(g, i));
+        return first;
+    };
+
+    // Gates of the layer, bucketed by their smallest xbit. Reading the buckets
+    // in order yields the layer sorted by xbit, in time linear on its size
+    // plus the range of xbits it spans (instead of sorting it).
+    std::vector<std::vector<uint32_t>> buckets(graph.size());
+
+    auto emitLayer = [&](std::vector<uint32_t>& gates) {
+        uint32_t minXbit = graph.size(), maxXbit = 0;
+
+        for (uint32_t g : gates) {
+            uint32_t xbit = firstXbit(g);
+            buckets[xbit].push_back(g);
+            minXbit = std::min(minXbit, xbit);
+            maxXbit = std::max(maxXbit, xbit);
+        }
 
-    do {
-        stop = true;
+        gates.clear();
 
-        // Emit U-gates that may be executed in parallel.
-        // However, we want to schedule the controlled gates only, as they
-        // are the only gates that affects qubit allocation.
-        do {
-            Layer layer;
-            ugate = false;
-
-            for (uint32_t i = 0; i < qubitNumber; ++i) {
-                auto qubit = xbits[i];
-
-                if (it[qubit]->isGateNode() && it[qubit]->numberOfXbits() == 1) {
-                    auto node = it[qubit]->node();
-                    layer.push_back(node);
-                    processed.insert(node);
-
-                    it.next(qubit);
-                    ugate = true;
-                }
-            }
-
-            if (!layer.empty()) {
-                for (auto node : layer)
-                    order.push_back(getNodeId(node));
-                layers.push_back(layer);
-            }
-        } while (ugate);
+        for (uint32_t x = minXbit; x <= maxXbit; ++x) {
+            gates.insert(gates.end(), buckets[x].begin(), buckets[x].end());
+            buckets[x].clear();
+        }
 
         Layer layer;
-        // Reach gates with non-marked xbits and mark them.
-        for (uint32_t i = 0; i < xbitNumber; ++i) {
-            auto bit = xbits[i];
-
-            if (it[bit]->isGateNode() && !marked[i]) {
-                marked[i] = true;
+        newReady.clear();
 
-                auto node = it[bit]->node();
-
-                if (reached.find(node) == reached.end())
-                    reached[node] = it[bit]->numberOfXbits();
-                --reached[node];
-            }
+        for (uint32_t g : gates) {
+            auto node = graph.getNode(g);
+            layer.push_back(node);
+            order.push_back(getNodeId(node));
+            scheduler.emit(g, newReady);
         }
 
-        // Advance the xbits and unmark them.
-        for (uint32_t i = 0; i < xbitNumber; ++i) {
-            auto bit = xbits[i];
-            auto node = it[bit]->node();
-
-            if (it[bit]->isGateNode() && !reached[node]) {
-
-                if (processed.find(node) == processed.end()) {
-                    layer.push_back(node);
-                    processed.insert(node);
-                }
+        gates.clear();
+        addReady(newReady);
+        layers.push_back(layer);
+    };
 
-                marked[i] = false;
-                it.next(bit);
-            }
+    addReady(scheduler.getInitialReady());
 
-            // If the xbits in the processed nodes haven't reached the end (output nodes)
-            // we keep going.
-            if (!it[bit]->isOutputNode()) stop = false;
+    while (!scheduler.isDone()) {
+        // Emit U-gates that may be executed in parallel.
+        // However, we want to schedule the controlled gates only, as they
+        // are the only gates that affects qubit allocation.
+        while (!uGates.empty()) {
+            emitLayer(uGates);
         }
 
-
-        if (!layer.empty()) {
-            for (auto node : layer)
-                order.push_back(getNodeId(node));
-            layers.push_back(layer);
+        // Then, every controlled gate that is ready.
+        if (!cGates.empty()) {
+            std::vector<uint32_t> gates;
+            gates.swap(cGates);
+            emitLayer(gates);
         }
-    } while (!stop);
+    }
 
     return order;
 }
 
-efd::CNOTLBOWrapperPass::uRef efd::CNOTLBOWrapperPass::Create() {
-    return uRef(new CNOTLBOWrapperPass());
+efd::CNOTLBOWrapperPass::uRef efd::CNOTLBOWrapperPass::Create(bool commute) {
+    return uRef(new CNOTLBOWrapperPass(commute));
 }
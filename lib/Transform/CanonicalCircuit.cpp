@@ -0,0 +1,233 @@
+#include "enfield/Transform/CanonicalCircuit.h"
+#include "enfield/Transform/CommutationDAGBuilderPass.h"
+#include "enfield/Transform/Utils.h"
+#include "enfield/Support/RTTI.h"
+#include "enfield/Support/Defs.h"
+
+#include <cassert>
+
+using namespace efd;
+
+// ----------------------------------------------------------------
+// --------------------- Canonicalizer Class ----------------------
+// ----------------------------------------------------------------
+
+Canonicalizer::Canonicalizer(QModule::Ref qmod) : mQubits(0), mCbits(0) {
+    for (auto it = qmod->reg_begin(), end = qmod->reg_end(); it != end; ++it) {
+        auto reg = *it;
+        uint32_t size = reg->getSize()->getVal().mV;
+
+        if (reg->isQReg()) {
+            mRegs[reg->getId()->getVal()] = { true, mQubits, size };
+            mQubits += size;
+        } else {
+            mRegs[reg->getId()->getVal()] = { false, mCbits, size };
+            mCbits += size;
+        }
+    }
+}
+
+bool Canonicalizer::getUId(Node::Ref ref, bool isQuantum, uint32_t& uid) const {
+    auto idref = dynCast<NDIdRef>(ref);
+
+    if (idref == nullptr) {
+        ERR << "Flattened programs only have indexed xbits: `"
+            << ref->toString(false) << "`." << std::endl;
+        return false;
+    }
+
+    auto name = idref->getId()->getVal();
+    auto it = mRegs.find(name);
+
+    if (it == mRegs.end() || it->second.mIsQuantum != isQuantum) {
+        ERR << "Register `" << name << "` not found." << std::endl;
+        return false;
+    }
+
+    uint32_t n = idref->getN()->getVal().mV;
+
+    if (n >= it->second.mSize) {
+        ERR << "Index out of bounds: `" << idref->toString(false) << "`." << std::endl;
+        return false;
+    }
+
+    uid = it->second.mBase + n;
+    return true;
+}
+
+bool Canonicalizer::appendRegUIds(const std::string& name, std::vector<uint32_t>& uids) const {
+    auto it = mRegs.find(name);
+
+    if (it == mRegs.end() || it->second.mIsQuantum) {
+        ERR << "Register `" << name << "` not found." << std::endl;
+        return false;
+    }
+
+    for (uint32_t i = 0; i < it->second.mSize; ++i) {
+        uids.push_back(it->second.mBase + i);
+    }
+
+    return true;
+}
+
+uint32_t Canonicalizer::getQSize() const {
+    return mQubits;
+}
+
+uint32_t Canonicalizer::getCSize() const {
+    return mCbits;
+}
+
+Canonicalizer::Result Canonicalizer::canonicalize(Node::Ref stmt, CanonicalGate& gate) const {
+    auto ifstmt = dynCast<NDIfStmt>(stmt);
+    auto qop = (ifstmt != nullptr) ? ifstmt->getQOp() : dynCast<NDQOp>(stmt);
+
+    if (qop == nullptr) return R_NOT_QOP;
+
+    gate.mK = CanonicalGate::K_GATE;
+    gate.mSignature.clear();
+    gate.mQubits.clear();
+    gate.mCbits.clear();
+
+    if (ifstmt != nullptr) {
+        auto cond = ifstmt->getCondId()->getVal();
+        gate.mSignature += "if(" + cond + "==" + ifstmt->getCondN()->toString(false) + ")";
+        if (!appendRegUIds(cond, gate.mCbits)) return R_INVALID;
+    }
+
+    if (auto measure = dynCast<NDQOpMeasure>(qop)) {
+        gate.mSignature += "measure";
+        uint32_t qubit, cbit;
+
+        if (!getUId(measure->getQBit(), true, qubit) ||
+            !getUId(measure->getCBit(), false, cbit)) {
+            return R_INVALID;
+        }
+
+        gate.mQubits.push_back(qubit);
+        gate.mCbits.push_back(cbit);
+        return R_GATE;
+    }
+
+    auto qargs = qop->getQArgs();
+    for (uint32_t i = 0, e = qargs->getChildNumber(); i < e; ++i) {
+        uint32_t qubit;
+        if (!getUId(qargs->getChild(i), true, qubit)) return R_INVALID;
+        gate.mQubits.push_back(qubit);
+    }
+
+    auto qopgen = dynCast<NDQOpGen>(qop);
+
+    if (qopgen != nullptr && qopgen->isIntrinsic()) {
+        switch (qopgen->getIntrinsicKind()) {
+            case NDQOpGen::K_INTRINSIC_SWAP:
+                gate.mK = CanonicalGate::K_SWAP;
+                gate.mSignature += qopgen->getOperation();
+                return R_GATE;
+
+            case NDQOpGen::K_INTRINSIC_REV_CX:
+                gate.mSignature += "cx";
+                return R_GATE;
+
+            case NDQOpGen::K_INTRINSIC_LCX:
+                // Only the control and the target are actually used.
+                gate.mSignature += "cx";
+                gate.mQubits.erase(gate.mQubits.begin() + 1);
+                return R_GATE;
+        }
+    }
+
+    if (IsCNOTGateCall(qop)) {
+        gate.mSignature += "cx";
+        return R_GATE;
+    }
+
+    gate.mSignature += qop->getOperation();
+
+    auto args = qop->getArgs();
+    if (args != nullptr && args->getChildNumber() > 0) {
+        gate.mSignature += "(" + args->toString(false) + ")";
+    }
+
+    return R_GATE;
+}
+
+// ----------------------------------------------------------------
+// -------------------- CanonicalCircuit Class --------------------
+// ----------------------------------------------------------------
+
+const uint32_t CanonicalCircuit::NoSignature = std::numeric_limits<uint32_t>::max();
+
+CanonicalCircuit::CanonicalCircuit(uint32_t qubits, uint32_t cbits)
+    : mGraph(qubits, cbits) {}
+
+void CanonicalCircuit::append(const CanonicalGate& gate, std::vector<CommutationDAG::Axis> axis) {
+    std::vector<Xbit> xbits;
+
+    for (uint32_t q : gate.mQubits) xbits.push_back(Xbit::Q(q));
+    for (uint32_t c : gate.mCbits) xbits.push_back(Xbit::C(c));
+
+    mGraph.append(xbits, nullptr);
+
+    uint32_t g = mGraph.getNumberOfGates() - 1;
+    uint32_t slots = mGraph.getNumberOfXbits(g);
+
+    // Classical bits (and repeated xbits) keep the program order.
+    axis.resize(slots, CommutationDAG::Axis::NONE);
+    if (slots != xbits.size() || !gate.mCbits.empty()) {
+        axis.assign(slots, CommutationDAG::Axis::NONE);
+    }
+
+    mAxis.insert(mAxis.end(), axis.begin(), axis.end());
+
+    auto it = mSignatureId.find(gate.mSignature);
+
+    if (it == mSignatureId.end()) {
+        it = mSignatureId.insert(std::make_pair(gate.mSignature, mSignatureId.size())).first;
+    }
+
+    mGateSignature.push_back(it->second);
+}
+
+uint32_t CanonicalCircuit::getSignatureId(const std::string& signature) const {
+    auto it = mSignatureId.find(signature);
+    if (it == mSignatureId.end()) return NoSignature;
+    return it->second;
+}
+
+uint32_t CanonicalCircuit::getSignature(uint32_t gate) const {
+    return mGateSignature[gate];
+}
+
+const CircuitGraph& CanonicalCircuit::getGraph() const {
+    return mGraph;
+}
+
+const std::vector<CommutationDAG::Axis>& CanonicalCircuit::getAxis() const {
+    return mAxis;
+}
+
+CanonicalCircuit::uRef CanonicalCircuit::Create(QModule::Ref qmod) {
+    Canonicalizer canonicalizer(qmod);
+    uRef circuit(new CanonicalCircuit(canonicalizer.getQSize(), canonicalizer.getCSize()));
+
+    CanonicalGate gate;
+
+    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
+        auto stmt = it->get();
+
+        switch (canonicalizer.canonicalize(stmt, gate)) {
+            case Canonicalizer::R_GATE:
+                circuit->append(gate, GetCommutationAxis(stmt));
+                break;
+
+            case Canonicalizer::R_NOT_QOP:
+                break;
+
+            case Canonicalizer::R_INVALID:
+                return uRef(nullptr);
+        }
+    }
+
+    return circuit;
+}
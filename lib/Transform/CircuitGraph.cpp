@@ -1,4 +1,5 @@
 #include "enfield/Transform/CircuitGraph.h"
+#include "enfield/Transform/CommutationDAG.h"
 #include "enfield/Support/Defs.h"
 
 #include <cassert>
@@ -44,91 +45,122 @@ Xbit Xbit::C(uint32_t id) {
     return Xbit(Type::CLASSIC, id);
 }
 
+const uint32_t CircuitGraph::InputSlot;
+const uint32_t CircuitGraph::OutputSlot;
+const uint32_t CircuitGraph::NoGate;
+
 // ----------------------------------------------------------------
 // --------------------- CircuitNode Class ------------------------
 // ----------------------------------------------------------------
 
-CircuitGraph::CircuitNode::CircuitNode(Type type) : mType(type), mNode(nullptr) {}
+CircuitGraph::CircuitNode::CircuitNode(const CircuitGraph* graph, uint32_t gate)
+    : mGraph(graph), mGate(gate) {}
+
+CircuitGraph::CircuitNode::CircuitNode() : mGraph(nullptr), mGate(0) {}
 
-Node::Ref CircuitGraph::CircuitNode::node() {
-    return mNode;
+Node::Ref CircuitGraph::CircuitNode::node() const {
+    if (!isGateNode()) return nullptr;
+    return mGraph->mGateNode[mGate];
 }
 
-uint32_t CircuitGraph::CircuitNode::numberOfXbits() {
-    return mStepMap.size();
+uint32_t CircuitGraph::CircuitNode::numberOfXbits() const {
+    if (!isGateNode()) return 0;
+    return mGraph->mGateOffset[mGate + 1] - mGraph->mGateOffset[mGate];
 }
 
-bool CircuitGraph::CircuitNode::isOutputNode() {
-    return mType == CircuitNode::Type::OUTPUT;
+bool CircuitGraph::CircuitNode::isValid() const {
+    return mGraph != nullptr;
 }
 
-bool CircuitGraph::CircuitNode::isInputNode() {
-    return mType == CircuitNode::Type::INPUT;
+bool CircuitGraph::CircuitNode::isOutputNode() const {
+    return isValid() && mGate == OutputSlot;
 }
 
-bool CircuitGraph::CircuitNode::isGateNode() {
-    return !isInputNode() && !isOutputNode();
+bool CircuitGraph::CircuitNode::isInputNode() const {
+    return isValid() && mGate == InputSlot;
 }
 
-std::vector<uint32_t> CircuitGraph::CircuitNode::getXbitsIds() {
+bool CircuitGraph::CircuitNode::isGateNode() const {
+    return isValid() && !isInputNode() && !isOutputNode();
+}
+
+std::vector<uint32_t> CircuitGraph::CircuitNode::getXbitsIds() const {
     std::vector<uint32_t> xbitsIds;
-    for (auto& pair : mStepMap) {
-        xbitsIds.push_back(pair.first);
+
+    if (isGateNode()) {
+        auto begin = mGraph->mSlotXbit.begin();
+        xbitsIds.assign(begin + mGraph->mGateOffset[mGate],
+                        begin + mGraph->mGateOffset[mGate + 1]);
     }
 
     return xbitsIds;
 }
 
+bool CircuitGraph::CircuitNode::operator==(const CircuitNode& rhs) const {
+    return mGraph == rhs.mGraph && mGate == rhs.mGate;
+}
+
+bool CircuitGraph::CircuitNode::operator!=(const CircuitNode& rhs) const {
+    return !(*this == rhs);
+}
+
+bool CircuitGraph::CircuitNode::operator<(const CircuitNode& rhs) const {
+    if (mGraph != rhs.mGraph) return mGraph < rhs.mGraph;
+    return mGate < rhs.mGate;
+}
+
 // ----------------------------------------------------------------
 // ----------------- CircuitGraph::Iterator Class -----------------
 // ----------------------------------------------------------------
 
-CircuitGraph::Iterator::Iterator(uint32_t qubits,
-                                 uint32_t cbits,
-                                 std::vector<CircuitNode::sRef> ptr) :
-                                 mQubits(qubits),
-                                 mCbits(cbits),
-                                 mPtr(ptr) {}
+CircuitGraph::Iterator::Iterator(const CircuitGraph* graph)
+    : mGraph(graph), mSlot(graph->size(), InputSlot) {}
 
-CircuitGraph::Iterator::Iterator() : mQubits(0), mCbits(0), mPtr(0) {}
+CircuitGraph::Iterator::Iterator() : mGraph(nullptr) {}
 
 bool CircuitGraph::Iterator::next(uint32_t id) {
-    if (mPtr[id]->isOutputNode()) return false;
-    mPtr[id] = mPtr[id]->mStepMap[id].second;
+    uint32_t slot = mSlot[id];
+    if (slot == OutputSlot) return false;
+
+    if (slot == InputSlot) mSlot[id] = mGraph->mWireFirst[id];
+    else mSlot[id] = mGraph->mSlotNext[slot];
     return true;
 }
 
 bool CircuitGraph::Iterator::next(Xbit xbit) {
-    uint32_t id = xbit.getRealId(mQubits, mCbits);
+    uint32_t id = xbit.getRealId(mGraph->mQubits, mGraph->mCbits);
     return next(id);
 }
 
 bool CircuitGraph::Iterator::back(uint32_t id) {
-    if (mPtr[id]->isInputNode()) return false;
-    mPtr[id] = mPtr[id]->mStepMap[id].first;
+    uint32_t slot = mSlot[id];
+    if (slot == InputSlot) return false;
+
+    if (slot == OutputSlot) mSlot[id] = mGraph->mWireLast[id];
+    else mSlot[id] = mGraph->mSlotPrev[slot];
     return true;
 }
 
 bool CircuitGraph::Iterator::back(Xbit xbit) {
-    uint32_t id = xbit.getRealId(mQubits, mCbits);
+    uint32_t id = xbit.getRealId(mGraph->mQubits, mGraph->mCbits);
     return back(id);
 }
 
-Node::Ref CircuitGraph::Iterator::get(uint32_t id) {
-    return mPtr[id]->mNode;
+Node::Ref CircuitGraph::Iterator::get(uint32_t id) const {
+    return (*this)[id].node();
 }
 
-Node::Ref CircuitGraph::Iterator::get(Xbit xbit) {
-    uint32_t id = xbit.getRealId(mQubits, mCbits);
+Node::Ref CircuitGraph::Iterator::get(Xbit xbit) const {
+    uint32_t id = xbit.getRealId(mGraph->mQubits, mGraph->mCbits);
     return get(id);
 }
 
-CircuitGraph::CircuitNode::sRef CircuitGraph::Iterator::operator[](uint32_t id) {
-    return mPtr[id];
+CircuitGraph::CircuitNode CircuitGraph::Iterator::operator[](uint32_t id) const {
+    return CircuitNode(mGraph, mGraph->getGateOf(mSlot[id]));
 }
 
-CircuitGraph::CircuitNode::sRef CircuitGraph::Iterator::operator[](Xbit xbit) {
-    uint32_t id = xbit.getRealId(mQubits, mCbits);
+CircuitGraph::CircuitNode CircuitGraph::Iterator::operator[](Xbit xbit) const {
+    uint32_t id = xbit.getRealId(mGraph->mQubits, mGraph->mCbits);
     return (*this)[id];
 }
 
@@ -136,30 +168,36 @@ CircuitGraph::CircuitNode::sRef CircuitGraph::Iterator::operator[](Xbit xbit) {
 // -------------------- CircuitGraph Class ------------------------
 // ----------------------------------------------------------------
 
-CircuitGraph::CircuitGraph() : mInit(false) {}
+CircuitGraph::CircuitGraph() : mInit(false), mQubits(0), mCbits(0) {}
 
 CircuitGraph::CircuitGraph(uint32_t qubits, uint32_t cbits) {
     init(qubits, cbits);
 }
 
+uint32_t CircuitGraph::getGateOf(uint32_t slot) const {
+    if (slot == InputSlot || slot == OutputSlot) return slot;
+    return mSlotGate[slot];
+}
+
 void CircuitGraph::init(uint32_t qubits, uint32_t cbits) {
     mInit = true;
     mQubits = qubits;
     mCbits = cbits;
 
-    mGraphHead.assign(mQubits + mCbits,
-                      CircuitNode::sRef(new CircuitNode(CircuitNode::Type::INPUT)));
-    mGraphTail.assign(mQubits + mCbits,
-                      CircuitNode::sRef(new CircuitNode(CircuitNode::Type::OUTPUT)));
+    mGateNode.clear();
+    mGateOffset.assign(1, 0);
 
-    // Initializing the head to point to the tail, and the tail to the head.
-    for (uint32_t i = 0, e = mQubits + mCbits; i < e; ++i) {
-        mGraphHead[i]->mStepMap[i] = std::make_pair(nullptr, mGraphTail[i]);
-        mGraphTail[i]->mStepMap[i] = std::make_pair(mGraphHead[i], nullptr);
-    }
+    mSlotXbit.clear();
+    mSlotGate.clear();
+    mSlotPrev.clear();
+    mSlotNext.clear();
+
+    // Initializing every wire as going from the input to the output.
+    mWireFirst.assign(mQubits + mCbits, OutputSlot);
+    mWireLast.assign(mQubits + mCbits, InputSlot);
 }
 
-void CircuitGraph::checkInitialized() {
+void CircuitGraph::checkInitialized() const {
     if (!mInit) {
         ERR << "Trying to append a node to an uninitialized CircuitGraph." << std::endl;
         std::exit(static_cast<uint32_t>(ExitCode::EXIT_unreachable));
@@ -178,25 +216,155 @@ uint32_t CircuitGraph::size() const {
     return mQubits + mCbits;
 }
 
+uint32_t CircuitGraph::getNumberOfGates() const {
+    return mGateNode.size();
+}
+
+Node::Ref CircuitGraph::getNode(uint32_t gate) const {
+    return mGateNode[gate];
+}
+
+uint32_t CircuitGraph::getNumberOfXbits(uint32_t gate) const {
+    return mGateOffset[gate + 1] - mGateOffset[gate];
+}
+
+uint32_t CircuitGraph::getXbit(uint32_t gate, uint32_t i) const {
+    return mSlotXbit[mGateOffset[gate] + i];
+}
+
+uint32_t CircuitGraph::getPredGate(uint32_t gate, uint32_t i) const {
+    uint32_t slot = mSlotPrev[mGateOffset[gate] + i];
+    if (slot == InputSlot) return NoGate;
+    return mSlotGate[slot];
+}
+
+uint32_t CircuitGraph::getSuccGate(uint32_t gate, uint32_t i) const {
+    uint32_t slot = mSlotNext[mGateOffset[gate] + i];
+    if (slot == OutputSlot) return NoGate;
+    return mSlotGate[slot];
+}
+
 void CircuitGraph::append(std::vector<Xbit> xbits, Node::Ref node) {
     checkInitialized();
 
-    CircuitNode::sRef newNode(new CircuitNode(CircuitNode::Type::GATE));
-    newNode->mNode = node;
+    uint32_t gate = mGateNode.size();
+    mGateNode.push_back(node);
 
     for (auto xbit : xbits) {
         uint32_t id = xbit.getRealId(mQubits, mCbits);
+        uint32_t slot = mSlotXbit.size();
+        uint32_t last = mWireLast[id];
 
-        auto lastNode = mGraphTail[id]->mStepMap[id].first;
-        lastNode->mStepMap[id].second = newNode;
-        newNode->mStepMap[id] = std::make_pair(lastNode, mGraphTail[id]);
-        mGraphTail[id]->mStepMap[id].first = newNode;
+        // The same xbit used twice by this gate.
+        if (last != InputSlot && mSlotGate[last] == gate) continue;
+
+        mSlotXbit.push_back(id);
+        mSlotGate.push_back(gate);
+        mSlotPrev.push_back(last);
+        mSlotNext.push_back(OutputSlot);
+
+        if (last == InputSlot) mWireFirst[id] = slot;
+        else mSlotNext[last] = slot;
+        mWireLast[id] = slot;
     }
+
+    mGateOffset.push_back(mSlotXbit.size());
 }
 
-CircuitGraph::Iterator CircuitGraph::build_iterator() {
+CircuitGraph::Iterator CircuitGraph::build_iterator() const {
     checkInitialized();
+    return Iterator(this);
+}
+
+// ----------------------------------------------------------------
+// -------------------- KahnScheduler Class -----------------------
+// ----------------------------------------------------------------
+
+KahnScheduler::KahnScheduler(const CircuitGraph& graph, const CommutationDAG* dag)
+    : mGraph(graph), mDAG(dag), mInDegree(graph.getNumberOfGates(), 0), mEmitted(0) {
+
+    if (mDAG != nullptr) {
+        mDAG->checkInitialized();
+        mPending.assign(mDAG->getNumberOfBlocks(), 0);
+
+        for (uint32_t b = 0, e = mDAG->getNumberOfBlocks(); b < e; ++b) {
+            uint32_t next = mDAG->getNextBlock(b);
+            if (next != CommutationDAG::NoBlock) mPending[next] = mDAG->getBlockSize(b);
+        }
+    }
+
+    for (uint32_t g = 0, e = mGraph.getNumberOfGates(); g < e; ++g) {
+        for (uint32_t i = 0, n = mGraph.getNumberOfXbits(g); i < n; ++i) {
+            bool hasPred = (mDAG == nullptr) ?
+                mGraph.getPredGate(g, i) != CircuitGraph::NoGate :
+                mPending[mDAG->getBlock(g, i)] > 0;
+
+            if (hasPred) ++mInDegree[g];
+        }
+
+        if (mInDegree[g] == 0) mReady.push_back(g);
+    }
+}
+
+const std::vector<uint32_t>& KahnScheduler::getInitialReady() const {
+    return mReady;
+}
+
+void KahnScheduler::emit(uint32_t gate, std::vector<uint32_t>& ready) {
+    assert(mInDegree[gate] == 0 && "Emitting a gate that is not ready.");
+    ++mEmitted;
+
+    for (uint32_t i = 0, n = mGraph.getNumberOfXbits(gate); i < n; ++i) {
+        if (mDAG == nullptr) {
+            uint32_t succ = mGraph.getSuccGate(gate, i);
+
+            if (succ != CircuitGraph::NoGate && --mInDegree[succ] == 0) {
+                ready.push_back(succ);
+            }
+
+            continue;
+        }
+
+        uint32_t next = mDAG->getNextBlock(mDAG->getBlock(gate, i));
+        if (next == CommutationDAG::NoBlock || --mPending[next] > 0) continue;
+
+        // The whole block before 'next' was emitted.
+        for (uint32_t j = 0, e = mDAG->getBlockSize(next); j < e; ++j) {
+            uint32_t succ = mDAG->getBlockGate(next, j);
+            if (--mInDegree[succ] == 0) ready.push_back(succ);
+        }
+    }
+}
+
+bool KahnScheduler::isDone() const {
+    return mEmitted == mGraph.getNumberOfGates();
+}
+
+std::vector<std::vector<uint32_t>> KahnScheduler::BuildLayers(const CircuitGraph& graph,
+                                                              const CommutationDAG* dag) {
+    uint32_t gates = graph.getNumberOfGates();
+    std::vector<uint32_t> layerOf(gates, 0);
+    uint32_t nofLayers = 0;
+
+    KahnScheduler scheduler(graph, dag);
+    std::vector<uint32_t> current = scheduler.getInitialReady(), next;
+
+    for (uint32_t layer = 0; !current.empty(); ++layer) {
+        for (uint32_t g : current) {
+            layerOf[g] = layer;
+            scheduler.emit(g, next);
+        }
+
+        nofLayers = layer + 1;
+        current.swap(next);
+        next.clear();
+    }
+
+    // Distributing the gates in order, so that no sorting is needed.
+    std::vector<std::vector<uint32_t>> layers(nofLayers);
+    for (uint32_t g = 0; g < gates; ++g) {
+        layers[layerOf[g]].push_back(g);
+    }
 
-    Iterator iterator(mQubits, mCbits, mGraphHead);
-    return iterator;
+    return layers;
 }
@@ -11,7 +11,7 @@ bool CircuitGraphBuilderPass::run(QModule* qmod) {
     auto& graph = mData;
 
     auto xtonpass = PassCache::Get<XbitToNumberWrapperPass>(qmod);
-    auto xton = xtonpass->getData();
+    auto& xton = xtonpass->getData();
 
     auto qubits = xton.getQSize();
     auto cbits = xton.getCSize();
@@ -50,6 +50,10 @@ bool CircuitGraphBuilderPass::run(QModule* qmod) {
     return false;
 }
 
+std::vector<uint8_t*> CircuitGraphBuilderPass::getDependencies() const {
+    return { &XbitToNumberWrapperPass::ID };
+}
+
 CircuitGraphBuilderPass::uRef CircuitGraphBuilderPass::Create() {
     return uRef(new CircuitGraphBuilderPass());
 }
@@ -0,0 +1,105 @@
+#include "enfield/Transform/CommutationDAG.h"
+#include "enfield/Support/Defs.h"
+
+#include <cassert>
+
+using namespace efd;
+
+const uint32_t CommutationDAG::NoBlock = std::numeric_limits<uint32_t>::max();
+
+CommutationDAG::CommutationDAG() : mInit(false) {}
+
+void CommutationDAG::init(const CircuitGraph& graph, const std::vector<Axis>& axis) {
+    uint32_t gates = graph.getNumberOfGates();
+
+    mInit = true;
+    mGateOffset.assign(1, 0);
+
+    for (uint32_t g = 0; g < gates; ++g) {
+        mGateOffset.push_back(mGateOffset.back() + graph.getNumberOfXbits(g));
+    }
+
+    assert(axis.size() == mGateOffset.back() && "There must be one axis for each slot.");
+
+    mSlotBlock.assign(mGateOffset.back(), NoBlock);
+    mBlockNext.clear();
+
+    std::vector<uint32_t> blockSize;
+
+    // Gates are visited in order. So, the block of the previous gate in the
+    // wire is always known.
+    for (uint32_t g = 0; g < gates; ++g) {
+        for (uint32_t i = 0, e = graph.getNumberOfXbits(g); i < e; ++i) {
+            uint32_t slot = mGateOffset[g] + i;
+            uint32_t pred = graph.getPredGate(g, i);
+            uint32_t predSlot = NoBlock;
+
+            if (pred != CircuitGraph::NoGate) {
+                uint32_t xbit = graph.getXbit(g, i);
+                uint32_t j = 0;
+                while (graph.getXbit(pred, j) != xbit) ++j;
+                predSlot = mGateOffset[pred] + j;
+            }
+
+            if (predSlot != NoBlock && axis[slot] != Axis::NONE &&
+                    axis[slot] == axis[predSlot]) {
+                mSlotBlock[slot] = mSlotBlock[predSlot];
+            } else {
+                mSlotBlock[slot] = mBlockNext.size();
+                mBlockNext.push_back(NoBlock);
+                blockSize.push_back(0);
+
+                if (predSlot != NoBlock) {
+                    mBlockNext[mSlotBlock[predSlot]] = mSlotBlock[slot];
+                }
+            }
+
+            ++blockSize[mSlotBlock[slot]];
+        }
+    }
+
+    uint32_t blocks = mBlockNext.size();
+    mBlockOffset.assign(blocks + 1, 0);
+
+    for (uint32_t b = 0; b < blocks; ++b) {
+        mBlockOffset[b + 1] = mBlockOffset[b] + blockSize[b];
+    }
+
+    // Reusing 'blockSize' as the number of gates already in each block.
+    blockSize.assign(blocks, 0);
+    mBlockGates.assign(mBlockOffset.back(), 0);
+
+    for (uint32_t g = 0; g < gates; ++g) {
+        for (uint32_t slot = mGateOffset[g]; slot < mGateOffset[g + 1]; ++slot) {
+            uint32_t b = mSlotBlock[slot];
+            mBlockGates[mBlockOffset[b] + blockSize[b]++] = g;
+        }
+    }
+}
+
+void CommutationDAG::checkInitialized() const {
+    if (!mInit) {
+        ERR << "Trying to use an uninitialized CommutationDAG." << std::endl;
+        std::exit(static_cast<uint32_t>(ExitCode::EXIT_unreachable));
+    }
+}
+
+uint32_t CommutationDAG::getNumberOfBlocks() const {
+    return mBlockNext.size();
+}
+
+uint32_t CommutationDAG::getBlock(uint32_t gate, uint32_t i) const {
+    return mSlotBlock[mGateOffset[gate] + i];
+}
+
+uint32_t CommutationDAG::getNextBlock(uint32_t block) const {
+    return mBlockNext[block];
+}
+
+uint32_t CommutationDAG::getBlockSize(uint32_t block) const {
+    return mBlockOffset[block + 1] - mBlockOffset[block];
+}
+
+uint32_t CommutationDAG::getBlockGate(uint32_t block, uint32_t i) const {
+    return mBlockGates[mBlockOffset[block] + i];
+}
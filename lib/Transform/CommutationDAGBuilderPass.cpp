@@ -0,0 +1,81 @@
+#include "enfield/Transform/CommutationDAGBuilderPass.h"
+#include "enfield/Transform/CircuitGraphBuilderPass.h"
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Support/RTTI.h"
+
+#include <unordered_map>
+
+using namespace efd;
+
+uint8_t CommutationDAGBuilderPass::ID = 0;
+
+std::vector<CommutationDAG::Axis> efd::GetCommutationAxis(Node::Ref node) {
+    typedef CommutationDAG::Axis Axis;
+
+    static const std::unordered_map<std::string, std::vector<Axis>> StdLibAxis {
+        { "x", { Axis::X } },
+        { "rx", { Axis::X } },
+        { "z", { Axis::Z } },
+        { "s", { Axis::Z } },
+        { "sdg", { Axis::Z } },
+        { "t", { Axis::Z } },
+        { "tdg", { Axis::Z } },
+        { "rz", { Axis::Z } },
+        { "u1", { Axis::Z } },
+        { "cx", { Axis::Z, Axis::X } },
+        { "cz", { Axis::Z, Axis::Z } },
+        { "cu1", { Axis::Z, Axis::Z } },
+        { "crz", { Axis::Z, Axis::Z } },
+        { "ccx", { Axis::Z, Axis::Z, Axis::X } }
+    };
+
+    auto qop = dynCast<NDQOp>(node);
+    if (qop == nullptr) return {};
+
+    uint32_t qargs = qop->getQArgs()->getChildNumber();
+    std::vector<Axis> axis(qargs, Axis::NONE);
+
+    if (instanceOf<NDQOpCX>(node)) {
+        axis = { Axis::Z, Axis::X };
+    } else if (auto qopgen = dynCast<NDQOpGen>(node)) {
+        auto it = StdLibAxis.find(qopgen->getOperation());
+
+        if (!qopgen->isIntrinsic() && it != StdLibAxis.end() &&
+                it->second.size() == qargs) {
+            axis = it->second;
+        }
+    }
+
+    return axis;
+}
+
+bool CommutationDAGBuilderPass::run(QModule* qmod) {
+    auto cgbpass = PassCache::Get<CircuitGraphBuilderPass>(qmod);
+    auto& graph = cgbpass->getData();
+
+    std::vector<CommutationDAG::Axis> axis;
+
+    for (uint32_t g = 0, e = graph.getNumberOfGates(); g < e; ++g) {
+        uint32_t xbits = graph.getNumberOfXbits(g);
+        auto gateAxis = GetCommutationAxis(graph.getNode(g));
+
+        // Only plain quantum operations have exactly one slot for each
+        // quantum argument.
+        if (gateAxis.size() != xbits) {
+            gateAxis.assign(xbits, CommutationDAG::Axis::NONE);
+        }
+
+        axis.insert(axis.end(), gateAxis.begin(), gateAxis.end());
+    }
+
+    mData.init(graph, axis);
+    return false;
+}
+
+std::vector<uint8_t*> CommutationDAGBuilderPass::getDependencies() const {
+    return { &CircuitGraphBuilderPass::ID };
+}
+
+CommutationDAGBuilderPass::uRef CommutationDAGBuilderPass::Create() {
+    return uRef(new CommutationDAGBuilderPass());
+}
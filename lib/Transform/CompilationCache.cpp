@@ -0,0 +1,265 @@
+#include "enfield/Transform/CompilationCache.h"
+#include "enfield/Support/MappedFile.h"
+#include "enfield/Support/SHA256.h"
+#include "enfield/Support/CommandLine.h"
+
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cerrno>
+#include <cctype>
+#include <set>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace efd;
+
+extern efd::Opt<std::vector<std::string>> IncludePath;
+
+namespace efd {
+    // Declared in "enfield/Analysis/Driver.h", whose guard is the same as
+    // "enfield/Transform/Driver.h".
+    bool IsStdLib(std::string file);
+}
+
+static const std::string EntryMagic = "efd-cache-1";
+static const std::string EntrySuffix = ".entry";
+
+const uint64_t CompilationCache::DefaultMaxSize = 256ull << 20;
+
+// Returns the files included by \p program, in order. Comments are skipped,
+// as well as the other strings.
+static std::vector<std::string> FindIncludes(const std::string& program) {
+    static const std::string Include = "include";
+    std::vector<std::string> files;
+
+    for (std::size_t i = 0, size = program.size(); i < size; ++i) {
+        if (program.compare(i, 2, "//") == 0) {
+            i = program.find('\n', i);
+        } else if (program[i] == '"') {
+            i = program.find('"', i + 1);
+        } else if (program.compare(i, Include.size(), Include) == 0 &&
+                   (i == 0 || !(std::isalnum(program[i - 1]) || program[i - 1] == '_'))) {
+            auto begin = program.find_first_not_of(" \t\r\n", i + Include.size());
+            if (begin == std::string::npos || program[begin] != '"') continue;
+
+            i = program.find('"', begin + 1);
+            if (i == std::string::npos) break;
+
+            files.push_back(program.substr(begin + 1, i - begin - 1));
+        }
+
+        if (i == std::string::npos) break;
+    }
+
+    return files;
+}
+
+// Hashes the contents of every file included by \p program (recursively),
+// but the standard library ones. They are looked for the same way the parser
+// does: in the include path, then in \p path (where \p program was found).
+static void HashIncludes(const std::string& program, const std::string& path,
+                         std::set<std::string>& including, SHA256& sha) {
+    auto includePaths = IncludePath.getVal();
+    includePaths.push_back(path);
+
+    for (auto& file : FindIncludes(program)) {
+        if (IsStdLib(file)) continue;
+
+        MappedFile::uRef mapped;
+        std::string foundPath;
+
+        for (auto& includePath : includePaths) {
+            mapped = MappedFile::Open(includePath + file);
+            foundPath = includePath;
+            if (mapped.get() != nullptr) break;
+        }
+
+        if (mapped.get() == nullptr) {
+            sha.update("include " + file + " missing\n");
+            continue;
+        }
+
+        std::string contents(mapped->data(), mapped->size());
+        sha.update("include " + foundPath + file + " " +
+                   std::to_string(contents.size()) + "\n" + contents);
+
+        // A file that includes itself never finishes parsing. Anyway, it is
+        // hashed only once.
+        if (including.insert(foundPath + file).second) {
+            HashIncludes(contents, foundPath, including, sha);
+            including.erase(foundPath + file);
+        }
+    }
+}
+
+static bool CreateDirectories(const std::string& dir) {
+    for (auto i = dir.find('/', 1); i != std::string::npos; i = dir.find('/', i + 1)) {
+        mkdir(dir.substr(0, i).c_str(), 0755);
+    }
+
+    struct stat st;
+    return (mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST) &&
+        stat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+CompilationCache::CompilationCache(std::string dir, uint64_t maxSize)
+    : mDir(dir), mMaxSize(maxSize) {}
+
+std::string CompilationCache::getPath(const std::string& key) const {
+    return mDir + "/" + key + EntrySuffix;
+}
+
+bool CompilationCache::lookup(const std::string& key, Entry& entry) {
+    auto path = getPath(key);
+
+    auto mapped = MappedFile::Open(path);
+    if (mapped.get() == nullptr) return false;
+
+    // Header: the magic line, then the size of both fields.
+    std::string contents(mapped->data(), mapped->size());
+    std::istringstream in(contents);
+    std::string magic;
+    uint64_t outputSize, statsSize;
+
+    if (!std::getline(in, magic) || magic != EntryMagic ||
+        !(in >> outputSize >> statsSize) || in.get() != '\n') {
+        return false;
+    }
+
+    uint64_t begin = in.tellg();
+    if (begin + outputSize + statsSize != contents.size()) return false;
+
+    entry.mOutput = contents.substr(begin, outputSize);
+    entry.mStats = contents.substr(begin + outputSize, statsSize);
+
+    // Marks it as recently used.
+    utimes(path.c_str(), nullptr);
+    return true;
+}
+
+bool CompilationCache::store(const std::string& key, const Entry& entry) {
+    static std::atomic<uint32_t> Counter(0);
+
+    auto path = getPath(key);
+    auto tmpPath = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(Counter++);
+
+    std::ofstream out(tmpPath, std::ios::binary);
+    out << EntryMagic << "\n"
+        << entry.mOutput.size() << " " << entry.mStats.size() << "\n"
+        << entry.mOutput << entry.mStats;
+    out.close();
+
+    if (!out || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    evict();
+    return true;
+}
+
+void CompilationCache::evict() {
+    struct EntryFile {
+        std::string mPath;
+        uint64_t mSize;
+        struct timespec mTime;
+    };
+
+    std::lock_guard<std::mutex> lock(mEvictMutex);
+
+    DIR* d = opendir(mDir.c_str());
+    if (d == nullptr) return;
+
+    std::vector<EntryFile> files;
+    uint64_t total = 0;
+
+    for (struct dirent* ent = readdir(d); ent != nullptr; ent = readdir(d)) {
+        std::string name = ent->d_name;
+
+        if (name.size() <= EntrySuffix.size() ||
+            name.compare(name.size() - EntrySuffix.size(), EntrySuffix.size(), EntrySuffix) != 0) {
+            continue;
+        }
+
+        struct stat st;
+        auto path = mDir + "/" + name;
+
+        if (stat(path.c_str(), &st) == 0) {
+            files.push_back({ path, (uint64_t) st.st_size, st.st_mtim });
+            total += st.st_size;
+        }
+    }
+
+    closedir(d);
+
+    if (total <= mMaxSize) return;
+
+    std::sort(files.begin(), files.end(), [](const EntryFile& a, const EntryFile& b) {
+        return a.mTime.tv_sec < b.mTime.tv_sec ||
+            (a.mTime.tv_sec == b.mTime.tv_sec && a.mTime.tv_nsec < b.mTime.tv_nsec);
+    });
+
+    for (auto& file : files) {
+        if (total <= mMaxSize) break;
+        if (std::remove(file.mPath.c_str()) == 0) total -= file.mSize;
+    }
+}
+
+std::string CompilationCache::GetKey(const std::string& program,
+                                     const CompilationSettings& settings, bool pretty,
+                                     StatsFormat statsFormat, const std::string& path) {
+    std::ostringstream material;
+    auto allocator = settings.allocator.getValue();
+
+    material << EntryMagic << "\n"
+             << settings.archGraph->dotify() << "\n"
+             << settings.allocator.getStringValue() << "\n";
+
+    for (auto& gate : settings.basis) material << gate << ",";
+
+    auto& options = settings.allocatorOptions;
+
+    material << "\n" << settings.reorder << settings.verify << settings.force
+             << pretty << settings.commute << "\n"
+             << options.swapCost << " " << options.revCost << " " << options.lcxCost << "\n";
+
+    if (allocator == Allocator::Q_ibm || allocator == Allocator::Q_random) {
+        material << "seed " << options.seed << "\n";
+    }
+
+    if (allocator == Allocator::Q_ibm) {
+        material << "trials " << options.trials << "\n";
+    }
+
+    if (allocator == Allocator::Q_bsi) {
+        material << "bsi " << options.maxChildren << " " << options.maxPartialSolutions << "\n";
+    }
+
+    if (statsFormat == StatsFormat::JSON) {
+        material << "stats json\n";
+    }
+
+    material << "include path ";
+    for (auto& includePath : IncludePath.getVal()) material << includePath << ",";
+
+    material << "\n" << program.size() << "\n" << program;
+
+    SHA256 sha;
+    sha.update(material.str());
+
+    std::set<std::string> including;
+    HashIncludes(program, path, including, sha);
+
+    return sha.finish();
+}
+
+CompilationCache::sRef CompilationCache::Create(std::string dir, uint64_t maxSize) {
+    if (!CreateDirectories(dir)) return nullptr;
+    return sRef(new CompilationCache(dir, maxSize));
+}
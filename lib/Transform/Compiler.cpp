@@ -0,0 +1,150 @@
+#include "enfield/Transform/Compiler.h"
+#include "enfield/Transform/FlattenPass.h"
+#include "enfield/Transform/InlineAllPass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/CanonicalCircuit.h"
+#include "enfield/Transform/SemanticVerifierPass.h"
+#include "enfield/Transform/ArchVerifierPass.h"
+#include "enfield/Transform/CNOTLBOWrapperPass.h"
+#include "enfield/Transform/ReverseEdgesPass.h"
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/Allocators/Allocators.h"
+#include "enfield/Support/Defs.h"
+#include "enfield/Support/Tracer.h"
+
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+using namespace efd;
+
+Compiler::Compiler(CompilationSettings settings, ArchCache::sRef cache)
+    : mSettings(settings), mCache(cache) {
+    if (mCache.get() == nullptr) {
+        mCache = ArchCache::Create(mSettings.archGraph);
+    }
+
+    assert(mCache->getArchGraph() == mSettings.archGraph &&
+           "Cache built for another architecture.");
+}
+
+const CompilationSettings& Compiler::getSettings() const {
+    return mSettings;
+}
+
+ArchCache::sRef Compiler::getArchCache() const {
+    return mCache;
+}
+
+bool Compiler::compile(QModule::Ref qmod) const {
+    TraceSpan span("compile");
+    bool success = true;
+    CanonicalCircuit::uRef snapshot;
+
+    PassCache::Run<FlattenPass>(qmod);
+
+    auto inlinePass = InlineAllPass::Create(mSettings.basis);
+    PassCache::Run(qmod, inlinePass.get());
+
+    // The verifier only needs a compact snapshot of the flattened and
+    // inlined program, instead of a clone of it. It is taken before the
+    // reordering, so that the reordering is verified as well.
+    if (mSettings.verify) {
+        TraceSpan snapshotSpan("CanonicalCircuit: snapshot");
+        snapshot = CanonicalCircuit::Create(qmod);
+    }
+
+    if (mSettings.reorder) {
+        auto orderPass = CNOTLBOWrapperPass::Create(mSettings.commute);
+        PassCache::Run(qmod, orderPass.get());
+    }
+
+    auto xbitPass = PassCache::Get<XbitToNumberWrapperPass>(qmod);
+    auto& xbitToNumber = xbitPass->getData();
+
+    // Only this module fails, so that the others (e.g.: in a batch) may
+    // still be compiled.
+    if (xbitToNumber.getQSize() > mSettings.archGraph->size()) {
+        ERR << "Using more qbits (" << xbitToNumber.getQSize()
+            << ") than the maximum permitted by the architecture ("
+            << mSettings.archGraph->size() << ")." << std::endl;
+        return false;
+    }
+
+    // The allocators need a path between every pair of physical qubits.
+    auto& distance = mCache->getDistance();
+
+    if (std::find(distance[0].begin(), distance[0].end(), _undef) != distance[0].end()) {
+        ERR << "The architecture graph is not connected." << std::endl;
+        return false;
+    }
+
+    // The allocators only handle gates with (at most) one dependency. The
+    // others may be left by the basis (e.g.: 'ccx').
+    auto depPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod);
+
+    for (auto& deps : depPass->getData().getDependencies()) {
+        if (deps.getSize() > 1) {
+            ERR << "Instructions with more than one dependency not supported ("
+                << deps.mCallPoint->toString(false) << ")." << std::endl;
+            return false;
+        }
+    }
+
+    // Each compilation has its own allocator. Only the cache is shared.
+    auto allocPass = CreateQbitAllocator(mSettings.allocator, mSettings.archGraph,
+                                         mSettings.allocatorOptions);
+    allocPass->setArchCache(mCache);
+    allocPass->setDontInline();
+    allocPass->setCommute(mSettings.commute);
+    PassCache::Run(qmod, allocPass.get());
+
+    auto revPass = ReverseEdgesPass::Create(mSettings.archGraph);
+    PassCache::Run(qmod, revPass.get());
+
+    if (mSettings.verify) {
+        auto mapping = allocPass->getData().mInitial;
+
+        auto aVerifierPass = ArchVerifierPass::Create(mSettings.archGraph);
+        aVerifierPass->setThreads(mSettings.verifyThreads);
+        auto sVerifierPass = SemanticVerifierPass::Create(std::move(snapshot), mapping,
+                                                          mSettings.commute);
+
+        PassCache::Run(qmod, aVerifierPass.get());
+        success = success && aVerifierPass->getData();
+
+        PassCache::Run(qmod, sVerifierPass.get());
+        success = success && sVerifierPass->getData();
+
+        if (!aVerifierPass->getData()) {
+            ERR << "Architecture restrictions violated in compiled code." << std::endl;
+        }
+
+        if (!sVerifierPass->getData()) {
+            ERR << "Compiled code is semantically different from source code." << std::endl;
+        }
+
+        if (!success) ERR << "Compilation failed." << std::endl;
+    }
+
+    if (!success && mSettings.force) {
+        WAR << "Printing incorrect QModule." << std::endl;
+        return true;
+    }
+
+    return success;
+}
+
+std::string Compiler::compile(const std::string& program) const {
+    auto qmod = QModule::ParseString(program);
+    if (qmod.get() == nullptr || !compile(qmod.get())) return "";
+
+    std::ostringstream ss;
+    PrintToStream(qmod.get(), ss);
+    return ss.str();
+}
+
+Compiler::uRef Compiler::Create(CompilationSettings settings, ArchCache::sRef cache) {
+    return uRef(new Compiler(settings, cache));
+}
@@ -39,13 +39,95 @@ efd::Dependencies::ConstIterator efd::Dependencies::end() const {
     return mDeps.end();
 }
 
+// --------------------- DepsSpan ------------------------
+const efd::Dep& efd::DepsSpan::operator[](uint32_t i) const {
+    assert(mBegin + i < mEnd && "Dependency index out of bounds.");
+    return mBegin[i];
+}
+
+bool efd::DepsSpan::isEmpty() const {
+    return mBegin == mEnd;
+}
+
+uint32_t efd::DepsSpan::getSize() const {
+    return mEnd - mBegin;
+}
+
+efd::DepsSpan::ConstIterator efd::DepsSpan::begin() const {
+    return mBegin;
+}
+
+efd::DepsSpan::ConstIterator efd::DepsSpan::end() const {
+    return mEnd;
+}
+
+// --------------------- DepsSet ------------------------
+efd::DepsSet::ConstIterator::ConstIterator(const DepsSet* set, uint32_t i)
+    : mSet(set), mI(i) {
+}
+
+const efd::DepsSpan& efd::DepsSet::ConstIterator::operator*() {
+    mSpan = (*mSet)[mI];
+    return mSpan;
+}
+
+const efd::DepsSpan* efd::DepsSet::ConstIterator::operator->() {
+    return &**this;
+}
+
+efd::DepsSet::ConstIterator& efd::DepsSet::ConstIterator::operator++() {
+    ++mI;
+    return *this;
+}
+
+bool efd::DepsSet::ConstIterator::operator==(const ConstIterator& rhs) const {
+    return mSet == rhs.mSet && mI == rhs.mI;
+}
+
+bool efd::DepsSet::ConstIterator::operator!=(const ConstIterator& rhs) const {
+    return !(*this == rhs);
+}
+
+uint32_t efd::DepsSet::size() const {
+    return mEntries.size();
+}
+
+bool efd::DepsSet::empty() const {
+    return mEntries.empty();
+}
+
+efd::DepsSpan efd::DepsSet::operator[](uint32_t i) const {
+    assert(i < mEntries.size() && "DepsSet index out of bounds.");
+    auto& entry = mEntries[i];
+    const Dep* begin = mDeps.data() + entry.mOffset;
+    return DepsSpan { begin, begin + entry.mSize, entry.mCallPoint };
+}
+
+void efd::DepsSet::push_back(const Dependencies& deps) {
+    mEntries.push_back(Entry { (uint32_t) mDeps.size(), deps.getSize(), deps.mCallPoint });
+    mDeps.insert(mDeps.end(), deps.begin(), deps.end());
+}
+
+void efd::DepsSet::clear() {
+    mDeps.clear();
+    mEntries.clear();
+}
+
+efd::DepsSet::ConstIterator efd::DepsSet::begin() const {
+    return ConstIterator(this, 0);
+}
+
+efd::DepsSet::ConstIterator efd::DepsSet::end() const {
+    return ConstIterator(this, mEntries.size());
+}
+
 // --------------------- DependencyBuilder ------------------------
 efd::DependencyBuilder::DependencyBuilder() {
 }
 
 uint32_t efd::DependencyBuilder::getUId(Node::Ref ref, NDGateDecl::Ref gate) {
     std::string _id = ref->toString();
-    return mXbitToNumber.getQUId(_id, gate);
+    return mXbitToNumber->getQUId(_id, gate);
 }
 
 const efd::DependencyBuilder::DepsSet* efd::DependencyBuilder::getDepsSet
@@ -67,11 +149,11 @@ efd::DependencyBuilder::DepsSet* efd::DependencyBuilder::getDepsSet
             (this)->getDepsSet(gate));
 }
 
-efd::XbitToNumber& efd::DependencyBuilder::getXbitToNumber() {
-    return mXbitToNumber;
+const efd::XbitToNumber& efd::DependencyBuilder::getXbitToNumber() const {
+    return *mXbitToNumber;
 }
 
-void efd::DependencyBuilder::setXbitToNumber(efd::XbitToNumber& xtn) {
+void efd::DependencyBuilder::setXbitToNumber(XbitToNumberWrapperPass::DataSnapshot xtn) {
     mXbitToNumber = xtn;
 }
 
@@ -86,15 +168,22 @@ efd::DependencyBuilder::DepsSet& efd::DependencyBuilder::getDependencies
     return *getDepsSet(ref);
 }
 
-const efd::Dependencies efd::DependencyBuilder::getDeps(Node* ref) const {
-    assert(mIDeps.find(ref) != mIDeps.end() && "Instruction never seen before.");
-    return mIDeps.at(ref);
+void efd::DependencyBuilder::setDeps(Node* ref, const Dependencies& deps) {
+    assert(mIOrdinal.find(ref) == mIOrdinal.end() && "Instruction seen twice.");
+    mIOrdinal[ref] = mIDeps.size();
+    mIDeps.push_back(deps);
 }
 
-efd::Dependencies efd::DependencyBuilder::getDeps(Node* ref) {
-    if (mIDeps.find(ref) == mIDeps.end())
-        mIDeps[ref] = { {}, ref };
-    return mIDeps.at(ref);
+efd::DepsSpan efd::DependencyBuilder::getDeps(Node* ref) const {
+    auto it = mIOrdinal.find(ref);
+    assert(it != mIOrdinal.end() && "Instruction never seen before.");
+    return mIDeps[it->second];
+}
+
+efd::DepsSpan efd::DependencyBuilder::getDeps(Node* ref) {
+    auto it = mIOrdinal.find(ref);
+    if (it == mIOrdinal.end()) return DepsSpan { nullptr, nullptr, ref };
+    return mIDeps[it->second];
 }
 
 // --------------------- DependencyBuilderWrapperPass ------------------------
@@ -106,6 +195,9 @@ namespace efd {
             QModule& mMod;
             DependencyBuilder& mDepBuilder;
 
+            // Reused for every instruction, so that it does not allocate each time.
+            Dependencies mCurrent;
+
             /// \brief Gets a reference to the parent gate it is in. If it is not
             /// in any gate, it returns a nullptr.
             NDGateDecl::Ref getParentGate(Node::Ref ref);
@@ -153,10 +245,11 @@ void efd::DependencyBuilderVisitor::visit(NDQOpCX::Ref ref) {
     uint32_t controlQ = mDepBuilder.getUId(ref->getLhs(), gate);
     uint32_t invertQ = mDepBuilder.getUId(ref->getRhs(), gate);
 
-    Dependencies depV { { Dep { controlQ, invertQ } }, ref };
+    mCurrent.mDeps.assign(1, Dep { controlQ, invertQ });
+    mCurrent.mCallPoint = ref;
 
-    deps->push_back(depV);
-    mDepBuilder.mIDeps[ref] = depV;
+    deps->push_back(mCurrent);
+    mDepBuilder.setDeps(ref, mCurrent);
 }
 
 void efd::DependencyBuilderVisitor::visit(NDQOpGen::Ref ref) {
@@ -177,24 +270,25 @@ void efd::DependencyBuilderVisitor::visit(NDQOpGen::Ref ref) {
     assert(gRef != nullptr && "There is no quantum gate with this id.");
 
     auto& gDeps = mDepBuilder.mLDeps[gRef];
-    Dependencies thisDeps { {}, ref };
+    mCurrent.mDeps.clear();
+    mCurrent.mCallPoint = ref;
     // For every qarg uint32_t representation
-    for (auto parallelDeps : gDeps) {
-        for (auto dep : parallelDeps) {
+    for (auto& parallelDeps : gDeps) {
+        for (auto& dep : parallelDeps) {
             // Getting the uid's of the qubit interaction (u, v)
             uint32_t u = uidVector[dep.mFrom];
             uint32_t v = uidVector[dep.mTo];
-            thisDeps.mDeps.push_back(Dep { u, v });
+            mCurrent.mDeps.push_back(Dep { u, v });
         }
     }
 
-    if (!thisDeps.isEmpty())
-        deps->push_back(thisDeps);
-    mDepBuilder.mIDeps[ref] = thisDeps;
+    if (!mCurrent.isEmpty())
+        deps->push_back(mCurrent);
+    mDepBuilder.setDeps(ref, mCurrent);
 }
 
 void efd::DependencyBuilderVisitor::visit(NDIfStmt::Ref ref) {
-    mDepBuilder.mIDeps[ref] = Dependencies();
+    mDepBuilder.setDeps(ref, Dependencies { {}, ref });
     visitChildren(ref);
 }
 
@@ -206,10 +300,9 @@ bool efd::DependencyBuilderWrapperPass::run(QModule::Ref qmod) {
     mData.mLDeps.clear();
     mData.mGDeps.clear();
     mData.mIDeps.clear();
+    mData.mIOrdinal.clear();
 
-    auto xtn = PassCache::Get<XbitToNumberWrapperPass>(qmod);
-    auto data = xtn->getData();
-    mData.setXbitToNumber(data);
+    mData.setXbitToNumber(PassCache::GetData<XbitToNumberWrapperPass>(qmod));
 
     DependencyBuilderVisitor visitor(*qmod, mData);
     for (auto it = qmod->gates_begin(), e = qmod->gates_end(); it != e; ++it) {
@@ -223,6 +316,10 @@ bool efd::DependencyBuilderWrapperPass::run(QModule::Ref qmod) {
     return false;
 }
 
+std::vector<uint8_t*> efd::DependencyBuilderWrapperPass::getDependencies() const {
+    return { &XbitToNumberWrapperPass::ID };
+}
+
 efd::DependencyBuilderWrapperPass::uRef efd::DependencyBuilderWrapperPass::Create() {
     return uRef(new DependencyBuilderWrapperPass());
 }
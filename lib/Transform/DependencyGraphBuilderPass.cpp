@@ -6,16 +6,20 @@ using namespace efd;
 
 uint8_t DependencyGraphBuilderPass::ID = 0;
 
+std::vector<uint8_t*> DependencyGraphBuilderPass::getDependencies() const {
+    return { &DependencyBuilderWrapperPass::ID };
+}
+
 DependencyGraphBuilderPass::uRef DependencyGraphBuilderPass::Create() {
     return uRef(new DependencyGraphBuilderPass());
 }
 
 bool DependencyGraphBuilderPass::run(QModule* qmod) {
     auto depbuilderPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod);
-    auto depbuilder = depbuilderPass->getData();
+    auto& depbuilder = depbuilderPass->getData();
     auto& dependencies = depbuilder.getDependencies();
 
-    uint32_t qubits = depbuilder.mXbitToNumber.getQSize();
+    uint32_t qubits = depbuilder.getXbitToNumber().getQSize();
     mData.reset(DependencyGraph::Create(qubits, Graph::Directed).release());
 
     for (auto& ideps : dependencies) {
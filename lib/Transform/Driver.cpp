@@ -1,15 +1,12 @@
 #include "enfield/Transform/Driver.h"
+#include "enfield/Transform/Compiler.h"
 #include "enfield/Transform/FlattenPass.h"
-#include "enfield/Transform/XbitToNumberPass.h"
-#include "enfield/Transform/SemanticVerifierPass.h"
-#include "enfield/Transform/ArchVerifierPass.h"
-#include "enfield/Transform/CNOTLBOWrapperPass.h"
-#include "enfield/Transform/ReverseEdgesPass.h"
+#include "enfield/Transform/InlineAllPass.h"
 #include "enfield/Transform/PassCache.h"
-#include "enfield/Transform/Allocators/Allocators.h"
 #include "enfield/Transform/DependencyGraphBuilderPass.h"
 #include "enfield/Arch/Architectures.h"
 #include "enfield/Support/Stats.h"
+#include "enfield/Support/Tracer.h"
 #include "enfield/Support/Defs.h"
 
 using namespace efd;
@@ -21,86 +18,70 @@ static Stat<uint32_t> StatNofVertices
 static Stat<double> StatDepGraphDensity
 ("DGDensity", "Density of the dependency graph.");
 
-QModule::uRef efd::Compile(QModule::uRef qmod, CompilationSettings settings) {
-    bool success = true;
-    QModule::uRef qmodCopy;
+const std::vector<std::string> efd::DefaultBasis {
+    "intrinsic_swap__",
+    "intrinsic_rev_cx__",
+    "intrinsic_lcx__",
+    "cx",
+    "u1",
+    "u2",
+    "u3",
+    "h"
+};
 
-    if (settings.verify) {
-        qmodCopy = qmod->clone();
-    }
+QModule::uRef efd::Compile(QModule::uRef qmod, CompilationSettings settings) {
+    Compiler compiler(settings);
+    if (!compiler.compile(qmod.get())) qmod.reset(nullptr);
+    return qmod;
+}
 
-    PassCache::Run<FlattenPass>(qmod.get());
+// Spliting filepath into 'filename' and 'path'.
+static void SplitFilepath(std::string filepath, std::string& filename, std::string& path) {
+    auto lastslash = filepath.find_last_of('/');
 
-    if (settings.reorder) {
-        PassCache::Run<CNOTLBOWrapperPass>(qmod.get());
+    if (lastslash != std::string::npos) {
+        path = filepath.substr(0, lastslash + 1);
+        filename = filepath.substr(lastslash + 1, std::string::npos);
+    } else {
+        path = "./";
+        filename = filepath;
     }
+}
 
-    auto xbitPass = PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
-    auto xbitToNumber = xbitPass->getData(); 
-
-    assert(xbitToNumber.getQSize() <= settings.archGraph->size() &&
-            "Using more qbits than the maximum permitted by the architecture.");
-
-    auto allocPass = CreateQbitAllocator(settings.allocator, settings.archGraph);
-    allocPass->setInlineAll(settings.basis);
-    PassCache::Run(qmod.get(), allocPass.get());
-
-    auto revPass = ReverseEdgesPass::Create(settings.archGraph);
-    PassCache::Run(qmod.get(), revPass.get());
-
-    if (settings.verify) {
-        auto mapping = allocPass->getData().mInitial;
-
-        auto aVerifierPass = ArchVerifierPass::Create(settings.archGraph);
-        auto sVerifierPass = SemanticVerifierPass::Create(std::move(qmodCopy), mapping);
-        sVerifierPass->setInlineAll(settings.basis);
-
-        PassCache::Run(qmod.get(), aVerifierPass.get());
-        success = success && aVerifierPass->getData();
-
-        PassCache::Run(qmod.get(), sVerifierPass.get());
-        success = success && sVerifierPass->getData();
-
-        if (!aVerifierPass->getData()) {
-            ERR << "Architecture restrictions violated in compiled code." << std::endl;
-        }
-
-        if (!sVerifierPass->getData()) {
-            ERR << "Compiled code is semantically different from source code." << std::endl;
-        }
+QModule::uRef efd::ParseFile(std::string filepath, uint32_t threads) {
+    QModule::uRef qmod(nullptr);
+    std::string path;
+    std::string filename;
 
-        if (!success) ERR << "Compilation failed." << std::endl;
+    if (filepath != "") {
+        SplitFilepath(filepath, filename, path);
+        qmod.reset(QModule::Parse(filename, path, threads).release());
     }
 
-    if (!success && !settings.force) qmod.reset(nullptr);
-    else if (!success && settings.force) WAR << "Printing incorrect QModule." << std::endl;
     return qmod;
 }
 
-QModule::uRef efd::ParseFile(std::string filepath) {
-    QModule::uRef qmod(nullptr);
+QModule::uRef efd::ProcessFileInChunks(std::string filepath, uint32_t chunkSize,
+        std::vector<std::string> basis, QModule::ChunkConsumer consumer) {
     std::string path;
     std::string filename;
 
-    if (filepath != "") {
-        // Spliting filepath into 'filename' and 'path'.
-        auto lastslash = filepath.find_last_of('/');
-
-        if (lastslash != std::string::npos) {
-            path = filepath.substr(0, lastslash + 1);
-            filename = filepath.substr(lastslash + 1, std::string::npos);
-        } else {
-            path = "./";
-            filename = filepath;
-        }
-
-        qmod.reset(QModule::Parse(filename, path).release());
-    }
+    if (filepath == "") return QModule::uRef(nullptr);
+    SplitFilepath(filepath, filename, path);
 
-    return qmod;
+    return QModule::ParseInChunks(filename, path, chunkSize, [&](QModule::Ref qmod) {
+        auto flattenPass = FlattenPass::Create();
+        PassCache::Run(qmod, flattenPass.get());
+
+        auto inlinePass = InlineAllPass::Create(basis);
+        PassCache::Run(qmod, inlinePass.get());
+
+        consumer(qmod);
+    });
 }
 
 void efd::PrintToStream(QModule::Ref qmod, std::ostream& o, bool pretty) {
+    TraceSpan span("print");
     qmod->print(o, pretty);
 }
 
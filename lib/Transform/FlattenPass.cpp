@@ -117,6 +117,10 @@ bool efd::FlattenPass::run(QModule::Ref qmod) {
     return true;
 }
 
+efd::PreservedAnalyses efd::FlattenPass::getPreserved() const {
+    return PreservedAnalyses::StatementsOnly();
+}
+
 FlattenPass::uRef efd::FlattenPass::Create() {
     return uRef(new FlattenPass());
 }
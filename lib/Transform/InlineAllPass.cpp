@@ -59,6 +59,10 @@ bool efd::InlineAllPass::run(QModule::Ref qmod) {
     return changed;
 }
 
+efd::PreservedAnalyses efd::InlineAllPass::getPreserved() const {
+    return PreservedAnalyses::StatementsOnly();
+}
+
 efd::InlineAllPass::uRef efd::InlineAllPass::Create(std::vector<std::string> basis) {
     return uRef(new InlineAllPass(basis));
 }
@@ -1,7 +1,12 @@
 #include "enfield/Transform/LayerBasedOrderingWrapperPass.h"
+#include "enfield/Transform/CommutationDAGBuilderPass.h"
 #include "enfield/Transform/PassCache.h"
 #include <cassert>
 
+efd::LayerBasedOrderingWrapperPass::LayerBasedOrderingWrapperPass(bool commute)
+    : mCommute(commute) {
+}
+
 uint32_t efd::LayerBasedOrderingWrapperPass::getNodeId(Node::Ref ref) {
     assert(mStmtId.find(ref) != mStmtId.end() && "Unknown node.");
     return mStmtId[ref];
@@ -14,9 +19,19 @@ bool efd::LayerBasedOrderingWrapperPass::run(QModule* qmod) {
         mStmtId.insert(std::make_pair(it->get(), mStmtId.size()));
     }
 
+    const CommutationDAG* dag = nullptr;
+
+    if (mCommute) {
+        dag = &PassCache::Get<CommutationDAGBuilderPass>(qmod)->getData();
+    }
+
     auto cgbpass = PassCache::Get<CircuitGraphBuilderPass>(qmod);
-    mData.ordering = generate(cgbpass->getData());
+    mData.ordering = generate(cgbpass->getData(), dag);
     qmod->orderby(mData.ordering);
 
     return true;
 }
+
+efd::PreservedAnalyses efd::LayerBasedOrderingWrapperPass::getPreserved() const {
+    return PreservedAnalyses::StatementsOnly();
+}
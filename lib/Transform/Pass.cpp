@@ -1,4 +1,23 @@
 #include "enfield/Transform/Pass.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+
+void efd::PreservedAnalyses::preserve(uint8_t* id) {
+    mIDs.insert(id);
+}
+
+bool efd::PreservedAnalyses::isPreserved(uint8_t* id) const {
+    return mIDs.find(id) != mIDs.end();
+}
+
+efd::PreservedAnalyses efd::PreservedAnalyses::None() {
+    return PreservedAnalyses();
+}
+
+efd::PreservedAnalyses efd::PreservedAnalyses::StatementsOnly() {
+    PreservedAnalyses preserved;
+    preserved.preserve<XbitToNumberWrapperPass>();
+    return preserved;
+}
 
 efd::Pass::Pass(Kind k) : mK(k) {
 }
@@ -7,6 +26,14 @@ efd::Pass::Kind efd::Pass::getKind() const {
     return mK;
 }
 
+efd::PreservedAnalyses efd::Pass::getPreserved() const {
+    return PreservedAnalyses::None();
+}
+
+std::vector<uint8_t*> efd::Pass::getDependencies() const {
+    return std::vector<uint8_t*>();
+}
+
 efd::PassT<void>::PassT() : Pass(K_VOID) {
 }
 
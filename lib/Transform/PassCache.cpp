@@ -1,4 +0,0 @@
-#include "enfield/Transform/PassCache.h"
-
-// Initializing static member.
-efd::PassCache::QModPassesMap efd::PassCache::mPasses;
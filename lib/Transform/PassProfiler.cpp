@@ -0,0 +1,204 @@
+#include "enfield/Transform/PassProfiler.h"
+#include "enfield/Support/AllocationCounter.h"
+#include "enfield/Support/Tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <typeindex>
+
+#include <cxxabi.h>
+#include <time.h>
+
+using namespace efd;
+
+namespace {
+    /// \brief A pass being run by this thread.
+    struct Frame {
+        double mChildWallTime;
+        double mChildCPUTime;
+        uint64_t mChildBytes;
+        uint64_t mChildAllocations;
+    };
+}
+
+static std::atomic<bool> Enabled(false);
+static std::mutex RecordsMutex;
+static std::map<std::type_index, PassProfiler::Record> Records;
+static std::map<std::type_index, std::string> Names;
+static thread_local std::vector<Frame> Frames;
+
+static double GetWallTime() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::duration<double>>(now).count();
+}
+
+static double GetCPUTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static std::string Demangle(const char* mangled) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+
+    std::string name = (status == 0) ? demangled : mangled;
+    std::free(demangled);
+
+    if (name.compare(0, 5, "efd::") == 0) name = name.substr(5);
+    return name;
+}
+
+// Returns the (demangled) name of the class of 'pass' (lock must be held).
+static const std::string& GetName(Pass::Ref pass) {
+    std::type_index type(typeid(*pass));
+    auto it = Names.find(type);
+
+    if (it == Names.end()) {
+        it = Names.insert(std::make_pair(type, Demangle(type.name()))).first;
+    }
+
+    return it->second;
+}
+
+// Returns the record of 'pass' (lock must be held).
+static PassProfiler::Record& GetRecord(Pass::Ref pass) {
+    std::type_index type(typeid(*pass));
+    auto it = Records.find(type);
+
+    if (it == Records.end()) {
+        it = Records.insert(std::make_pair(type,
+                    PassProfiler::Record { GetName(pass), 0, 0, 0, 0, 0, 0 })).first;
+    }
+
+    return it->second;
+}
+
+void PassProfiler::Enable(bool enable) {
+    Enabled.store(enable);
+}
+
+bool PassProfiler::IsEnabled() {
+    return Enabled.load(std::memory_order_relaxed);
+}
+
+std::string PassProfiler::GetPassName(Pass::Ref pass) {
+    std::lock_guard<std::mutex> lock(RecordsMutex);
+    return GetName(pass);
+}
+
+bool PassProfiler::Run(Pass::Ref pass, QModule* qmod) {
+    bool profile = IsEnabled(), trace = Tracer::IsEnabled();
+    if (!profile && !trace) return pass->run(qmod);
+
+    TraceSpan span(trace ? GetPassName(pass) : std::string());
+    if (!profile) return pass->run(qmod);
+
+    auto allocStart = AllocationCounter::Get();
+    double wallStart = GetWallTime();
+    double cpuStart = GetCPUTime();
+
+    Frames.push_back(Frame { 0, 0, 0, 0 });
+    bool changed = pass->run(qmod);
+    Frame frame = Frames.back();
+    Frames.pop_back();
+
+    double wall = GetWallTime() - wallStart;
+    double cpu = GetCPUTime() - cpuStart;
+    auto allocEnd = AllocationCounter::Get();
+    uint64_t bytes = allocEnd.mBytes - allocStart.mBytes;
+    uint64_t allocations = allocEnd.mAllocations - allocStart.mAllocations;
+
+    if (!Frames.empty()) {
+        auto& parent = Frames.back();
+        parent.mChildWallTime += wall;
+        parent.mChildCPUTime += cpu;
+        parent.mChildBytes += bytes;
+        parent.mChildAllocations += allocations;
+    }
+
+    std::lock_guard<std::mutex> lock(RecordsMutex);
+    auto& record = GetRecord(pass);
+    ++record.mRuns;
+    record.mWallTime += wall - frame.mChildWallTime;
+    record.mCPUTime += cpu - frame.mChildCPUTime;
+    record.mBytes += bytes - frame.mChildBytes;
+    record.mAllocations += allocations - frame.mChildAllocations;
+
+    return changed;
+}
+
+void PassProfiler::RecordHit(Pass::Ref pass) {
+    if (!IsEnabled()) return;
+
+    std::lock_guard<std::mutex> lock(RecordsMutex);
+    ++GetRecord(pass).mHits;
+}
+
+std::vector<PassProfiler::Record> PassProfiler::GetRecords() {
+    std::vector<Record> records;
+
+    {
+        std::lock_guard<std::mutex> lock(RecordsMutex);
+        for (auto& pair : Records) records.push_back(pair.second);
+    }
+
+    std::sort(records.begin(), records.end(), [](const Record& lhs, const Record& rhs) {
+        if (lhs.mWallTime != rhs.mWallTime) return lhs.mWallTime > rhs.mWallTime;
+        return lhs.mName < rhs.mName;
+    });
+
+    return records;
+}
+
+void PassProfiler::Clear() {
+    std::lock_guard<std::mutex> lock(RecordsMutex);
+    Records.clear();
+}
+
+void PassProfiler::Print(std::ostream& out) {
+    auto records = GetRecords();
+
+    double totalWall = 0, totalCPU = 0;
+    for (auto& record : records) {
+        totalWall += record.mWallTime;
+        totalCPU += record.mCPUTime;
+    }
+
+    bool hooked = AllocationCounter::IsHooked();
+    char line[512];
+
+    out << std::endl;
+    out << " ==----------- Pass Timing -----------==" << std::endl;
+    snprintf(line, sizeof(line), "  Total: %.4f seconds (%.4f wall clock)", totalCPU, totalWall);
+    out << line << std::endl << std::endl;
+
+    snprintf(line, sizeof(line), "  %-17s  %-17s  %8s  %8s  %12s  %10s  %s",
+             "---CPU Time---", "---Wall Time---", "Runs", "Hits", "Bytes", "Allocs", "--- Name ---");
+    out << line << std::endl;
+
+    for (auto& record : records) {
+        double cpuPct = (totalCPU > 0) ? record.mCPUTime / totalCPU * 100 : 0;
+        double wallPct = (totalWall > 0) ? record.mWallTime / totalWall * 100 : 0;
+
+        std::string bytes = "-", allocations = "-";
+
+        if (hooked) {
+            bytes = std::to_string(record.mBytes);
+            allocations = std::to_string(record.mAllocations);
+        }
+
+        snprintf(line, sizeof(line), "  %8.4f (%5.1f%%)  %8.4f (%5.1f%%)  %8llu  %8llu  %12s  %10s  %s",
+                 record.mCPUTime, cpuPct, record.mWallTime, wallPct,
+                 (unsigned long long) record.mRuns, (unsigned long long) record.mHits,
+                 bytes.c_str(), allocations.c_str(), record.mName.c_str());
+        out << line << std::endl;
+    }
+
+    out << " ==-----------------------------------==" << std::endl;
+}
@@ -4,6 +4,7 @@
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
+#include "enfield/Support/Tracer.h"
 
 #include <cassert>
 #include <unordered_set>
@@ -11,10 +12,10 @@
 
 efd::QModule::QModule() : mVersion(nullptr) {
     mStatements = NDStmtList::Create();
+    mAnalysisManager = AnalysisManager::Create(this);
 }
 
 efd::QModule::~QModule() {
-    PassCache::Clear(this);
 }
 
 efd::NDQasmVersion::Ref efd::QModule::getVersion() {
@@ -124,6 +125,14 @@ efd::Node::Ref efd::QModule::getStatement(uint32_t i) {
 }
 
 void efd::QModule::insertGate(NDGateSign::uRef gate) {
+    insertGateImpl(NDGateSign::sRef(gate.release()), false);
+}
+
+void efd::QModule::insertGate(NDGateSign::sRef gate) {
+    insertGateImpl(gate, true);
+}
+
+void efd::QModule::insertGateImpl(NDGateSign::sRef gate, bool isShared) {
     assert(gate.get() != nullptr && "Trying to insert a 'nullptr' gate.");
     assert(gate->getId() != nullptr && "Trying to insert a gate with 'nullptr' id.");
 
@@ -134,6 +143,7 @@ void efd::QModule::insertGate(NDGateSign::uRef gate) {
 
         for (auto it = mGates.begin(), end = mGates.end(); it != end; ++it) {
             if ((*it)->getId()->getVal() == id) {
+                mSharedGates.erase(*it);
                 mGates.erase(it);
                 break;
             }
@@ -142,8 +152,12 @@ void efd::QModule::insertGate(NDGateSign::uRef gate) {
         mGatesMap.erase(mGatesMap.find(id));
     }
 
-    mGatesMap[id] = std::move(gate);
-    mGates.push_back(mGatesMap[id].get());
+    mGatesMap[id] = gate;
+    mGates.push_back(gate.get());
+
+    if (isShared) {
+        mSharedGates.insert(gate.get());
+    }
 }
 
 uint32_t efd::QModule::getNumberOfRegs() const {
@@ -158,6 +172,14 @@ uint32_t efd::QModule::getNumberOfStmts() const {
     return mStatements->getChildNumber();
 }
 
+efd::QModule::IncludeConstIterator efd::QModule::include_begin() const {
+    return mIncludes.begin();
+}
+
+efd::QModule::IncludeConstIterator efd::QModule::include_end() const {
+    return mIncludes.end();
+}
+
 efd::QModule::RegIterator efd::QModule::reg_begin() {
     return mRegs.begin();
 }
@@ -311,6 +333,10 @@ bool efd::QModule::hasQGate(std::string id) const {
     return true;
 }
 
+efd::AnalysisManager& efd::QModule::getAnalysisManager() {
+    return *mAnalysisManager;
+}
+
 efd::QModule::uRef efd::QModule::clone() const {
     auto qmod = new QModule();
 
@@ -323,8 +349,13 @@ efd::QModule::uRef efd::QModule::clone() const {
     for (auto reg : mRegs)
         qmod->insertReg(uniqueCastForward<NDRegDecl>(reg->clone()));
 
-    for (auto gate : mGates)
-        qmod->insertGate(uniqueCastForward<NDGateSign>(gate->clone()));
+    for (auto gate : mGates) {
+        if (mSharedGates.find(gate) != mSharedGates.end()) {
+            qmod->insertGate(mGatesMap.at(gate->getId()->getVal()));
+        } else {
+            qmod->insertGate(uniqueCastForward<NDGateSign>(gate->clone()));
+        }
+    }
 
     qmod->mStatements = uniqueCastForward<NDStmtList>(mStatements->clone());
     return uRef(qmod);
@@ -343,7 +374,7 @@ efd::QModule::uRef efd::QModule::Create() {
 
 efd::QModule::uRef efd::QModule::GetFromAST(Node::uRef ref) {
     uRef qmod(new QModule());
-    efd::ProcessAST(qmod.get(), ref.get());
+    if (!efd::ProcessAST(qmod.get(), ref.get())) return uRef(nullptr);
 
     auto gates = efd::GetIntrinsicGates();
     for (auto& gate : gates)
@@ -352,8 +383,10 @@ efd::QModule::uRef efd::QModule::GetFromAST(Node::uRef ref) {
     return qmod;
 }
 
-efd::QModule::uRef efd::QModule::Parse(std::string filename, std::string path) {
-    auto ast = efd::ParseFile(filename, path, true);
+efd::QModule::uRef efd::QModule::Parse(std::string filename, std::string path,
+        uint32_t threads) {
+    TraceSpan span("parse");
+    auto ast = efd::ParseFileParallel(filename, path, threads, true);
 
     if (ast.get() != nullptr)
         return GetFromAST(std::move(ast));
@@ -362,6 +395,7 @@ efd::QModule::uRef efd::QModule::Parse(std::string filename, std::string path) {
 }
 
 efd::QModule::uRef efd::QModule::ParseString(std::string program) {
+    TraceSpan span("parse");
     auto ast = efd::ParseString(program, true);
 
     if (ast != nullptr)
@@ -369,3 +403,32 @@ efd::QModule::uRef efd::QModule::ParseString(std::string program) {
 
     return uRef(nullptr);
 }
+
+efd::QModule::uRef efd::QModule::ParseInChunks(std::string filename, std::string path,
+        uint32_t chunkSize, ChunkConsumer consumer) {
+    uRef qmod(new QModule());
+
+    // The intrinsic gates come first, since the chunks are processed
+    // before the end of the file.
+    auto gates = efd::GetIntrinsicGates();
+    for (auto& gate : gates)
+        qmod->insertGate(std::move(gate));
+
+    // After an invalid chunk, the others are still parsed (so that the syntax
+    // errors are reported), but not handed to 'consumer'.
+    bool valid = true;
+
+    auto ast = efd::ParseFileInChunks(filename, path, chunkSize,
+            [&](NDStmtList::uRef chunk) {
+                valid = valid && efd::ProcessAST(qmod.get(), chunk.get());
+                if (valid) consumer(qmod.get());
+
+                qmod->clearStatements();
+                PassCache::Clear(qmod.get());
+            });
+
+    if (ast.get() == nullptr || !valid || !efd::ProcessAST(qmod.get(), ast.get()))
+        return uRef(nullptr);
+
+    return qmod;
+}
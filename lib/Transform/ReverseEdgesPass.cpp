@@ -91,6 +91,10 @@ bool efd::ReverseEdgesPass::run(QModule::Ref qmod) {
     else return true;
 }
 
+efd::PreservedAnalyses efd::ReverseEdgesPass::getPreserved() const {
+    return PreservedAnalyses::StatementsOnly();
+}
+
 efd::ReverseEdgesPass::uRef efd::ReverseEdgesPass::Create(ArchGraph::sRef graph) {
     return uRef(new ReverseEdgesPass(graph));
 }
@@ -1,390 +1,256 @@
 #include "enfield/Transform/SemanticVerifierPass.h"
-#include "enfield/Transform/CircuitGraphBuilderPass.h"
-#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/CommutationDAGBuilderPass.h"
 #include "enfield/Transform/FlattenPass.h"
 #include "enfield/Transform/InlineAllPass.h"
 #include "enfield/Transform/PassCache.h"
-#include "enfield/Transform/Utils.h"
-#include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/Defs.h"
-#include "enfield/Support/RTTI.h"
 
-#include <unordered_map>
 #include <vector>
+#include <unordered_map>
 #include <cassert>
 #include <algorithm>
 
 using namespace efd;
 
 namespace {
-    struct SemanticCNOT {
-        uint32_t u, v;
-
-        bool operator==(const SemanticCNOT& rhs) {
-            return u == rhs.u && v == rhs.v;
-        }
-
-        bool operator!=(const SemanticCNOT& rhs) {
-            return !(*this == rhs);
+    struct KeyHash {
+        std::size_t operator()(const std::vector<uint32_t>& key) const {
+            std::size_t hash = key.size();
+            for (uint32_t x : key) hash ^= x + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            return hash;
         }
     };
 }
 
 namespace efd {
-    class SemanticVerifierVisitor : public NodeVisitor {
+    /// \brief Matches, one by one, the gates of the target program against the
+    /// ready gates of the source \em CanonicalCircuit.
+    class SemanticVerifier {
         private:
+            const CanonicalCircuit& mSrc;
+            const CircuitGraph& mCkt;
             uint32_t mQubitsSrc;
+            uint32_t mCbitsSrc;
             uint32_t mQubitsTgt;
-            uint32_t mXbitsSrc;
-            XbitToNumber& mXtoNSrc;
-            XbitToNumber& mXtoNTgt;
-            CircuitGraph::Iterator& mIt;
+            uint32_t mBarrier;
+            KahnScheduler mScheduler;
             Mapping mMap;
             Assign mAssign;
 
-            std::map<Node::Ref, uint32_t> mReached;
-            std::vector<bool> mMarked;
+            // The ready gates, by their key: the signature followed by the xbits.
+            // Gates with the same key are interchangeable. So, a target gate
+            // is matched by looking its key up, and taking any of them.
+            std::unordered_map<std::vector<uint32_t>, std::vector<uint32_t>, KeyHash> mReady;
+            std::vector<uint32_t> mNewReady;
+            std::vector<uint32_t> mKey;
 
-            inline uint32_t getTgtUId(uint32_t srcUId);
-            inline uint32_t getSrcUId(uint32_t tgtUId);
-            inline uint32_t getRealTgtCUId(uint32_t baseUId);
-            inline uint32_t getRealSrcCUId(uint32_t baseUId);
+            void addReady(const std::vector<uint32_t>& gates);
+            void emit(uint32_t gate);
 
-            void updatedReachedCktNodes();
-            void advanceCktNodes(std::vector<uint32_t> xbitsToUpdate);
-            void postprocessing(std::vector<uint32_t> xbitsToUpdate);
-            void visitNDQOp(NDQOp::Ref qop, NDIfStmt::Ref ifstmt = nullptr);
+            // Barriers are the only gates whose arguments may be in any order.
+            void sortBarrierKey();
+            bool swap(const CanonicalGate& gate);
 
         public:
-            SemanticVerifierVisitor(XbitToNumber& xtonsrc,
-                                    XbitToNumber& xtontgt,
-                                    CircuitGraph::Iterator& it,
-                                    Mapping initial);
-
-            void visit(NDQOpMeasure::Ref ref) override;
-            void visit(NDQOpReset::Ref ref) override;
-            void visit(NDQOpU::Ref ref) override;
-            void visit(NDQOpCX::Ref ref) override;
-            void visit(NDQOpBarrier::Ref ref) override;
-            void visit(NDQOpGen::Ref ref) override;
-            void visit(NDIfStmt::Ref ref) override;
-
-            bool mSuccess;
-    };
-}
+            SemanticVerifier(const CanonicalCircuit& src,
+                             const CommutationDAG* dag,
+                             uint32_t qubitsTgt,
+                             Mapping initial);
 
-SemanticVerifierVisitor::SemanticVerifierVisitor(XbitToNumber& xtonsrc,
-                                                 XbitToNumber& xtontgt,
-                                                 CircuitGraph::Iterator& iterator,
-                                                 Mapping initial) :
-    mQubitsSrc(xtonsrc.getQSize()),
-    mQubitsTgt(xtontgt.getQSize()),
-    mXbitsSrc(xtonsrc.getQSize() + xtonsrc.getCSize()),
-    mXtoNSrc(xtonsrc),
-    mXtoNTgt(xtontgt),
-    mIt(iterator),
-    mMap(initial),
-    mMarked(mXbitsSrc, false),
-    mSuccess(true) {
-    
-
-    mAssign.assign(mQubitsTgt, 0);
-    for (uint32_t i = 0; i < mQubitsTgt; ++i) {
-        mAssign[mMap[i]] = i;
-    }
-
-    for (uint32_t i = 0; i < mXbitsSrc; ++i) {
-        mIt.next(i);
-    }
+            /// \brief Matches (or swaps) the target \p gate.
+            bool match(const CanonicalGate& gate);
 
-    postprocessing({});
+            /// \brief True if every source gate was matched.
+            bool isDone() const;
+    };
 }
 
-uint32_t SemanticVerifierVisitor::getRealTgtCUId(uint32_t baseUId) {
-    return mQubitsTgt + baseUId;
-}
+SemanticVerifier::SemanticVerifier(const CanonicalCircuit& src,
+                                   const CommutationDAG* dag,
+                                   uint32_t qubitsTgt,
+                                   Mapping initial) :
+    mSrc(src),
+    mCkt(src.getGraph()),
+    mQubitsSrc(mCkt.getQSize()),
+    mCbitsSrc(mCkt.getCSize()),
+    mQubitsTgt(qubitsTgt),
+    mBarrier(src.getSignatureId("barrier")),
+    mScheduler(mCkt, dag),
+    mMap(initial) {
+
+    mMap.resize(mQubitsTgt, _undef);
+    mAssign.assign(mQubitsTgt, _undef);
 
-uint32_t SemanticVerifierVisitor::getRealSrcCUId(uint32_t baseUId) {
-    return mQubitsSrc + baseUId;
-}
-
-uint32_t SemanticVerifierVisitor::getTgtUId(uint32_t srcUId) {
-    if (srcUId < mQubitsSrc) return mMap[srcUId];
-    return (srcUId - mQubitsSrc) + mQubitsTgt;
-}
+    for (uint32_t i = 0; i < mQubitsTgt; ++i) {
+        if (mMap[i] < mQubitsTgt) mAssign[mMap[i]] = i;
+    }
 
-uint32_t SemanticVerifierVisitor::getSrcUId(uint32_t tgtUId) {
-    if (tgtUId < mQubitsTgt) return mAssign[tgtUId];
-    return (tgtUId - mQubitsTgt) + mQubitsSrc;
+    addReady(mScheduler.getInitialReady());
 }
 
-void SemanticVerifierVisitor::updatedReachedCktNodes() {
-    for (uint32_t i = 0; i < mXbitsSrc; ++i) {
-        auto circuitNode = mIt[i];
-        auto node = circuitNode->node();
-
-        if (circuitNode->isGateNode() && !mMarked[i]) {
-            mMarked[i] = true;
+void SemanticVerifier::addReady(const std::vector<uint32_t>& gates) {
+    for (uint32_t g : gates) {
+        mKey.assign(1, mSrc.getSignature(g));
 
-            if (mReached.find(node) == mReached.end())
-                mReached[node] = circuitNode->numberOfXbits();
-            --mReached[node];
+        for (uint32_t i = 0, e = mCkt.getNumberOfXbits(g); i < e; ++i) {
+            mKey.push_back(mCkt.getXbit(g, i));
         }
-    }
-}
 
-void SemanticVerifierVisitor::advanceCktNodes(std::vector<uint32_t> xbitsToUpdate) {
-    for (uint32_t x : xbitsToUpdate) {
-        mIt.next(x);
-        mMarked[x] = false;
+        sortBarrierKey();
+        mReady[mKey].push_back(g);
     }
 }
 
-void SemanticVerifierVisitor::postprocessing(std::vector<uint32_t> xbitsToUpdate) {
-    advanceCktNodes(xbitsToUpdate);
-    updatedReachedCktNodes();
+void SemanticVerifier::emit(uint32_t gate) {
+    mNewReady.clear();
+    mScheduler.emit(gate, mNewReady);
+    addReady(mNewReady);
 }
 
-void SemanticVerifierVisitor::visitNDQOp(NDQOp::Ref tgtQOp, NDIfStmt::Ref tgtIfStmt) {
-    // Checking all quantum arguments from the current node.
-    std::vector<uint32_t> tgtOpQubits;
-    std::vector<uint32_t> tgtOpCbits;
-
-    auto tgtQArgs = tgtQOp->getQArgs();
-    uint32_t tgtQArgsChildrem = tgtQArgs->getChildNumber();
-
-    for (uint32_t i = 0; i < tgtQArgsChildrem; ++i) {
-        auto qarg = tgtQArgs->getChild(i);
-        tgtOpQubits.push_back(mXtoNTgt.getQUId(qarg->toString(false)));
-    }
-
-    if (tgtIfStmt != nullptr) {
-        for (auto cbit : mXtoNTgt.getRegUIds(tgtIfStmt->getCondId()->getVal()))
-            tgtOpCbits.push_back(getRealTgtCUId(cbit));
-    }
-
-    // Checking all quantum arguments from the circuit node.
-    std::vector<uint32_t> srcOpQubits;
-    std::vector<uint32_t> srcOpCbits;
-
-    auto srcCNode = mIt[getSrcUId(tgtOpQubits[0])];
-
-    if (!srcCNode->isGateNode()) { mSuccess = false; return; }
-
-    auto srcNode = srcCNode->node();
-    NDQOp::Ref srcQOp = nullptr;
-
-    if (tgtIfStmt != nullptr && tgtIfStmt->getKind() == srcNode->getKind()) {
-        auto srcIfStmt = static_cast<NDIfStmt*>(srcNode);
-        srcQOp = srcIfStmt->getQOp();
-
-        for (auto cbit : mXtoNSrc.getRegUIds(srcIfStmt->getCondId()->getVal()))
-            srcOpCbits.push_back(getTgtUId(getRealSrcCUId(cbit)));
-
-    } else if (tgtIfStmt == nullptr) {
-        srcQOp = dynCast<NDQOp>(srcNode);
-    }
-
-    if (srcQOp == nullptr) {
-        // Either the current node \em tgtQOp is a NDIfStmt and the circuit one is not or
-        // the other way around.
-        mSuccess = false;
-        return;
-    }
-
-    auto srcQArgs = srcQOp->getQArgs();
-    uint32_t srcQArgsChildrem = srcQArgs->getChildNumber();
-
-    for (uint32_t i = 0; i < srcQArgsChildrem; ++i) {
-        uint32_t qubit = mXtoNSrc.getQUId(srcQArgs->getChild(i)->toString(false));
-        srcOpQubits.push_back(getTgtUId(qubit));
-    }
-
-    // All qubits involved in the current circuit node must also be involved in the current node.
-    for (uint32_t q : srcOpQubits) {
-        mSuccess = mSuccess &&
-            std::find(tgtOpQubits.begin(), tgtOpQubits.end(), q) != tgtOpQubits.end();
-    }
-
-    // All qubits and cbits have reached this node (and they are not null).
-    auto firstSrcCNode = mIt[getSrcUId(srcOpQubits[0])];
-    auto firstSrcNode = firstSrcCNode->node();
-    mSuccess = mSuccess && firstSrcCNode->isGateNode() && !mReached[firstSrcNode];
-
-    // All used qubits have reached the same node (there is no instruction that is dependent
-    // of others that is being executed before its dependencies) 
-    for (uint32_t i = 1; i < srcQArgsChildrem; ++i) {
-        mSuccess = mSuccess && mIt[getSrcUId(srcOpQubits[i])]->node() == firstSrcNode;
-    }
-
-    if (srcOpCbits.size() != tgtOpCbits.size())
-        mSuccess = false;
-
-    if (!mSuccess) return;
-
-    // If this operation deals with more than one qubit, we assume it deals with exactly two
-    // qubits, and that it is a CNOT gate.
-    if (srcOpQubits.size() > 1) {
-        if (IsCNOTGateCall(srcQOp)) {
-            // Both CNOTs and REV_CNOTS have the same semantic.
-            // The only difference is in the way they are implemented. 
-            SemanticCNOT srcCNOT { srcOpQubits[0], srcOpQubits[1] };
-            SemanticCNOT tgtCNOT { tgtOpQubits[0], tgtOpQubits[1] };
+void SemanticVerifier::sortBarrierKey() {
+    if (mKey[0] == mBarrier) std::sort(mKey.begin() + 1, mKey.end());
+}
 
-            if (!IsCNOTGateCall(tgtQOp)) {
-                auto tgtQOpGen = dynCast<NDQOpGen>(tgtQOp);
+bool SemanticVerifier::swap(const CanonicalGate& gate) {
+    uint32_t u = gate.mQubits[0], v = gate.mQubits[1];
+    if (u >= mQubitsTgt || v >= mQubitsTgt) return false;
 
-                // Checking for intrinsics.
-                if (tgtQOpGen && tgtQOpGen->isIntrinsic() &&
-                        tgtQOpGen->getIntrinsicKind() == NDQOpGen::K_INTRINSIC_LCX) {
-                        tgtCNOT.u = tgtOpQubits[0];
-                        tgtCNOT.v = tgtOpQubits[2];
-                }
-            }
+    uint32_t a = mAssign[u], b = mAssign[v];
 
-            // Check if, semanticaly, CNOTs are applied to the same qubits in the same order.
-            mSuccess = mSuccess && srcCNOT == tgtCNOT;
+    if (a != _undef) mMap[a] = v;
+    if (b != _undef) mMap[b] = u;
+    std::swap(mAssign[u], mAssign[v]);
+    return true;
+}
 
-        } else if (instanceOf<NDQOpBarrier>(srcQOp)) {
+bool SemanticVerifier::match(const CanonicalGate& gate) {
+    if (gate.mK == CanonicalGate::K_SWAP) return swap(gate);
 
-            auto src = dynCast<NDQOpBarrier>(srcQOp);
-            auto tgt = dynCast<NDQOpBarrier>(tgtQOp);
+    uint32_t signature = mSrc.getSignatureId(gate.mSignature);
+    if (signature == CanonicalCircuit::NoSignature) return false;
 
-            mSuccess = src->getQArgs()->getChildNumber() == tgt->getQArgs()->getChildNumber();
+    // Translating the xbits of the target back to the source ones (the same
+    // way the circuit graph does: qubits, then cbits, without repetition).
+    mKey.assign(1, signature);
 
-        } else {
-            assert(false && "Node is neither CNOT nor Barrier.");
-        }
+    for (uint32_t q : gate.mQubits) {
+        // Physical qubits that hold no source qubit.
+        if (q >= mQubitsTgt || mAssign[q] >= mQubitsSrc) return false;
 
-    } else {
-        if (tgtIfStmt != nullptr)
-            mSuccess = mSuccess && firstSrcCNode->node()->getKind() == tgtIfStmt->getKind();
-        else
-            mSuccess = mSuccess && firstSrcCNode->node()->getKind() == tgtQOp->getKind();
-
-        // Checking all real arguments.
-        auto tgtArgs = tgtQOp->getArgs();
-        auto srcArgs = srcQOp->getArgs();
-        mSuccess = mSuccess && tgtArgs->equals(srcArgs);
+        uint32_t x = mAssign[q];
+        if (std::find(mKey.begin() + 1, mKey.end(), x) == mKey.end()) mKey.push_back(x);
     }
 
-    if (mSuccess) {
-        std::vector<uint32_t> all;
-        std::vector<uint32_t> toBeAdvanced;
-
-        all.insert(all.begin(), srcOpQubits.begin(), srcOpQubits.end());
-        all.insert(all.begin(), srcOpCbits.begin(), srcOpCbits.end());
+    for (uint32_t c : gate.mCbits) {
+        if (c >= mCbitsSrc) return false;
 
-        for (auto q : all) {
-            toBeAdvanced.push_back(getSrcUId(q));
-        }
-
-        postprocessing(toBeAdvanced);
+        uint32_t x = mQubitsSrc + c;
+        if (std::find(mKey.begin() + 1, mKey.end(), x) == mKey.end()) mKey.push_back(x);
     }
-}
-
-void SemanticVerifierVisitor::visit(NDQOpMeasure::Ref ref) {
-    uint32_t tgtQUId = mXtoNTgt.getQUId(ref->getQBit()->toString(false));
-    uint32_t tgtCUId = getRealTgtCUId(mXtoNTgt.getCUId(ref->getCBit()->toString(false)));
-
-    auto srcCNode = mIt[getSrcUId(tgtQUId)];
-    auto srcNode = dynCast<NDQOpMeasure>(srcCNode->node());
 
-    if (srcNode != nullptr) {
-        uint32_t srcQUId = mXtoNSrc.getQUId(srcNode->getQBit()->toString(false));
-        uint32_t srcCUId = getRealSrcCUId(mXtoNSrc.getCUId(srcNode->getCBit()->toString(false)));
+    if (mKey.size() == 1) return false;
+    sortBarrierKey();
 
-        mSuccess = mSuccess && tgtQUId == getTgtUId(srcQUId);
-        mSuccess = mSuccess && tgtCUId == getTgtUId(srcCUId);
+    auto it = mReady.find(mKey);
+    if (it == mReady.end()) return false;
 
-        mSuccess = mSuccess && srcCNode->isGateNode();
-        mSuccess = mSuccess && !mReached[srcNode];
-        mSuccess = mSuccess && mIt[srcQUId]->node() == mIt[srcCUId]->node();
-        mSuccess = mSuccess && srcNode->getKind() == ref->getKind();
+    uint32_t g = it->second.back();
+    it->second.pop_back();
+    if (it->second.empty()) mReady.erase(it);
 
-        if (mSuccess) postprocessing({ srcQUId, srcCUId });
-    }
-}
-
-void SemanticVerifierVisitor::visit(NDQOpReset::Ref ref) {
-    visitNDQOp(ref);
+    emit(g);
+    return true;
 }
 
-void SemanticVerifierVisitor::visit(NDQOpU::Ref ref) {
-    visitNDQOp(ref);
+bool SemanticVerifier::isDone() const {
+    return mScheduler.isDone();
 }
 
-void SemanticVerifierVisitor::visit(NDQOpCX::Ref ref) {
-    visitNDQOp(ref);
+SemanticVerifierPass::SemanticVerifierPass(QModule::uRef src, Mapping initial, bool commute)
+    : mSrc(std::move(src)), mInitial(initial), mCommute(commute), mInlineAll(true) {
+    mData = false;
 }
 
-void SemanticVerifierVisitor::visit(NDQOpBarrier::Ref ref) {
-    visitNDQOp(ref);
+SemanticVerifierPass::SemanticVerifierPass(CanonicalCircuit::uRef src, Mapping initial,
+                                           bool commute)
+    : mCanonical(std::move(src)), mInitial(initial), mCommute(commute), mInlineAll(false) {
+    mData = false;
 }
 
-void SemanticVerifierVisitor::visit(NDQOpGen::Ref ref) {
-    if (ref->isIntrinsic() && ref->getIntrinsicKind() == NDQOpGen::K_INTRINSIC_SWAP) {
-        auto qargs = ref->getQArgs();
-
-        uint32_t u = mXtoNTgt.getQUId(qargs->getChild(0)->toString(false));
-        uint32_t v = mXtoNTgt.getQUId(qargs->getChild(1)->toString(false));
+bool SemanticVerifierPass::run(QModule* tgt) {
+    if (mCanonical.get() == nullptr && mSrc.get() != nullptr) {
+        if (mInlineAll) {
+            PassCache::Run<FlattenPass>(mSrc.get());
 
-        uint32_t a = mAssign[u];
-        uint32_t b = mAssign[v];
+            auto inlinePass = InlineAllPass::Create(mBasis);
+            PassCache::Run(mSrc.get(), inlinePass.get());
+        }
 
-        std::swap(mMap[a], mMap[b]);
-        std::swap(mAssign[u], mAssign[v]);
-    } else {
-        visitNDQOp(ref);
+        // Only the snapshot is needed from now on.
+        mCanonical = CanonicalCircuit::Create(mSrc.get());
+        mSrc.reset(nullptr);
     }
-}
-
-void SemanticVerifierVisitor::visit(NDIfStmt::Ref ref) {
-    // NOTE: if, one day, we have 'swap' nodes inside if statements, we
-    // should call 'ref->getQOp()->apply()' here.
-    visitNDQOp(ref->getQOp(), ref);
-}
 
-SemanticVerifierPass::SemanticVerifierPass(QModule::uRef src, Mapping initial)
-    : mSrc(std::move(src)), mInitial(initial) {
-    mData = false;
-}
+    // The source could not be canonicalized (e.g.: unknown registers).
+    if (mCanonical.get() == nullptr) {
+        mData = false;
+        return false;
+    }
 
-bool SemanticVerifierPass::run(QModule* tgt) {
-    PassCache::Run<FlattenPass>(mSrc.get());
+    auto src = mCanonical.get();
 
-    auto inlinePass = InlineAllPass::Create(mBasis);
-    PassCache::Run(mSrc.get(), inlinePass.get());
+    // The gates that commute may have been reordered.
+    CommutationDAG dag;
 
-    auto cktpass = PassCache::Get<CircuitGraphBuilderPass>(mSrc.get());
-    auto& ckt = cktpass->getData();
+    if (mCommute) {
+        dag.init(src->getGraph(), src->getAxis());
+    }
 
-    auto xtonpassSrc = PassCache::Get<XbitToNumberWrapperPass>(mSrc.get());
-    auto xtonpassTgt = PassCache::Get<XbitToNumberWrapperPass>(tgt);
+    Canonicalizer canonicalizer(tgt);
+    SemanticVerifier verifier(*src,
+                              mCommute ? &dag : nullptr,
+                              canonicalizer.getQSize(),
+                              mInitial);
 
     mData = true;
-    auto it = ckt.build_iterator();
-    SemanticVerifierVisitor visitor(xtonpassSrc->getData(),
-                                    xtonpassTgt->getData(),
-                                    it,
-                                    mInitial);
+    CanonicalGate gate;
+
     for (auto it = tgt->stmt_begin(), end = tgt->stmt_end();
             it != end && mData; ++it) {
-        (*it)->apply(&visitor);
-        mData = mData && visitor.mSuccess;
-    }
+        switch (canonicalizer.canonicalize(it->get(), gate)) {
+            case Canonicalizer::R_GATE:
+                mData = verifier.match(gate);
+                break;
 
-    for (uint32_t i = 0, e = ckt.size(); i < e; ++i) {
-        if (!it[i]->isOutputNode()) { mData = false; break; }
+            case Canonicalizer::R_NOT_QOP:
+                break;
+
+            case Canonicalizer::R_INVALID:
+                mData = false;
+                break;
+        }
     }
 
+    mData = mData && verifier.isDone();
+
     return false;
 }
 
 void SemanticVerifierPass::setInlineAll(std::vector<std::string> basis) {
+    mInlineAll = true;
     mBasis = basis;
 }
 
-SemanticVerifierPass::uRef SemanticVerifierPass::Create(QModule::uRef src, Mapping initial) {
-    return uRef(new SemanticVerifierPass(std::move(src), initial));
+void SemanticVerifierPass::setDontInline() {
+    mInlineAll = false;
+}
+
+SemanticVerifierPass::uRef SemanticVerifierPass::Create(QModule::uRef src, Mapping initial,
+                                                        bool commute) {
+    return uRef(new SemanticVerifierPass(std::move(src), initial, commute));
+}
+
+SemanticVerifierPass::uRef SemanticVerifierPass::Create(CanonicalCircuit::uRef src, Mapping initial,
+                                                        bool commute) {
+    return uRef(new SemanticVerifierPass(std::move(src), initial, commute));
 }
@@ -3,44 +3,60 @@
 #include "enfield/Analysis/Driver.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
+#include "enfield/Support/Defs.h"
 
 #include <cassert>
 #include <unordered_map>
 #include <iterator>
 #include <iostream>
+#include <mutex>
 
 using namespace efd;
 
 // ==--------------- Intrinsic Gates ---------------==
-static std::vector<NDGateSign::uRef> IntrinsicGates;
 static const std::string IntrinsicGatesStr =
 #define EFD_LIB(...) #__VA_ARGS__
 #include "enfield/StdLib/intrinsic.inc"
 #undef EFD_LIB
 ;
 
-static void ProcessIntrinsicGates() {
-    if (IntrinsicGates.empty()) {
-        auto ast = ParseString(IntrinsicGatesStr, false);
-        assert(instanceOf<NDStmtList>(ast.get()) &&
-                "Intrinsic gates root node of wrong type.");
+typedef std::vector<NDGateSign::sRef> SharedGates;
 
-        for (auto& gate : *ast) {
-            auto gateNode = uniqueCastForward<NDGateSign>(std::move(gate));
-            assert(gateNode.get() != nullptr && "Statement is not a gate declaration.");
-            IntrinsicGates.push_back(std::move(gateNode));
-        }
+static SharedGates GetSharedGates(Node::uRef ast, bool inInclude) {
+    assert(instanceOf<NDStmtList>(ast.get()) &&
+            "Library root node of wrong type.");
+
+    SharedGates gates;
+    for (auto& gate : *ast) {
+        auto gateNode = uniqueCastForward<NDGateSign>(std::move(gate));
+        assert(gateNode.get() != nullptr && "Statement is not a gate declaration.");
+
+        gateNode->setParent(nullptr);
+        if (inInclude) gateNode->setInInclude();
+
+        gates.push_back(NDGateSign::sRef(gateNode.release()));
     }
+
+    return gates;
 }
 
-std::vector<NDGateSign::uRef> efd::GetIntrinsicGates() {
-    ProcessIntrinsicGates();
+std::vector<NDGateSign::sRef> efd::GetIntrinsicGates() {
+    static SharedGates IntrinsicGates =
+        GetSharedGates(ParseString(IntrinsicGatesStr, false), false);
+    return IntrinsicGates;
+}
 
-    std::vector<NDGateSign::uRef> gates;
-    for (auto& gate : IntrinsicGates)
-        gates.push_back(uniqueCastForward<NDGateSign>(gate->clone()));
+std::vector<NDGateSign::sRef> efd::GetStdLibGates(std::string file) {
+    static std::mutex StdLibGatesMutex;
+    static std::unordered_map<std::string, SharedGates> StdLibGates;
 
-    return gates;
+    std::lock_guard<std::mutex> lock(StdLibGatesMutex);
+
+    if (StdLibGates.find(file) == StdLibGates.end()) {
+        StdLibGates[file] = GetSharedGates(GetStdLibAST(file)->clone(), true);
+    }
+
+    return StdLibGates[file];
 }
 
 namespace efd {
@@ -172,14 +188,23 @@ namespace efd {
         private:
             Node::uRef getClonedOrIntrinsic(Node::Ref ref);
 
+            NDRegDecl::Ref getReg(const std::string& id, bool isQuantum);
+            bool checkXbit(Node::Ref ref, bool isQuantum, uint32_t& size);
+            bool checkQOp(NDQOp::Ref qop);
+            bool check(Node::Ref stmt);
+
         public:
             QModule& mMod;
 
             NDGateDecl::Ref mCurGate;
             NDInclude::Ref mCurIncl;
 
+            /// \brief Whether every statement so far refers only to declared
+            /// registers and gates (see \em ProcessAST).
+            bool mValid;
+
             QModulefyVisitor(QModule& qmod)
-                : mMod(qmod), mCurGate(nullptr), mCurIncl(nullptr) {}
+                : mMod(qmod), mCurGate(nullptr), mCurIncl(nullptr), mValid(true) {}
 
             void visit(NDQasmVersion::Ref ref) override;
             void visit(NDInclude::Ref ref) override;
@@ -197,6 +222,120 @@ namespace efd {
     };
 }
 
+// Returns the register \p id (nullptr if it was not declared as a quantum
+// register, when \p isQuantum, or as a classical one, otherwise).
+NDRegDecl::Ref efd::QModulefyVisitor::getReg(const std::string& id, bool isQuantum) {
+    auto reg = mMod.hasQVar(id) ? dynCast<NDRegDecl>(mMod.getQVar(id)) : nullptr;
+
+    if (reg == nullptr || reg->isQReg() != isQuantum) {
+        ERR << (isQuantum ? "Quantum" : "Classical") << " register `" << id
+            << "` not found." << std::endl;
+        return nullptr;
+    }
+
+    return reg;
+}
+
+// Checks that \p ref is either a whole register or one of its bits. \p size is
+// set to the size of the register in the first case, and kept in the second.
+bool efd::QModulefyVisitor::checkXbit(Node::Ref ref, bool isQuantum, uint32_t& size) {
+    if (auto idref = dynCast<NDIdRef>(ref)) {
+        auto reg = getReg(idref->getId()->getVal(), isQuantum);
+        if (reg == nullptr) return false;
+
+        if (idref->getN()->getVal().mV >= reg->getSize()->getVal().mV) {
+            ERR << "Index out of bounds: `" << idref->toString(false) << "` (register of size "
+                << reg->getSize()->getVal().mV << ")." << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    auto id = dynCast<NDId>(ref);
+    if (id == nullptr) return false;
+
+    auto reg = getReg(id->getVal(), isQuantum);
+    if (reg == nullptr) return false;
+
+    uint32_t regSize = reg->getSize()->getVal().mV;
+
+    if (size != 0 && size != regSize) {
+        ERR << "Registers of different sizes used in the same operation (`"
+            << id->getVal() << "`)." << std::endl;
+        return false;
+    }
+
+    size = regSize;
+    return true;
+}
+
+bool efd::QModulefyVisitor::checkQOp(NDQOp::Ref qop) {
+    // Size of the whole registers used (0 if none). Only a barrier may use
+    // registers of different sizes.
+    uint32_t size = 0;
+    auto qargs = qop->getQArgs();
+
+    for (uint32_t i = 0, e = qargs->getChildNumber(); i < e; ++i) {
+        if (qop->isBarrier()) size = 0;
+        if (!checkXbit(qargs->getChild(i), true, size)) return false;
+    }
+
+    if (auto measure = dynCast<NDQOpMeasure>(qop)) {
+        return checkXbit(measure->getCBit(), false, size);
+    }
+
+    if (!qop->isGeneric()) return true;
+
+    // Intrinsic gates are only inserted after the whole AST is processed.
+    std::string id = qop->getId()->getVal();
+    NDGateSign::Ref gate = nullptr;
+
+    if (mMod.hasQGate(id)) {
+        gate = mMod.getQGate(id);
+    } else if (IsIntrinsicGateCall(qop)) {
+        for (auto& intrinsic : GetIntrinsicGates()) {
+            if (intrinsic->getId()->getVal() == id) gate = intrinsic.get();
+        }
+    }
+
+    if (gate == nullptr) {
+        ERR << "Gate `" << id << "` not found." << std::endl;
+        return false;
+    }
+
+    auto args = qop->getArgs();
+    auto gateArgs = gate->getArgs();
+    uint32_t nofArgs = (args != nullptr) ? args->getChildNumber() : 0;
+    uint32_t nofGateArgs = (gateArgs != nullptr) ? gateArgs->getChildNumber() : 0;
+
+    if (nofArgs != nofGateArgs || qargs->getChildNumber() != gate->getQArgs()->getChildNumber()) {
+        ERR << "Wrong number of arguments in `" << qop->toString(false) << "`." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Checks that the quantum operation (maybe inside an 'if') \p stmt refers only
+// to declared registers (and indexes inside them) and gates. Otherwise, the
+// passes would have to either crash or exit when reaching them.
+bool efd::QModulefyVisitor::check(Node::Ref stmt) {
+    if (auto ifstmt = dynCast<NDIfStmt>(stmt)) {
+        uint32_t size = 0;
+
+        if (!checkXbit(ifstmt->getCondId(), false, size)) {
+            mValid = false;
+            return false;
+        }
+
+        stmt = ifstmt->getQOp();
+    }
+
+    mValid = mValid && checkQOp(dynCast<NDQOp>(stmt));
+    return mValid;
+}
+
 efd::Node::uRef efd::QModulefyVisitor::getClonedOrIntrinsic(Node::Ref ref) {
     auto cloned = ref->clone();
     auto ifstmt = dynCast<NDIfStmt>(cloned.get());
@@ -239,10 +378,20 @@ void efd::QModulefyVisitor::visit(NDQasmVersion::Ref ref) {
 }
 
 void efd::QModulefyVisitor::visit(NDInclude::Ref ref) {
+    std::string file = ref->getFilename()->getVal();
+
     auto fileNode = uniqueCastForward<NDString>(ref->getFilename()->clone());
     mMod.insertInclude(NDInclude::Create
             (std::move(fileNode), uniqueCastBackward<Node>(NDStmtList::Create())));
 
+    // The standard library gates are shared among all modules. So, there is
+    // no need to clone each one of them.
+    if (IsStdLib(file)) {
+        for (auto& gate : GetStdLibGates(file))
+            mMod.insertGate(gate);
+        return;
+    }
+
     mCurIncl = ref;
     visitChildren(ref);
     mCurIncl = nullptr;
@@ -268,35 +417,42 @@ void efd::QModulefyVisitor::visit(NDOpaque::Ref ref) {
 
 
 void efd::QModulefyVisitor::visit(NDQOpMeasure::Ref ref) {
+    if (!check(ref)) return;
     mMod.insertStatementLast(ref->clone());
 }
 
 
 void efd::QModulefyVisitor::visit(NDQOpReset::Ref ref) {
+    if (!check(ref)) return;
     mMod.insertStatementLast(ref->clone());
 }
 
 
 void efd::QModulefyVisitor::visit(NDQOpU::Ref ref) {
+    if (!check(ref)) return;
     mMod.insertStatementLast(ref->clone());
 }
 
 
 void efd::QModulefyVisitor::visit(NDQOpCX::Ref ref) {
+    if (!check(ref)) return;
     mMod.insertStatementLast(ref->clone());
 }
 
 void efd::QModulefyVisitor::visit(NDQOpBarrier::Ref ref) {
+    if (!check(ref)) return;
     mMod.insertStatementLast(ref->clone());
 }
 
 // Both NDQOpGen and NDQOpIfStmt can be (the first) or have (the latter) an intrinsic gate.
 void efd::QModulefyVisitor::visit(NDQOpGen::Ref ref) {
+    if (!check(ref)) return;
     auto cloned = getClonedOrIntrinsic(ref);
     mMod.insertStatementLast(std::move(cloned));
 }
 
 void efd::QModulefyVisitor::visit(NDIfStmt::Ref ref) {
+    if (!check(ref)) return;
     auto cloned = getClonedOrIntrinsic(ref);
     mMod.insertStatementLast(std::move(cloned));
 }
@@ -305,9 +461,10 @@ void efd::QModulefyVisitor::visit(NDStmtList::Ref ref) {
     visitChildren(ref);
 }
 
-void efd::ProcessAST(QModule::Ref qmod, Node::Ref root) {
+bool efd::ProcessAST(QModule::Ref qmod, Node::Ref root) {
     QModulefyVisitor visitor(*qmod);
     root->apply(&visitor);
+    return visitor.mValid;
 }
 
 // ==--------------- Inlining ---------------==
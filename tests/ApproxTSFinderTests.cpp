@@ -3,6 +3,8 @@
 #include "enfield/Support/ExpTSFinder.h"
 #include "enfield/Support/Timer.h"
 
+#include <algorithm>
+
 using namespace efd;
 
 static ExpTSFinder::uRef expfinder;
@@ -34,7 +34,10 @@ q[3] q[4]\n\
 bool ArchTest(const std::string program) {
     ArchGraph::sRef graph = getGraph();
 
+    // Programs that refer to qubits out of the registers are not even parsed.
     auto qmod = QModule::ParseString(program);
+    if (qmod.get() == nullptr) return false;
+
     std::vector<std::string> basis {
         "intrinsic_swap__",
         "intrinsic_rev_cx__",
@@ -477,3 +480,27 @@ intrinsic_rev_cx__ q[2], q[1];\
         ASSERT_FALSE(isValid);
     }
 }
+
+TEST(ArchVerifierPassTests, ParallelRanges) {
+    ArchGraph::sRef graph = getGraph();
+
+    auto check = [&](uint32_t broken) {
+        std::string program = "qreg q[5];";
+
+        for (uint32_t i = 0; i < 16384; ++i) {
+            program += (i == broken) ? "CX q[2], q[0];" : "CX q[0], q[1];";
+        }
+
+        auto qmod = QModule::ParseString(program);
+        auto archpass = ArchVerifierPass::Create(graph);
+        archpass->setThreads(4);
+
+        PassCache::Run(qmod.get(), archpass.get());
+        return archpass->getData();
+    };
+
+    EXPECT_TRUE(check(16384));
+    EXPECT_FALSE(check(0));
+    EXPECT_FALSE(check(8192));
+    EXPECT_FALSE(check(16383));
+}
@@ -23,8 +23,8 @@ static void CheckCircuitGraph(std::string prog, Checker checker) {
 
     for (uint32_t i = 0; i < xbits; ++i) {
         it.next(i);
-        if (checker.gused[i]) ASSERT_TRUE(it[i]->isGateNode());
-        else ASSERT_FALSE(it[i]->isGateNode());
+        if (checker.gused[i]) ASSERT_TRUE(it[i].isGateNode());
+        else ASSERT_FALSE(it[i].isGateNode());
     }
 
     bool stop;
@@ -33,29 +33,29 @@ static void CheckCircuitGraph(std::string prog, Checker checker) {
 
     do {
         stop = true;
-        std::set<CircuitGraph::CircuitNode::sRef> completed;
+        std::set<CircuitGraph::CircuitNode> completed;
 
         for (uint32_t i = 0; i < xbits; ++i) {
-            if (it[i]->isGateNode() && !marked[i]) {
-                auto node = it[i]->node();
+            if (it[i].isGateNode() && !marked[i]) {
+                auto node = it[i].node();
                 marked[i] = true;
 
                 if (reached.find(node) == reached.end())
-                    reached[node] = it[i]->numberOfXbits();
+                    reached[node] = it[i].numberOfXbits();
                 --reached[node];
             }
         }
 
         for (uint32_t i = 0; i < xbits; ++i) {
-            auto node = it[i]->node();
+            auto node = it[i].node();
 
-            if (it[i]->isGateNode() && !reached[node]) {
+            if (it[i].isGateNode() && !reached[node]) {
                 completed.insert(it[i]);
                 marked[i] = false;
                 it.next(i);
             }
 
-            if (!it[i]->isOutputNode()) stop = false;
+            if (!it[i].isOutputNode()) stop = false;
         }
 
         for (auto cnode : completed) {
@@ -63,7 +63,7 @@ static void CheckCircuitGraph(std::string prog, Checker checker) {
 
             uint32_t i = 0;
             for (uint32_t e = checker.used.size(); i < e; ++i) {
-                auto used = cnode->getXbitsIds();
+                auto used = cnode.getXbitsIds();
                 std::set<uint32_t> set(used.begin(), used.end());
                 if (set == checker.used[i]) {
                     found = true;
@@ -27,12 +27,12 @@ void FullTest(uint32_t qubits, uint32_t cbits, std::vector<std::vector<Xbit>> ga
 
     for (uint32_t i = 0; i < qubits; ++i) {
         ASSERT_TRUE(it.next(Xbit::Q(i)));
-        ASSERT_TRUE(it[Xbit::Q(i)]->isOutputNode());
+        ASSERT_TRUE(it[Xbit::Q(i)].isOutputNode());
     }
 
     for (uint32_t i = 0; i < cbits; ++i) {
         ASSERT_TRUE(it.next(Xbit::C(i)));
-        ASSERT_TRUE(it[Xbit::C(i)]->isOutputNode());
+        ASSERT_TRUE(it[Xbit::C(i)].isOutputNode());
     }
 }
 
@@ -171,3 +171,73 @@ TEST(CircuitGraphTests, ErrorTests) {
     ASSERT_EXIT({ FullTest(5, 5, { { Xbit::Q(9), Xbit::C(0) } }); },
                 ::testing::ExitedWithCode(exitCode), "");
 }
+
+TEST(CircuitGraphTests, IteratesBackAndForth) {
+    CircuitGraph ckt(3, 1);
+
+    auto g0 = reinterpret_cast<Node::Ref>(1);
+    auto g1 = reinterpret_cast<Node::Ref>(2);
+    ckt.append({ Xbit::Q(0), Xbit::Q(1) }, g0);
+    ckt.append({ Xbit::Q(1), Xbit::Q(2), Xbit::C(0) }, g1);
+    ASSERT_EQ(ckt.getNumberOfGates(), (uint32_t) 2);
+
+    auto it = ckt.build_iterator();
+    ASSERT_TRUE(it[1].isInputNode());
+    ASSERT_FALSE(it.back(1));
+
+    ASSERT_TRUE(it.next(1));
+    ASSERT_EQ(it.get(1), g0);
+    ASSERT_EQ(it[1].numberOfXbits(), (uint32_t) 2);
+    ASSERT_EQ(it[1].getXbitsIds(), std::vector<uint32_t>({ 0, 1 }));
+
+    ASSERT_TRUE(it.next(1));
+    ASSERT_EQ(it.get(1), g1);
+    ASSERT_EQ(it[1].getXbitsIds(), std::vector<uint32_t>({ 1, 2, 3 }));
+
+    ASSERT_TRUE(it.next(2));
+    ASSERT_TRUE(it[1] == it[2]);
+    ASSERT_TRUE(it.next(Xbit::C(0)));
+    ASSERT_TRUE(it[1] == it[Xbit::C(0)]);
+
+    ASSERT_TRUE(it.next(1));
+    ASSERT_TRUE(it[1].isOutputNode());
+    ASSERT_FALSE(it.next(1));
+
+    ASSERT_TRUE(it.back(1));
+    ASSERT_EQ(it.get(1), g1);
+    ASSERT_TRUE(it.back(1));
+    ASSERT_EQ(it.get(1), g0);
+    ASSERT_TRUE(it.back(1));
+    ASSERT_TRUE(it[1].isInputNode());
+}
+
+TEST(CircuitGraphTests, KahnSchedulerLayers) {
+    CircuitGraph ckt(4, 0);
+
+    ckt.append({ Xbit::Q(0), Xbit::Q(1) }, reinterpret_cast<Node::Ref>(1));
+    ckt.append({ Xbit::Q(2) }, reinterpret_cast<Node::Ref>(2));
+    ckt.append({ Xbit::Q(1), Xbit::Q(2) }, reinterpret_cast<Node::Ref>(3));
+    ckt.append({ Xbit::Q(3) }, reinterpret_cast<Node::Ref>(4));
+
+    ASSERT_EQ(ckt.getPredGate(2, 0), (uint32_t) 0);
+    ASSERT_EQ(ckt.getPredGate(2, 1), (uint32_t) 1);
+    ASSERT_EQ(ckt.getSuccGate(3, 0), CircuitGraph::NoGate);
+
+    auto layers = KahnScheduler::BuildLayers(ckt);
+    ASSERT_EQ(layers.size(), (uint32_t) 2);
+    ASSERT_EQ(layers[0], std::vector<uint32_t>({ 0, 1, 3 }));
+    ASSERT_EQ(layers[1], std::vector<uint32_t>({ 2 }));
+
+    KahnScheduler sched(ckt);
+    std::vector<uint32_t> ready;
+    ASSERT_EQ(sched.getInitialReady(), std::vector<uint32_t>({ 0, 1, 3 }));
+
+    sched.emit(0, ready);
+    ASSERT_TRUE(ready.empty());
+    sched.emit(1, ready);
+    ASSERT_EQ(ready, std::vector<uint32_t>({ 2 }));
+    sched.emit(3, ready);
+    ASSERT_FALSE(sched.isDone());
+    sched.emit(2, ready);
+    ASSERT_TRUE(sched.isDone());
+}
@@ -51,6 +51,24 @@ TEST(CommandLineTest, SimpleParammeterTest) {
     EXPECT_EQ(optStr.getVal(), constS);
 }
 
+TEST(CommandLineTest, EqualsSeparatedValueTest) {
+    efd::Opt<std::string> optFormat("format", "Some string description.", "text", false);
+    efd::Opt<unsigned> optN("-n", "Some unsigned description.", 0, false);
+
+    int nArgs = 3;
+
+    CREATE_ARGS(nArgs, "EqualsSeparatedValueTest",
+        "-format=json",
+        "--n=42",
+    );
+
+    efd::ParseArguments(nArgs, argv);
+
+    EXPECT_TRUE(optFormat.isParsed());
+    EXPECT_EQ(optFormat.getVal(), "json");
+    EXPECT_EQ(optN.getVal(), 42u);
+}
+
 TEST(CommandLineTest, RequiredAssertTest) {
     efd::Opt<bool> optBool("bool", "Some bool description.", false, true);
     efd::Opt<int> optInt("int", "Some int description.", false);
@@ -0,0 +1,148 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/CommutationDAGBuilderPass.h"
+#include "enfield/Transform/CircuitGraphBuilderPass.h"
+#include "enfield/Transform/SemanticVerifierPass.h"
+#include "enfield/Transform/PassCache.h"
+
+#include <string>
+
+using namespace efd;
+
+typedef CommutationDAG::Axis Axis;
+
+static std::vector<std::vector<std::string>> BuildLayers(std::string program, bool relaxed) {
+    auto qmod = QModule::ParseString(program);
+    auto& graph = PassCache::Get<CircuitGraphBuilderPass>(qmod.get())->getData();
+    auto& dag = PassCache::Get<CommutationDAGBuilderPass>(qmod.get())->getData();
+
+    std::vector<std::vector<std::string>> layers;
+
+    for (auto& gates : KahnScheduler::BuildLayers(graph, relaxed ? &dag : nullptr)) {
+        std::vector<std::string> layer;
+        for (uint32_t g : gates) layer.push_back(graph.getNode(g)->toString(false));
+        layers.push_back(layer);
+    }
+
+    return layers;
+}
+
+TEST(CommutationDAGTests, GateAxis) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+creg c[3];\
+CX q[0], q[1];\
+cx q[1], q[0];\
+rz(pi) q[2];\
+h q[2];\
+measure q[0] -> c[0];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    std::vector<std::vector<Axis>> axis;
+
+    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
+        axis.push_back(GetCommutationAxis(it->get()));
+    }
+
+    ASSERT_EQ(axis.size(), (uint32_t) 5);
+    ASSERT_EQ(axis[0], std::vector<Axis>({ Axis::Z, Axis::X }));
+    ASSERT_EQ(axis[1], std::vector<Axis>({ Axis::Z, Axis::X }));
+    ASSERT_EQ(axis[2], std::vector<Axis>({ Axis::Z }));
+    ASSERT_EQ(axis[3], std::vector<Axis>({ Axis::NONE }));
+    ASSERT_EQ(axis[4], std::vector<Axis>({ Axis::NONE }));
+}
+
+TEST(CommutationDAGTests, SharedControlIsOneLayer) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[4];\
+cx q[0], q[1];\
+rz(pi) q[0];\
+cx q[0], q[2];\
+cx q[3], q[2];\
+";
+
+    typedef std::vector<std::vector<std::string>> LayersStr;
+
+    ASSERT_EQ(BuildLayers(program, false), LayersStr({
+                { "cx q[0], q[1];" },
+                { "rz(pi) q[0];" },
+                { "cx q[0], q[2];" },
+                { "cx q[3], q[2];" }
+            }));
+
+    ASSERT_EQ(BuildLayers(program, true), LayersStr({
+                { "cx q[0], q[1];", "rz(pi) q[0];", "cx q[0], q[2];", "cx q[3], q[2];" }
+            }));
+}
+
+TEST(CommutationDAGTests, NonCommutingGatesKeepTheOrder) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[0], q[1];\
+cx q[1], q[2];\
+h q[0];\
+cx q[0], q[2];\
+";
+
+    typedef std::vector<std::vector<std::string>> LayersStr;
+
+    ASSERT_EQ(BuildLayers(program, true), LayersStr({
+                { "cx q[0], q[1];" },
+                { "cx q[1], q[2];", "h q[0];" },
+                { "cx q[0], q[2];" }
+            }));
+}
+
+TEST(CommutationDAGTests, VerifierAcceptsOnlyCommutingReorders) {
+    const std::string src =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[0], q[1];\
+cx q[0], q[2];\
+cx q[1], q[2];\
+";
+
+    const std::string commuted =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[0], q[2];\
+cx q[0], q[1];\
+cx q[1], q[2];\
+";
+
+    const std::string wrong =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[1], q[2];\
+cx q[0], q[1];\
+cx q[0], q[2];\
+";
+
+    auto verify = [&](std::string tgt) {
+        auto tgtMod = QModule::ParseString(tgt);
+        auto verifier = SemanticVerifierPass::Create(QModule::ParseString(src), { 0, 1, 2 },
+                                                     true);
+        verifier->run(tgtMod.get());
+        return verifier->getData();
+    };
+
+    ASSERT_TRUE(verify(src));
+    ASSERT_TRUE(verify(commuted));
+    ASSERT_FALSE(verify(wrong));
+}
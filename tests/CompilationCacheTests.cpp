@@ -0,0 +1,131 @@
+
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/CompilationCache.h"
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Support/uRefCast.h"
+
+#include <string>
+#include <fstream>
+#include <thread>
+#include <chrono>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace efd;
+
+static std::string GetCacheDir(std::string name) {
+    return "efd-cache-test-" + std::to_string(getpid()) + "/" + name;
+}
+
+static CompilationSettings CreateSettings() {
+    const std::string gStr =
+"\
+1 3\n\
+q 3\n\
+q[0] q[1]\n\
+q[1] q[2]\n\
+";
+
+    return CompilationSettings {
+        toShared(ArchGraph::ReadString(gStr)), Allocator::Q_dynprog,
+        { "cx" }, false, true, false, 1
+    };
+}
+
+static CompilationCache::Entry CreateEntry(uint32_t size) {
+    return CompilationCache::Entry { std::string(size, 'q'), "1::TotalCost::Cost.\n" };
+}
+
+TEST(CompilationCacheTests, StoreAndLookup) {
+    auto cache = CompilationCache::Create(GetCacheDir("store"));
+    ASSERT_FALSE(cache.get() == nullptr);
+
+    CompilationCache::Entry entry;
+    ASSERT_FALSE(cache->lookup("abc", entry));
+
+    auto stored = CompilationCache::Entry { "qreg q[3];\ncx q[0], q[1];\n", "" };
+    ASSERT_TRUE(cache->store("abc", stored));
+    ASSERT_TRUE(cache->lookup("abc", entry));
+    EXPECT_EQ(stored.mOutput, entry.mOutput);
+    EXPECT_EQ(stored.mStats, entry.mStats);
+}
+
+TEST(CompilationCacheTests, KeyDependsOnSettings) {
+    auto settings = CreateSettings();
+    const std::string program = "qreg q[3];\nCX q[0], q[2];\n";
+
+    auto key = CompilationCache::GetKey(program, settings, true);
+    EXPECT_EQ(key, CompilationCache::GetKey(program, settings, true));
+    EXPECT_NE(key, CompilationCache::GetKey(program, settings, false));
+    EXPECT_NE(key, CompilationCache::GetKey(program, settings, true, StatsFormat::JSON));
+    EXPECT_NE(key, CompilationCache::GetKey(program + " ", settings, true));
+
+    auto other = settings;
+    other.allocator = Allocator::Q_bsi;
+    EXPECT_NE(key, CompilationCache::GetKey(program, other, true));
+
+    other = settings;
+    other.basis.push_back("h");
+    EXPECT_NE(key, CompilationCache::GetKey(program, other, true));
+
+    other = settings;
+    other.commute = true;
+    EXPECT_NE(key, CompilationCache::GetKey(program, other, true));
+
+    other = settings;
+    other.archGraph->putEdge(2, 1);
+    EXPECT_NE(key, CompilationCache::GetKey(program, other, true));
+}
+
+TEST(CompilationCacheTests, KeyDependsOnIncludes) {
+    auto settings = CreateSettings();
+    auto dir = "efd-cache-include-test-" + std::to_string(getpid());
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+
+    std::ofstream(dir + "/lib.inc") << "gate g a, b { CX a, b; }\n";
+    std::ofstream(dir + "/nested.inc") << "include \"lib.inc\";\n";
+
+    const std::string program =
+        "include \"qelib1.inc\";\n// include \"commented.inc\";\n"
+        "include \"nested.inc\";\nqreg q[3];\ng q[0], q[2];\n";
+
+    auto key = CompilationCache::GetKey(program, settings, true, StatsFormat::Text, dir + "/");
+    EXPECT_EQ(64u, key.size());
+    EXPECT_EQ(key, CompilationCache::GetKey(program, settings, true, StatsFormat::Text, dir + "/"));
+
+    // The file included by the included file changed.
+    std::ofstream(dir + "/lib.inc") << "gate g a, b { CX b, a; }\n";
+    EXPECT_NE(key, CompilationCache::GetKey(program, settings, true, StatsFormat::Text, dir + "/"));
+
+    // The files are not found anymore.
+    EXPECT_NE(key, CompilationCache::GetKey(program, settings, true));
+
+    std::remove((dir + "/lib.inc").c_str());
+    std::remove((dir + "/nested.inc").c_str());
+    rmdir(dir.c_str());
+}
+
+TEST(CompilationCacheTests, EvictsLeastRecentlyUsed) {
+    // Room for only two entries.
+    auto cache = CompilationCache::Create(GetCacheDir("evict"), 2500);
+    ASSERT_FALSE(cache.get() == nullptr);
+
+    CompilationCache::Entry entry;
+
+    ASSERT_TRUE(cache->store("a", CreateEntry(1000)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(cache->store("b", CreateEntry(1000)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // Now, 'b' is the least recently used.
+    ASSERT_TRUE(cache->lookup("a", entry));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    ASSERT_TRUE(cache->store("c", CreateEntry(1000)));
+
+    EXPECT_TRUE(cache->lookup("a", entry));
+    EXPECT_FALSE(cache->lookup("b", entry));
+    EXPECT_TRUE(cache->lookup("c", entry));
+}
@@ -0,0 +1,182 @@
+
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/Compiler.h"
+#include "enfield/Transform/FlattenPass.h"
+#include "enfield/Transform/InlineAllPass.h"
+#include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/Allocators/Allocators.h"
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Support/uRefCast.h"
+
+#include <string>
+#include <thread>
+
+using namespace efd;
+
+static ArchGraph::sRef createGraph() {
+    const std::string gStr =
+"\
+1 5\n\
+q 5\n\
+q[0] q[1]\n\
+q[1] q[2]\n\
+q[0] q[2]\n\
+q[3] q[2]\n\
+q[4] q[2]\n\
+q[3] q[4]\n\
+";
+
+    return toShared(ArchGraph::ReadString(gStr));
+}
+
+static CompilationSettings createSettings(EnumAllocator allocator) {
+    if (!HasAllocator(allocator)) InitializeAllQbitAllocators();
+
+    return CompilationSettings {
+        createGraph(), allocator, { "cx", "u1", "u2", "u3" }, false, true, false, 1
+    };
+}
+
+static const std::string program =
+"\
+qreg q[5];\
+CX q[0], q[1];\
+CX q[3], q[0];\
+CX q[4], q[1];\
+CX q[3], q[1];\
+CX q[2], q[4];\
+";
+
+TEST(CompilerTests, SameOutputAsCompile) {
+    for (auto allocator : { Allocator::Q_dynprog, Allocator::Q_bsi }) {
+        auto settings = createSettings(EnumAllocator(allocator));
+        auto compiler = Compiler::Create(settings);
+
+        auto qmod = Compile(QModule::ParseString(program), settings);
+        ASSERT_FALSE(qmod.get() == nullptr);
+
+        // The second compilation uses the cache filled by the first one.
+        EXPECT_EQ(compiler->compile(program), qmod->toString(true));
+        EXPECT_EQ(compiler->compile(program), qmod->toString(true));
+    }
+}
+
+TEST(CompilerTests, SharedBetweenThreads) {
+    auto compiler = Compiler::Create(createSettings(EnumAllocator(Allocator::Q_dynprog)));
+    auto expected = compiler->compile(program);
+    ASSERT_FALSE(expected.empty());
+
+    std::vector<std::string> outputs(4);
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < outputs.size(); ++i) {
+        threads.push_back(std::thread([&, i]() {
+            outputs[i] = compiler->compile(program);
+        }));
+    }
+
+    for (auto& thread : threads) thread.join();
+    for (auto& output : outputs) EXPECT_EQ(output, expected);
+}
+
+TEST(CompilerTests, DifferentOptionsAtTheSameTime) {
+    std::vector<Compiler::uRef> compilers;
+    std::vector<std::string> expected;
+
+    for (uint32_t seed = 0; seed < 4; ++seed) {
+        auto settings = createSettings(EnumAllocator(Allocator::Q_random));
+        settings.allocatorOptions.seed = seed;
+        settings.allocatorOptions.swapCost = 1 + seed;
+
+        compilers.push_back(Compiler::Create(settings));
+        expected.push_back(compilers.back()->compile(program));
+        ASSERT_FALSE(expected.back().empty());
+    }
+
+    std::vector<std::string> outputs(compilers.size());
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < compilers.size(); ++i) {
+        threads.push_back(std::thread([&, i]() {
+            outputs[i] = compilers[i]->compile(program);
+        }));
+    }
+
+    for (auto& thread : threads) thread.join();
+    for (uint32_t i = 0; i < outputs.size(); ++i) EXPECT_EQ(outputs[i], expected[i]);
+}
+
+TEST(CompilerTests, GatesWithManyDependenciesFail) {
+    auto settings = createSettings(EnumAllocator(Allocator::Q_bsi));
+    settings.basis.push_back("ccx");
+
+    // 'ccx' (kept by the basis) has more than one dependency.
+    auto compiler = Compiler::Create(settings);
+    ASSERT_EQ("", compiler->compile("include \"qelib1.inc\"; qreg q[3]; ccx q[0], q[1], q[2];"));
+    ASSERT_NE("", compiler->compile(program));
+}
+
+TEST(CompilerTests, DisconnectedArchitecturesFail) {
+    const std::string gStr =
+"\
+1 5\n\
+q 5\n\
+q[0] q[1]\n\
+q[1] q[2]\n\
+q[3] q[4]\n\
+";
+
+    auto settings = createSettings(EnumAllocator(Allocator::Q_grdy));
+    settings.archGraph = toShared(ArchGraph::ReadString(gStr));
+
+    auto compiler = Compiler::Create(settings);
+    ASSERT_EQ("", compiler->compile(program));
+
+    // There is no path between the two parts of the architecture.
+    auto cache = compiler->getArchCache();
+    ASSERT_TRUE(cache->getPath(0, 4).empty());
+    ASSERT_EQ(std::vector<uint32_t>({ 0, 1, 2 }), cache->getPath(0, 2));
+}
+
+// Each statement of \p qmod, followed by its dependencies.
+static std::string StmtsAndDeps(QModule::Ref qmod) {
+    auto& depBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
+    std::string str;
+
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
+        str += (*it)->toString();
+
+        for (auto& dep : depBuilder.getDeps(it->get())) {
+            str += " " + std::to_string(dep.mFrom) + "->" + std::to_string(dep.mTo);
+        }
+
+        str += "\n";
+    }
+
+    return str;
+}
+
+TEST(CompilerTests, ProcessFileInChunksSameAsWholeModule) {
+    const std::vector<std::string> basis = { "cx", "u1", "u2", "u3" };
+
+    for (std::string file : { "adder.qasm", "qft.qasm", "rb.qasm", "teleport.qasm",
+                              "W-state.qasm" }) {
+        auto qmod = ParseFile("files/" + file);
+        ASSERT_FALSE(qmod.get() == nullptr);
+
+        PassCache::Run<FlattenPass>(qmod.get());
+        auto inlinePass = InlineAllPass::Create(basis);
+        PassCache::Run(qmod.get(), inlinePass.get());
+
+        for (uint32_t chunkSize : { 1, 3, 64 }) {
+            std::string chunked;
+            auto header = ProcessFileInChunks("files/" + file, chunkSize, basis,
+                    [&](QModule::Ref chunk) { chunked += StmtsAndDeps(chunk); });
+
+            ASSERT_FALSE(header.get() == nullptr);
+            EXPECT_EQ(StmtsAndDeps(qmod.get()), chunked) << file << ", " << chunkSize;
+        }
+    }
+}
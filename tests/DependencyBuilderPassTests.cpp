@@ -46,7 +46,7 @@ gate cnot x, y {\
         ASSERT_FALSE(deps[0].mCallPoint == nullptr);
         ASSERT_TRUE(efd::instanceOf<NDQOpCX>(deps[0].mCallPoint));
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 
     {
@@ -101,7 +101,7 @@ gate cnot x, y {\
         ASSERT_FALSE(cnotDeps[0].mCallPoint == nullptr);
         ASSERT_TRUE(efd::instanceOf<NDQOp>(cnotDeps[0].mCallPoint));
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 }
 
@@ -133,7 +133,7 @@ CX q[0], q[1];\
         ASSERT_FALSE(deps[0].mCallPoint == nullptr);
         ASSERT_TRUE(efd::instanceOf<NDQOpCX>(deps[0].mCallPoint));
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 
     {
@@ -211,6 +211,47 @@ measure carry[0] -> carryout[0];\
             ASSERT_EQ(sum, pair.second.second);
         }
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 }
+
+TEST(DependencyBuilderWrapperPassTest, InstructionDependenciesTest) {
+    const std::string program = \
+"\
+gate cnot x, y {\
+    CX x, y;\
+}\
+qreg q[3];\
+U(0, 0, 0) q[2];\
+cnot q[0], q[2];\
+CX q[2], q[1];\
+";
+
+    auto qmod = toShared(QModule::ParseString(program));
+    auto pass = DependencyBuilderWrapperPass::Create();
+    pass->run(qmod.get());
+
+    auto& data = pass->getData();
+    auto& deps = data.getDependencies();
+    ASSERT_EQ(deps.size(), (uint32_t) 2);
+
+    // Single qubit gates have no dependencies.
+    auto u = qmod->getStatement(0);
+    ASSERT_TRUE(data.getDeps(u).isEmpty());
+    ASSERT_EQ(data.getDeps(u).mCallPoint, u);
+
+    for (uint32_t i = 1; i < 3; ++i) {
+        auto stmt = qmod->getStatement(i);
+        auto stmtDeps = data.getDeps(stmt);
+
+        ASSERT_EQ(stmtDeps.mCallPoint, stmt);
+        ASSERT_EQ(stmtDeps.getSize(), (uint32_t) 1);
+        ASSERT_EQ(stmtDeps[0].mFrom, deps[i - 1][0].mFrom);
+        ASSERT_EQ(stmtDeps[0].mTo, deps[i - 1][0].mTo);
+    }
+
+    ASSERT_EQ(deps[0][0].mFrom, (uint32_t) 0);
+    ASSERT_EQ(deps[0][0].mTo, (uint32_t) 2);
+    ASSERT_EQ(deps[1][0].mFrom, (uint32_t) 2);
+    ASSERT_EQ(deps[1][0].mTo, (uint32_t) 1);
+}
@@ -5,7 +5,11 @@
 
 #include <vector>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <cstdio>
+
+#include <unistd.h>
 
 using namespace efd;
 
@@ -29,3 +33,113 @@ TEST(DriverFileTests, ParsingFilesTest) {
         ASSERT_FALSE(root.get() == nullptr);
     }
 }
+
+static uint32_t GetNumberOfStmts(Node::Ref root) {
+    if (auto version = dynCast<NDQasmVersion>(root))
+        return version->getStatements()->getChildNumber();
+    return dynCast<NDStmtList>(root)->getChildNumber();
+}
+
+TEST(DriverFileTests, ParsingFilesInChunksTest) {
+    const uint32_t chunkSize = 4;
+
+    for (const std::string& file : files) {
+        auto root = efd::ParseFile(file, dir);
+        ASSERT_FALSE(root.get() == nullptr);
+
+        uint32_t stmts = 0;
+        auto header = efd::ParseFileInChunks(file, dir, chunkSize,
+                [&](NDStmtList::uRef chunk) {
+                    ASSERT_TRUE(chunk->getChildNumber() <= chunkSize);
+                    stmts += chunk->getChildNumber();
+                });
+
+        ASSERT_FALSE(header.get() == nullptr);
+        ASSERT_EQ(GetNumberOfStmts(header.get()), 0u);
+        ASSERT_EQ(GetNumberOfStmts(root.get()), stmts);
+    }
+
+    {
+        // The standard library is inserted in the first chunk, before it is
+        // included. It should not be included again.
+        const std::string file = "efd-chunk-include-test-" + std::to_string(getpid()) + ".qasm";
+        std::ofstream(file) << "qreg q[2]; qreg r[2]; include \"qelib1.inc\"; cx q[0],q[1];";
+
+        uint32_t stmts = 0, includes = 0;
+        auto header = efd::ParseFileInChunks(file, "./", 1,
+                [&](NDStmtList::uRef chunk) {
+                    for (auto& stmt : *chunk) {
+                        if (instanceOf<NDInclude>(stmt.get())) ++includes;
+                        ++stmts;
+                    }
+                });
+
+        std::remove(file.c_str());
+
+        ASSERT_FALSE(header.get() == nullptr);
+        ASSERT_EQ(1u, includes);
+        ASSERT_EQ(4u, stmts);
+    }
+}
+
+TEST(DriverFileTests, ParsingFilesInParallelTest) {
+    for (const std::string& file : files) {
+        auto root = efd::ParseFile(file, dir);
+        ASSERT_FALSE(root.get() == nullptr);
+
+        for (uint32_t threads : { 2, 3, 8 }) {
+            auto parallelRoot = efd::ParseFileParallel(file, dir, threads);
+            ASSERT_FALSE(parallelRoot.get() == nullptr);
+            ASSERT_EQ(root->toString(), parallelRoot->toString());
+        }
+    }
+}
+
+// Returns what \p parse wrote to std::cerr, asserting that it failed.
+static std::string GetParseErrors(std::function<Node::uRef()> parse) {
+    std::ostringstream errors;
+    auto oldBuf = std::cerr.rdbuf(errors.rdbuf());
+    auto root = parse();
+    std::cerr.rdbuf(oldBuf);
+
+    EXPECT_TRUE(root.get() == nullptr);
+    return errors.str();
+}
+
+TEST(DriverFileTests, ParallelSyntaxErrorLocationTest) {
+    const uint32_t nofRegs = 200;
+    const std::string file = "efd-parse-error-test-" + std::to_string(getpid()) + ".qasm";
+
+    {
+        // CRLF line endings, and comments, both alone and after a statement.
+        std::ofstream out(file, std::ios::binary);
+        out << "OPENQASM 2.0;\r\ninclude \"qelib1.inc\";\r\n";
+
+        for (uint32_t i = 0; i < nofRegs; ++i) {
+            out << "// register " << i << ";\r\n"
+                << "qreg q" << i << "[2];\r\n"
+                << "CX q" << i << "[0], q" << i << "[1]; // \"x\" ;\r\n";
+        }
+
+        // The syntax error is at the ';', in the last chunk.
+        out << "\tqreg ;\r\n";
+    }
+
+    auto serial = GetParseErrors([&]() { return efd::ParseFile(file, "./"); });
+    std::vector<std::string> parallel;
+
+    for (uint32_t threads : { 2, 3, 8 }) {
+        parallel.push_back(GetParseErrors([&]() {
+            return efd::ParseFileParallel(file, "./", threads);
+        }));
+    }
+
+    std::remove(file.c_str());
+
+    std::string location = file + ":" + std::to_string(3 + 3 * nofRegs) + ":7:";
+    ASSERT_EQ(serial.compare(0, location.size(), location), 0) << serial;
+
+    for (auto& errors : parallel) {
+        ASSERT_EQ(serial, errors);
+    }
+}
@@ -414,7 +414,7 @@ qreg q1[2];\
 qreg q2[5];\
 qreg q3[5];\
 creg c[5];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3[0];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3[0];\
 ";
 
         const std::string flattened = 
@@ -431,7 +431,7 @@ qreg q1[2];\
 qreg q2[5];\
 qreg q3[5];\
 creg c[5];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3[0];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3[0];\
 ";
         auto qmod = toShared(QModule::ParseString(program)); 
         auto pass = FlattenPass::Create();
@@ -455,7 +455,7 @@ qreg q1[2];\
 qreg q2[5];\
 qreg q3[5];\
 creg c[5];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3;\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3;\
 ";
 
         const std::string flattened = 
@@ -472,11 +472,11 @@ qreg q1[2];\
 qreg q2[5];\
 qreg q3[5];\
 creg c[5];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3[0];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3[1];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3[2];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3[3];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3[4];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3[0];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3[1];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3[2];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3[3];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3[4];\
 ";
         auto qmod = toShared(QModule::ParseString(program)); 
         auto pass = FlattenPass::Create();
@@ -500,7 +500,7 @@ qreg q1[2];\
 qreg q2[5];\
 qreg q3[5];\
 creg c[5];\
-if (c == 5) somegate q0[0], q1[0], q2, q3;\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2, q3;\
 ";
 
         const std::string flattened = 
@@ -517,11 +517,11 @@ qreg q1[2];\
 qreg q2[5];\
 qreg q3[5];\
 creg c[5];\
-if (c == 5) somegate q0[0], q1[0], q2[0], q3[0];\
-if (c == 5) somegate q0[0], q1[0], q2[1], q3[1];\
-if (c == 5) somegate q0[0], q1[0], q2[2], q3[2];\
-if (c == 5) somegate q0[0], q1[0], q2[3], q3[3];\
-if (c == 5) somegate q0[0], q1[0], q2[4], q3[4];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[0], q3[0];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[1], q3[1];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[2], q3[2];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[3], q3[3];\
+if (c == 5) somegate(pi, 2) q0[0], q1[0], q2[4], q3[4];\
 ";
         auto qmod = toShared(QModule::ParseString(program)); 
         auto pass = FlattenPass::Create();
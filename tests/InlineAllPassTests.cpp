@@ -109,7 +109,7 @@ TEST(InlineAllPassTests, IfStmtInline) {
         const std::string program =
 "\
 qreg q[5];\
-qreg c[5];\
+creg c[5];\
 gate mycx a, b {cx a, b;}\
 measure q -> c;\
 if (c == 3) mycx q[0], q[1];\
@@ -118,7 +118,7 @@ if (c == 3) mycx q[0], q[1];\
 "\
 include \"qelib1.inc\";\
 qreg q[5];\
-qreg c[5];\
+creg c[5];\
 measure q -> c;\
 if (c == 3) cx q[0], q[1];\
 ";
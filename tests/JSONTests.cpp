@@ -0,0 +1,15 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/JSON.h"
+
+using namespace efd;
+
+TEST(JSONTests, EscapesStrings) {
+    ASSERT_EQ("\"\"", ToJSONString(""));
+    ASSERT_EQ("\"TotalCost\"", ToJSONString("TotalCost"));
+    ASSERT_EQ("\"say \\\"hi\\\" \\\\ bye\"", ToJSONString("say \"hi\" \\ bye"));
+    ASSERT_EQ("\"a\\nb\\r\\tc\"", ToJSONString("a\nb\r\tc"));
+    // Other control characters are kept, as unicode escapes.
+    ASSERT_EQ("\"\\u0001\\u001f\"", ToJSONString("\x01\x1f"));
+    ASSERT_EQ("\"caf\xc3\xa9\"", ToJSONString("caf\xc3\xa9"));
+}
@@ -0,0 +1,45 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/MappedFile.h"
+
+#include <fstream>
+#include <sstream>
+#include <istream>
+#include <string>
+
+using namespace efd;
+
+static std::string ReadWithStream(std::string filepath) {
+    std::ifstream ifs(filepath.c_str());
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+TEST(MappedFileTests, SameContentsTest) {
+    std::string filepath = "files/qft.qasm";
+
+    auto mapped = MappedFile::Open(filepath);
+    ASSERT_FALSE(mapped.get() == nullptr);
+
+    std::string contents(mapped->data(), mapped->size());
+    ASSERT_EQ(ReadWithStream(filepath), contents);
+}
+
+TEST(MappedFileTests, NonExistingFileTest) {
+    auto mapped = MappedFile::Open("files/this-file-does-not-exist.qasm");
+    ASSERT_TRUE(mapped.get() == nullptr);
+}
+
+TEST(MappedFileTests, MemoryStreamBufTest) {
+    std::string str = "qreg q[5];\ncreg c[5];\n";
+    MemoryStreamBuf buf(str.c_str(), str.size());
+    std::istream in(&buf);
+
+    std::string line;
+    ASSERT_TRUE((bool) std::getline(in, line));
+    ASSERT_EQ(line, "qreg q[5];");
+    ASSERT_TRUE((bool) std::getline(in, line));
+    ASSERT_EQ(line, "creg c[5];");
+    ASSERT_FALSE((bool) std::getline(in, line));
+}
@@ -0,0 +1,174 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/PassProfiler.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/DependencyGraphBuilderPass.h"
+#include "enfield/Transform/FlattenPass.h"
+
+#include <thread>
+
+using namespace efd;
+
+namespace {
+    /// \brief Transform that does nothing but says it modified the module,
+    /// preserving only the analyses in \p mPreserved.
+    class TouchPass : public PassT<void> {
+        private:
+            PreservedAnalyses mPreserved;
+
+        public:
+            TouchPass(PreservedAnalyses preserved) : mPreserved(preserved) {}
+
+            bool run(QModule::Ref qmod) override { return true; }
+            PreservedAnalyses getPreserved() const override { return mPreserved; }
+    };
+}
+
+static const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[5];\
+qreg r[5];\
+cx q[0], r[0];\
+h q[1];\
+";
+
+TEST(PassCacheTests, NothingPreservedByDefault) {
+    auto qmod = QModule::ParseString(program);
+
+    PassCache::Get<DependencyBuilderWrapperPass>(qmod.get());
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_TRUE(PassCache::Has<DependencyBuilderWrapperPass>(qmod.get()));
+
+    TouchPass pass(PreservedAnalyses::None());
+    PassCache::Run(qmod.get(), &pass);
+
+    ASSERT_FALSE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_FALSE(PassCache::Has<DependencyBuilderWrapperPass>(qmod.get()));
+}
+
+TEST(PassCacheTests, PreservedAnalysisIsKept) {
+    auto qmod = QModule::ParseString(program);
+
+    auto xtn = PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+    PassCache::Get<DependencyBuilderWrapperPass>(qmod.get());
+
+    PassCache::Run<FlattenPass>(qmod.get());
+
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_FALSE(PassCache::Has<DependencyBuilderWrapperPass>(qmod.get()));
+    ASSERT_EQ(xtn, PassCache::Get<XbitToNumberWrapperPass>(qmod.get()));
+}
+
+TEST(PassCacheTests, InvalidationCascades) {
+    auto qmod = QModule::ParseString(program);
+
+    PassCache::Get<DependencyGraphBuilderPass>(qmod.get());
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_TRUE(PassCache::Has<DependencyBuilderWrapperPass>(qmod.get()));
+    ASSERT_TRUE(PassCache::Has<DependencyGraphBuilderPass>(qmod.get()));
+
+    // The dependency graph is preserved, but it depends on invalidated analyses.
+    auto preserved = PreservedAnalyses::None();
+    preserved.preserve<DependencyGraphBuilderPass>();
+    TouchPass pass(preserved);
+    PassCache::Run(qmod.get(), &pass);
+
+    ASSERT_FALSE(PassCache::Has<DependencyGraphBuilderPass>(qmod.get()));
+
+    // Preserving the whole chain keeps everything.
+    PassCache::Get<DependencyGraphBuilderPass>(qmod.get());
+    preserved.preserve<DependencyBuilderWrapperPass>();
+    preserved.preserve<XbitToNumberWrapperPass>();
+    TouchPass keepAll(preserved);
+    PassCache::Run(qmod.get(), &keepAll);
+
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_TRUE(PassCache::Has<DependencyBuilderWrapperPass>(qmod.get()));
+    ASSERT_TRUE(PassCache::Has<DependencyGraphBuilderPass>(qmod.get()));
+}
+
+TEST(PassCacheTests, EachModuleHasItsOwnCache) {
+    auto qmod = QModule::ParseString(program);
+    auto other = qmod->clone();
+
+    PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+    ASSERT_TRUE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_FALSE(PassCache::Has<XbitToNumberWrapperPass>(other.get()));
+}
+
+TEST(PassCacheTests, ModulesAnalyzedConcurrently) {
+    const uint32_t nofThreads = 8;
+
+    std::vector<QModule::uRef> qmods;
+    for (uint32_t i = 0; i < nofThreads; ++i) {
+        qmods.push_back(QModule::ParseString(program));
+    }
+
+    std::vector<uint32_t> deps(nofThreads, 0);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < nofThreads; ++i) {
+        threads.push_back(std::thread([&qmods, &deps, i]() {
+            PassCache::Run<FlattenPass>(qmods[i].get());
+            auto pass = PassCache::Get<DependencyBuilderWrapperPass>(qmods[i].get());
+            deps[i] = pass->getData().getDependencies().size();
+        }));
+    }
+
+    for (auto& t : threads) t.join();
+
+    for (uint32_t i = 0; i < nofThreads; ++i) {
+        ASSERT_EQ(deps[i], (uint32_t) 1);
+    }
+}
+
+TEST(PassCacheTests, DataIsSharedWithoutCopies) {
+    auto qmod = QModule::ParseString(program);
+
+    auto xtn = PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+    auto snapshot = PassCache::GetData<XbitToNumberWrapperPass>(qmod.get());
+    ASSERT_EQ(&xtn->getData(), snapshot.get());
+
+    auto depPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod.get());
+    ASSERT_EQ(&depPass->getData().getXbitToNumber(), snapshot.get());
+
+    // The snapshot is still valid after the pass is invalidated.
+    PassCache::Invalidate(qmod.get());
+    ASSERT_FALSE(PassCache::Has<XbitToNumberWrapperPass>(qmod.get()));
+    ASSERT_EQ(snapshot->getQSize(), (uint32_t) 10);
+}
+
+TEST(PassCacheTests, PassesAreProfiled) {
+    auto qmod = QModule::ParseString(program);
+
+    PassProfiler::Clear();
+    PassProfiler::Enable();
+
+    // XbitToNumber runs inside DependencyBuilder, and then it is cached.
+    PassCache::Get<DependencyBuilderWrapperPass>(qmod.get());
+    PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+    PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+
+    PassProfiler::Enable(false);
+    PassCache::Get<DependencyBuilderWrapperPass>(qmod.get());
+
+    auto records = PassProfiler::GetRecords();
+    ASSERT_EQ(records.size(), 2u);
+
+    for (auto& record : records) {
+        ASSERT_EQ(record.mRuns, 1u);
+        ASSERT_GE(record.mWallTime, 0);
+
+        if (record.mName == "XbitToNumberWrapperPass") {
+            ASSERT_EQ(record.mHits, 2u);
+        } else {
+            ASSERT_EQ(record.mName, "DependencyBuilderWrapperPass");
+            ASSERT_EQ(record.mHits, 0u);
+        }
+    }
+
+    PassProfiler::Clear();
+}
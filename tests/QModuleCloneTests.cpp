@@ -4,13 +4,24 @@
 #include "enfield/Analysis/Nodes.h"
 #include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Transform/QModule.h"
+#include "enfield/Transform/Utils.h"
 #include "enfield/Support/RTTI.h"
 
 #include <string>
+#include <unordered_set>
 
 using namespace efd;
 
 namespace {
+    bool isLibraryGate(NDGateSign::Ref gate) {
+        std::unordered_set<NDGateSign::Ref> library;
+
+        for (auto& g : GetIntrinsicGates()) library.insert(g.get());
+        for (auto& g : GetStdLibGates("qelib1.inc")) library.insert(g.get());
+
+        return library.find(gate) != library.end();
+    }
+
     class ASTVectorVisitor : public NodeVisitor, public PassT<void> {
         public:
             std::vector<Node::Ref> mV;
@@ -55,8 +66,9 @@ namespace {
                     (*it)->apply(this);
                 }
 
+                // Library gates are shared, not cloned.
                 for (auto it = qmod->gates_begin(), e = qmod->gates_end(); it != e; ++it) {
-                    (*it)->apply(this);
+                    if (!isLibraryGate(*it)) (*it)->apply(this);
                 }
 
                 for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
@@ -93,12 +105,12 @@ TEST_CLONE(IncludeTest,"include \"qelib1.inc\";");
 TEST_CLONE(DeclTest, "qreg q0[10];qreg q1[10];creg c0[10];");
 TEST_CLONE(GateTest, "gate notid a {}");
 TEST_CLONE(OpaqueGateTest, "opaque ogate(x, y) a, b, c;");
-TEST_CLONE(MeasureTest, "measure q[0] -> c[0];");
-TEST_CLONE(ResetTest, "reset q0[0];");
-TEST_CLONE(BarrierTest, "barrier q0, q1;");
-TEST_CLONE(GenericTest, "gate notid(cc) a, b { CX a, b; } notid(pi + 3 / 8) q0[0], q[1];");
-TEST_CLONE(CXTest, "CX q0[0], q[1];");
-TEST_CLONE(UTest, "U q0[0];");
+TEST_CLONE(MeasureTest, "qreg q[1];creg c[1];measure q[0] -> c[0];");
+TEST_CLONE(ResetTest, "qreg q0[1];reset q0[0];");
+TEST_CLONE(BarrierTest, "qreg q0[1];qreg q1[2];barrier q0, q1;");
+TEST_CLONE(GenericTest, "gate notid(cc) a, b { CX a, b; } qreg q0[1];qreg q[2];notid(pi + 3 / 8) q0[0], q[1];");
+TEST_CLONE(CXTest, "qreg q0[1];qreg q[2];CX q0[0], q[1];");
+TEST_CLONE(UTest, "qreg q0[1];U q0[0];");
 TEST_CLONE(GOPListTest, "gate notid a, b { CX a, b; U(pi) a; }");
 
 TEST_CLONE(WholeProgramTest, 
@@ -108,6 +120,8 @@ include \"qelib1.inc\";\
 qreg q0[10];\
 qreg q1[10];\
 creg c0[10];\
+qreg q[2];\
+creg c[1];\
 gate notid(cc) a, b {\
     CX a, b;\
     U(cc) a;\
@@ -118,3 +132,15 @@ reset q0[0];\
 barrier q0, q1;\
 notid(pi + 3 / 8) q0[0], q[1];\
 ");
+
+TEST(NodeCloneTests, LibraryGatesAreSharedTest) {
+    auto qmod = QModule::ParseString("include \"qelib1.inc\";");
+    auto clone = qmod->clone();
+
+    ASSERT_EQ(qmod->getNumberOfGates(), clone->getNumberOfGates());
+
+    for (auto it = qmod->gates_begin(), e = qmod->gates_end(); it != e; ++it) {
+        ASSERT_TRUE(isLibraryGate(*it));
+        ASSERT_EQ(*it, clone->getQGate((*it)->getId()->getVal()));
+    }
+}
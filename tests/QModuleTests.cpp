@@ -32,3 +32,56 @@ TEST(QModuleTests, TransformationTest) {
         ASSERT_FALSE(qmod.get() == nullptr);
     }
 }
+
+TEST(QModuleTests, ParseInChunksTest) {
+    for (const std::string& file : files) {
+        auto qmod = QModule::Parse(file, dir);
+        ASSERT_FALSE(qmod.get() == nullptr);
+
+        std::string stmts;
+        auto header = QModule::ParseInChunks(file, dir, 3, [&](QModule::Ref chunk) {
+            ASSERT_TRUE(chunk->getNumberOfStmts() <= 3);
+            for (auto it = chunk->stmt_begin(), e = chunk->stmt_end(); it != e; ++it)
+                stmts += (*it)->toString();
+        });
+
+        ASSERT_FALSE(header.get() == nullptr);
+        ASSERT_EQ(header->getNumberOfStmts(), 0u);
+        ASSERT_EQ(header->getNumberOfRegs(), qmod->getNumberOfRegs());
+        ASSERT_EQ(header->getNumberOfGates(), qmod->getNumberOfGates());
+
+        std::string expected;
+        for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it)
+            expected += (*it)->toString();
+        ASSERT_EQ(expected, stmts);
+    }
+}
+
+TEST(QModuleTests, InvalidProgramsTest) {
+    const std::string header = "include \"qelib1.inc\"; qreg q[2]; creg c[2];";
+
+    const std::vector<std::string> programs {
+        // Undeclared register.
+        "cx q[0], r[1];",
+        // Classical register used as quantum (and the other way around).
+        "cx q[0], c[1];",
+        "measure q[0] -> q[1];",
+        "if (q == 1) x q[0];",
+        // Index out of bounds.
+        "x q[2];",
+        // Unknown gate.
+        "foo q[0];",
+        // Wrong number of arguments.
+        "cx q[0];",
+        "u1 q[0];",
+        // Whole registers of different sizes.
+        "qreg r[3]; cx q, r;"
+    };
+
+    for (auto& program : programs) {
+        ASSERT_TRUE(QModule::ParseString(header + program).get() == nullptr) << program;
+    }
+
+    // Barriers may use registers of any size.
+    ASSERT_FALSE(QModule::ParseString(header + "qreg r[3]; barrier q, r;").get() == nullptr);
+}
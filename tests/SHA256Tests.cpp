@@ -0,0 +1,29 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/SHA256.h"
+
+using namespace efd;
+
+TEST(SHA256Tests, KnownDigests) {
+    ASSERT_EQ("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+              SHA256::Digest(""));
+    ASSERT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+              SHA256::Digest("abc"));
+    ASSERT_EQ("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+              SHA256::Digest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+    ASSERT_EQ("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+              SHA256::Digest(std::string(1000000, 'a')));
+}
+
+TEST(SHA256Tests, IncrementalUpdates) {
+    std::string message;
+    for (uint32_t i = 0; i < 1000; ++i) message += std::to_string(i) + ",";
+
+    // Pieces of every size, crossing the block boundaries.
+    SHA256 sha;
+    for (uint32_t i = 0, n = 1; i < message.size(); i += n, n = n % 97 + 1) {
+        sha.update(message.substr(i, n));
+    }
+
+    ASSERT_EQ(SHA256::Digest(message), sha.finish());
+}
@@ -981,3 +981,81 @@ measure q[4] -> c[4];\
         EXPECT_TRUE(areSemanticalyEqual);
     }
 }
+
+TEST(SemanticVerifierPassTests, DifferentGatesTest) {
+    const std::string progBefore =
+"\
+include \"qelib1.inc\";\
+qreg q[2];\
+h q[0];\
+u1(pi) q[1];\
+cx q[0], q[1];\
+";
+
+    auto check = [&](const std::string progAfter) {
+        auto verifier = SemanticVerifierPass::Create(QModule::ParseString(progBefore), { 1, 0 });
+        verifier->setInlineAll({ "h", "x", "u1", "cx" });
+
+        auto qmodAfter = QModule::ParseString(progAfter);
+        verifier->run(qmodAfter.get());
+        return verifier->getData();
+    };
+
+    EXPECT_TRUE(check(
+"\
+include \"qelib1.inc\";\
+qreg q[2];\
+h q[1];\
+u1(pi) q[0];\
+cx q[1], q[0];\
+"));
+
+    EXPECT_FALSE(check(
+"\
+include \"qelib1.inc\";\
+qreg q[2];\
+x q[1];\
+u1(pi) q[0];\
+cx q[1], q[0];\
+"));
+
+    EXPECT_FALSE(check(
+"\
+include \"qelib1.inc\";\
+qreg q[2];\
+h q[1];\
+u1(pi / 2) q[0];\
+cx q[1], q[0];\
+"));
+}
+
+// Programs built (instead of parsed) are not checked beforehand. So, the
+// invalid statement is taken from another program.
+static QModule::uRef AppendStatementOf(const std::string prog, const std::string other) {
+    auto qmod = QModule::ParseString(prog);
+    auto qmodOther = QModule::ParseString(other);
+    qmod->insertStatementLast(qmodOther->stmt_begin()->get()->clone());
+    return qmod;
+}
+
+TEST(SemanticVerifierPassTests, UnknownXbitsAreNotVerified) {
+    const std::string prog =
+"\
+qreg q[5];\
+CX q[0], q[1];\
+";
+
+    for (auto invalid : { "qreg r[2]; CX q[0], r[1];", "qreg q[9]; CX q[0], q[7];" }) {
+        auto qmodInvalid = AppendStatementOf(prog, std::string("qreg q[5];") + invalid);
+
+        SemanticVerifierPass tgtVerifier(QModule::ParseString(prog), Mapping { 0, 1, 2, 3, 4 });
+        tgtVerifier.run(qmodInvalid.get());
+        EXPECT_FALSE(tgtVerifier.getData());
+
+        EXPECT_EQ(nullptr, CanonicalCircuit::Create(qmodInvalid.get()).get());
+
+        SemanticVerifierPass srcVerifier(std::move(qmodInvalid), Mapping { 0, 1, 2, 3, 4 });
+        srcVerifier.run(QModule::ParseString(prog).get());
+        EXPECT_FALSE(srcVerifier.getData());
+    }
+}
@@ -0,0 +1,210 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/Stats.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace efd;
+
+static Stat<uint32_t> CountStat("TestCount", "Counter used only by the tests.");
+static Stat<double> TimeStat("TestTime", "Time used only by the tests.");
+static DistributionStat SizeStat("TestSize", "Distribution used only by the tests.");
+
+TEST(StatsTests, ContextIsolation) {
+    CountStat = 0;
+
+    auto first = StatsContext::Create();
+    auto second = StatsContext::Create();
+
+    std::thread t1([&]() {
+        StatsScope scope(first.get());
+        for (uint32_t i = 0; i < 1000; ++i) CountStat += 1;
+    });
+
+    std::thread t2([&]() {
+        StatsScope scope(second.get());
+        for (uint32_t i = 0; i < 500; ++i) CountStat += 2;
+        TimeStat = 1.5;
+    });
+
+    t1.join();
+    t2.join();
+
+    ASSERT_EQ(first->get(CountStat.getId()), 1000);
+    ASSERT_EQ(second->get(CountStat.getId()), 1000);
+    ASSERT_EQ(first->get(TimeStat.getId()), 0);
+    ASSERT_EQ(second->get(TimeStat.getId()), 1.5);
+
+    // The global value was never touched.
+    ASSERT_EQ(CountStat.getVal(), 0u);
+}
+
+TEST(StatsTests, NestedScopes) {
+    auto outer = StatsContext::Create();
+    auto inner = StatsContext::Create();
+
+    {
+        StatsScope outerScope(outer.get());
+        CountStat += 3;
+
+        {
+            StatsScope innerScope(inner.get());
+            CountStat += 5;
+            ASSERT_EQ(CountStat.getVal(), 5u);
+        }
+
+        ASSERT_EQ(CountStat.getVal(), 3u);
+        ASSERT_EQ(StatsContext::GetCurrent(), outer.get());
+    }
+
+    ASSERT_TRUE(StatsContext::GetCurrent() == nullptr);
+}
+
+TEST(StatsTests, MergeAndPrint) {
+    auto first = StatsContext::Create();
+    auto second = StatsContext::Create();
+
+    first->set(CountStat.getId(), 4);
+    second->set(CountStat.getId(), 6);
+    second->set(TimeStat.getId(), 2.5);
+
+    first->merge(*second);
+
+    ASSERT_EQ(first->get(CountStat.getId()), 10);
+    ASSERT_EQ(first->get(TimeStat.getId()), 2.5);
+
+    std::ostringstream ss;
+    first->print(ss);
+
+    ASSERT_NE(ss.str().find("10::TestCount::"), std::string::npos);
+    ASSERT_NE(ss.str().find("2.500000::TestTime::"), std::string::npos);
+}
+
+TEST(StatsTests, Aggregate) {
+    StatsAggregate aggregate, other;
+
+    for (uint32_t val : { 1, 3, 0, 12 }) {
+        auto context = StatsContext::Create();
+        context->set(CountStat.getId(), val);
+        aggregate.add(*context);
+    }
+
+    auto context = StatsContext::Create();
+    context->set(CountStat.getId(), 40);
+    other.add(*context);
+
+    aggregate.merge(other);
+
+    auto summary = aggregate.getSummary(CountStat.getId());
+
+    ASSERT_EQ(aggregate.getContexts(), 5u);
+    // Zeroes are not counted.
+    ASSERT_EQ(summary.mCount, 4u);
+    ASSERT_EQ(summary.mSum, 56);
+    ASSERT_EQ(summary.mMin, 1);
+    ASSERT_EQ(summary.mMax, 40);
+
+    // Buckets: [1, 2), [2, 4), [8, 16) and [32, 64).
+    ASSERT_EQ(summary.mHistogram.size(), 4u);
+    ASSERT_EQ(summary.mHistogram[0], 1u);
+    ASSERT_EQ(summary.mHistogram[1], 1u);
+    ASSERT_EQ(summary.mHistogram[3], 1u);
+    ASSERT_EQ(summary.mHistogram[5], 1u);
+}
+
+TEST(StatsTests, DistributionPercentiles) {
+    Distribution distribution;
+
+    for (uint32_t i = 100; i >= 1; --i) {
+        distribution.add(i);
+    }
+
+    ASSERT_EQ(distribution.size(), 100u);
+    ASSERT_EQ(distribution.getSum(), 5050);
+    ASSERT_EQ(distribution.getMin(), 1);
+    ASSERT_EQ(distribution.getMax(), 100);
+    ASSERT_EQ(distribution.getMean(), 50.5);
+    ASSERT_EQ(distribution.getPercentile(50), 50);
+    ASSERT_EQ(distribution.getPercentile(90), 90);
+    ASSERT_EQ(distribution.getPercentile(99), 99);
+    ASSERT_EQ(distribution.getPercentile(0), 1);
+
+    // [0, 1) is empty, [1, 2) has 1, ..., [64, 128) has 37.
+    auto histogram = distribution.getHistogram();
+    ASSERT_EQ(histogram.size(), 7u);
+    ASSERT_EQ(histogram[0], 1u);
+    ASSERT_EQ(histogram[6], 37u);
+
+    ASSERT_EQ(distribution.toString(), "n=100,mean=50.5,p50=50,p90=90,p99=99,max=100");
+}
+
+TEST(StatsTests, DistributionStatInContexts) {
+    auto first = StatsContext::Create();
+    auto second = StatsContext::Create();
+
+    {
+        StatsScope scope(first.get());
+        SizeStat.add(1);
+        SizeStat.add(3);
+    }
+
+    {
+        StatsScope scope(second.get());
+        SizeStat.add(8);
+    }
+
+    ASSERT_TRUE(SizeStat.isZero());
+    ASSERT_EQ(first->getDistribution(SizeStat.getId()).size(), 2u);
+
+    StatsAggregate aggregate;
+    aggregate.add(*first);
+    aggregate.add(*second);
+
+    auto distribution = aggregate.getDistribution(SizeStat.getId());
+    ASSERT_EQ(distribution.size(), 3u);
+    ASSERT_EQ(distribution.getMax(), 8);
+
+    first->merge(*second);
+    ASSERT_EQ(first->getDistribution(SizeStat.getId()).getSum(), 12);
+}
+
+TEST(StatsTests, JSONFormat) {
+    auto context = StatsContext::Create();
+    context->set(CountStat.getId(), 7);
+    context->addSample(SizeStat.getId(), 2);
+    context->addSample(SizeStat.getId(), 4);
+
+    std::ostringstream ss;
+    context->print(ss, StatsFormat::JSON);
+    auto json = ss.str();
+
+    ASSERT_EQ(json.compare(0, 10, "{\"stats\":["), 0);
+    ASSERT_NE(json.find("{\"name\":\"TestCount\",\"description\":"
+                        "\"Counter used only by the tests.\",\"value\":7}"), std::string::npos);
+    ASSERT_NE(json.find("\"distribution\":{\"count\":2,\"sum\":6,\"min\":2,\"max\":4,"
+                        "\"mean\":3,\"p50\":2,\"p90\":4,\"p99\":4,\"histogram\":"
+                        "[{\"begin\":2,\"end\":4,\"count\":1},{\"begin\":4,\"end\":8,\"count\":1}]}"),
+              std::string::npos);
+    // Unlike the text format, zeroes are kept.
+    ASSERT_NE(json.find("{\"name\":\"TestTime\",\"description\":"
+                        "\"Time used only by the tests.\",\"value\":0}"), std::string::npos);
+
+    std::ostringstream text;
+    context->print(text);
+    ASSERT_EQ(text.str().find("TestTime"), std::string::npos);
+}
+
+TEST(StatsTests, AggregateJSONKeepsZeroes) {
+    StatsAggregate aggregate;
+    aggregate.add(*StatsContext::Create());
+
+    std::ostringstream ss;
+    aggregate.print(ss, StatsFormat::JSON);
+    auto json = ss.str();
+
+    ASSERT_NE(json.find("{\"name\":\"TestCount\",\"description\":"
+                        "\"Counter used only by the tests.\",\"count\":0,\"sum\":0,"
+                        "\"min\":0,\"max\":0,\"mean\":0,\"histogram\":[]}"), std::string::npos);
+    ASSERT_NE(json.find("{\"name\":\"TestSize\""), std::string::npos);
+}
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+// Runs the tools built alongside the tests (see tests/CMakeLists.txt).
+static const std::string ToolsDir = EFD_TOOLS_DIR;
+
+static const std::string ArchGraph =
+"\
+1 3\n\
+q 3\n\
+q[0] q[1]\n\
+q[1] q[2]\n\
+";
+
+static const std::string GoodProgram =
+"include \"qelib1.inc\";\nqreg q[3];\ncx q[0], q[2];\n";
+// Semantically invalid: the register 'r' was never declared.
+static const std::string BadProgram =
+"include \"qelib1.inc\";\nqreg q[3];\ncx q[0], r[1];\n";
+
+static std::string GetTestDir(std::string name) {
+    return "efd-tools-test-" + std::to_string(getpid()) + "-" + name;
+}
+
+static void WriteFile(const std::string& path, const std::string& contents) {
+    std::ofstream(path) << contents;
+}
+
+static std::string ReadFile(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// Runs 'efd' with \p args, returning its exit status.
+static int RunEfd(const std::string& args) {
+    int status = std::system((ToolsDir + "/efd " + args + " 2>/dev/null").c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+TEST(ToolsTests, ServerSurvivesInvalidPrograms) {
+    auto dir = GetTestDir("server");
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+
+    auto socket = dir + "/efd.sock";
+    WriteFile(dir + "/arch", ArchGraph);
+    WriteFile(dir + "/good.qasm", GoodProgram);
+    WriteFile(dir + "/bad.qasm", BadProgram);
+
+    pid_t server = fork();
+    ASSERT_NE(-1, server);
+
+    if (server == 0) {
+        freopen("/dev/null", "w", stderr);
+        execl((ToolsDir + "/efd-server").c_str(), "efd-server", "-socket", socket.c_str(), nullptr);
+        _exit(127);
+    }
+
+    struct stat st;
+    for (uint32_t i = 0; i < 500 && stat(socket.c_str(), &st) != 0; ++i) usleep(10000);
+
+    auto client = "-arch-file " + dir + "/arch --connect " + socket + " -o " + dir + "/out.qasm ";
+
+    EXPECT_EQ(1, RunEfd(client + "-i " + dir + "/bad.qasm"));
+    // The same server still answers the next request.
+    EXPECT_EQ(0, kill(server, 0));
+    EXPECT_EQ(0, RunEfd(client + "-i " + dir + "/good.qasm"));
+    EXPECT_NE(std::string::npos, ReadFile(dir + "/out.qasm").find("qreg q[3];"));
+
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+
+    std::system(("rm -rf " + dir).c_str());
+}
+
+TEST(ToolsTests, BatchSurvivesInvalidPrograms) {
+    auto dir = GetTestDir("batch");
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+    ASSERT_EQ(0, mkdir((dir + "/in").c_str(), 0755));
+
+    WriteFile(dir + "/arch", ArchGraph);
+    WriteFile(dir + "/in/a_bad.qasm", BadProgram);
+    WriteFile(dir + "/in/b_good.qasm", GoodProgram);
+
+    // The invalid file fails on its own: the others are still compiled.
+    EXPECT_EQ(1, RunEfd("-batch " + dir + "/in -o " + dir + "/out -j 2 -arch-file " + dir + "/arch"));
+    EXPECT_NE(std::string::npos, ReadFile(dir + "/out/b_good.qasm").find("qreg q[3];"));
+
+    auto stats = ReadFile(dir + "/out/batch.stats");
+    EXPECT_NE(std::string::npos, stats.find("PARSE_ERROR::a_bad.qasm::"));
+    EXPECT_NE(std::string::npos, stats.find("OK::b_good.qasm::"));
+
+    std::system(("rm -rf " + dir).c_str());
+}
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/Tracer.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace efd;
+
+static uint32_t Count(const std::string& str, const std::string& pattern) {
+    uint32_t count = 0;
+
+    for (auto i = str.find(pattern); i != std::string::npos; i = str.find(pattern, i + 1)) {
+        ++count;
+    }
+
+    return count;
+}
+
+TEST(TracerTests, NothingRecordedWhenDisabled) {
+    Tracer::Clear();
+
+    {
+        TraceSpan span("disabled");
+        Tracer::AddCounter("disabled counter", 1);
+    }
+
+    std::ostringstream ss;
+    Tracer::Write(ss);
+
+    ASSERT_EQ(Count(ss.str(), "disabled"), 0u);
+}
+
+TEST(TracerTests, SpansAndCounters) {
+    Tracer::Clear();
+    Tracer::Enable();
+    Tracer::SetThreadName("tester");
+
+    {
+        TraceSpan outer("outer");
+        TraceSpan inner(std::string("inner \"quoted\""));
+        Tracer::AddCounter("counter", 42);
+    }
+
+    std::thread worker([]() {
+        TraceSpan span("worker span");
+    });
+
+    worker.join();
+    Tracer::Enable(false);
+
+    std::ostringstream ss;
+    Tracer::Write(ss);
+    auto trace = ss.str();
+
+    ASSERT_EQ(Count(trace, "\"ph\":\"X\""), 3u);
+    ASSERT_EQ(Count(trace, "\"ph\":\"C\""), 1u);
+    ASSERT_EQ(Count(trace, "\"name\":\"tester\""), 1u);
+    ASSERT_EQ(Count(trace, "\"value\":42.000"), 1u);
+    ASSERT_EQ(Count(trace, "inner \\\"quoted\\\""), 1u);
+
+    // The worker has its own track.
+    auto outerTid = trace.substr(trace.find("\"tid\":", trace.find("\"outer\"")), 8);
+    auto workerTid = trace.substr(trace.find("\"tid\":", trace.find("\"worker span\"")), 8);
+    ASSERT_NE(outerTid, workerTid);
+
+    Tracer::Clear();
+}
@@ -0,0 +1,54 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/UnixSocket.h"
+
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace efd;
+
+static std::string GetSocketPath() {
+    return "efd-test-" + std::to_string(getpid()) + ".sock";
+}
+
+TEST(UnixSocketTests, EchoTest) {
+    auto path = GetSocketPath();
+
+    auto listener = UnixSocket::Listen(path);
+    ASSERT_FALSE(listener.get() == nullptr);
+
+    // Answers every message with itself.
+    std::thread server([&]() {
+        auto conn = listener->accept();
+        std::string message;
+
+        while (conn->receive(message)) {
+            conn->send(message);
+        }
+    });
+
+    auto conn = UnixSocket::Connect(path);
+    ASSERT_FALSE(conn.get() == nullptr);
+
+    std::vector<std::string> messages {
+        "qreg q[5];", "", std::string(1 << 20, 'x'), std::string("a\0b", 3)
+    };
+
+    std::string answer;
+
+    for (auto& message : messages) {
+        ASSERT_TRUE(conn->send(message));
+        ASSERT_TRUE(conn->receive(answer));
+        ASSERT_EQ(message, answer);
+    }
+
+    conn.reset(nullptr);
+    server.join();
+}
+
+TEST(UnixSocketTests, NoListenerTest) {
+    auto conn = UnixSocket::Connect(GetSocketPath() + ".none");
+    ASSERT_TRUE(conn.get() == nullptr);
+}
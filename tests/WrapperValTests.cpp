@@ -0,0 +1,44 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/WrapperVal.h"
+
+#include <string>
+
+using namespace efd;
+
+TEST(WrapperValTests, IntValTest) {
+    IntVal val("42");
+    ASSERT_EQ(val.mV, 42);
+    ASSERT_TRUE(val.mStr == nullptr);
+    ASSERT_EQ(std::to_string(val), "42");
+}
+
+TEST(WrapperValTests, RealValTest) {
+    std::vector<std::string> reals = { "1.5", ".5", "3.", "1e3", "2.5E-2", "0.000000" };
+
+    for (auto str : reals) {
+        RealVal val(str);
+        ASSERT_DOUBLE_EQ(val.mV, std::stod(str));
+        ASSERT_EQ(std::to_string(val), str);
+    }
+}
+
+TEST(WrapperValTests, EqualityComparesValuesTest) {
+    ASSERT_TRUE(RealVal("1.50") == RealVal("1.5"));
+    ASSERT_TRUE(RealVal("1e1") == RealVal("10."));
+    ASSERT_TRUE(IntVal("3") != IntVal("4"));
+}
+
+TEST(WrapperValTests, SharedStringsTest) {
+    RealVal a("1.50");
+    ASSERT_FALSE(a.mStr == nullptr);
+
+    {
+        RealVal b = a;
+        ASSERT_EQ(a.mStr, b.mStr);
+        ASSERT_EQ(a.mStr.use_count(), 2);
+    }
+
+    // Nothing else keeps it alive.
+    ASSERT_EQ(a.mStr.use_count(), 1);
+}
@@ -32,7 +32,7 @@ qreg q[5];\
         ASSERT_TRUE(data.getQUId("q[3]") == 3);
         ASSERT_TRUE(data.getQUId("q[4]") == 4);
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 
     {
@@ -62,7 +62,7 @@ gate mygate(a, b, c) x, y, z {\
         ASSERT_TRUE(data.getQUId("y", gate) == 1);
         ASSERT_TRUE(data.getQUId("z", gate) == 2);
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 
     {
@@ -122,6 +122,6 @@ measure q[4] -> c[4];\
         ASSERT_TRUE(data.getQUId("q[3]") == 3);
         ASSERT_TRUE(data.getQUId("q[4]") == 4);
 
-        PassCache::Clear();
+        PassCache::Clear(qmod.get());
     }
 }
@@ -0,0 +1,529 @@
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Transform/QModule.h"
+#include "enfield/Transform/Driver.h"
+#include "enfield/Transform/Compiler.h"
+#include "enfield/Transform/Allocators/Allocators.h"
+#include "enfield/Arch/Architectures.h"
+#include "enfield/Support/Stats.h"
+#include "enfield/Support/JSON.h"
+#include "enfield/Support/Timer.h"
+#include "enfield/Support/Defs.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <map>
+#include <cmath>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using namespace efd;
+
+static Opt<std::string> FilesPath
+("files", "Directory with the '.qasm' files to be benchmarked.", "tests/files", false);
+static Opt<std::vector<std::string>> AllocNames
+("alloc", "Allocator to be benchmarked (may be repeated). Default: all of them.", {}, false);
+static Opt<std::vector<std::string>> ArchNames
+("arch", "Architecture to be benchmarked (may be repeated). Default: all of them.", {}, false);
+
+static Opt<uint32_t> GenPrograms
+("gen", "Number of programs generated (as 'gen-prog' does) per architecture.", 3, false);
+static Opt<uint32_t> GenDeps
+("gen-deps", "Number of dependencies of the first generated program. \
+The i-th one has i times as many.", 100, false);
+static Opt<uint32_t> Seed
+("seed", "Seed of the generated programs and of the allocators.", 0, false);
+
+static Opt<uint32_t> Runs
+("runs", "Number of times each compilation is run. The fastest one is kept.", 3, false);
+static Opt<uint32_t> Timeout
+("timeout", "Seconds each compilation may take before it is killed.", 60, false);
+static Opt<uint32_t> DynprogMaxQubits
+("dynprog-max-qubits", "Largest architecture in which 'Q_dynprog' runs \
+(its memory grows with the factorial of the number of qubits).", 8, false);
+static Opt<bool> NoVerify
+("no-verify", "Does not verify the compiled programs.", false, false);
+static Opt<bool> Verbose
+("verbose", "Does not discard the output of the compilations.", false, false);
+
+static Opt<std::string> OutFilepath
+("o", "File where the results (JSON) are written.", "efd-bench.json", false);
+static Opt<std::string> BaselinePath
+("baseline", "Results of a previous run. The regressions are reported, \
+and the exit code is 1 if there is any.", "", false);
+static Opt<double> Threshold
+("threshold", "Relative increase (e.g.: 0.1 is 10%) over the baseline \
+considered a regression.", 0.1, false);
+static Opt<double> MinTime
+("min-time", "Time (in seconds) below which time regressions are ignored.", 0.05, false);
+
+namespace {
+    /// \brief One program to be benchmarked: either a file or a program
+    /// generated for one architecture.
+    struct BenchInput {
+        std::string mName;
+        std::string mPath;
+        uint32_t mDeps;
+        uint32_t mSeed;
+    };
+
+    /// \brief The result of compiling one input, in one architecture, with
+    /// one allocator.
+    struct BenchRun {
+        std::string mInput;
+        std::string mArch;
+        std::string mAllocator;
+        /// \brief One of: ok, failed, timeout or crashed.
+        std::string mStatus;
+        /// \brief Wall time of the compilation, in seconds.
+        double mTime;
+        /// \brief Peak resident set size of the compilation, in KB.
+        double mPeakRSS;
+        double mTotalCost;
+        /// \brief Number of statements of the compiled program.
+        double mGates;
+    };
+}
+
+static CompilationSettings GetSettings(ArchGraph::sRef archGraph, EnumAllocator alloc) {
+    AllocatorOptions options;
+    options.seed = Seed.getVal();
+
+    return CompilationSettings {
+        archGraph,
+        alloc,
+        DefaultBasis,
+        false,
+        !NoVerify.getVal(),
+        false,
+        1,
+        options
+    };
+}
+
+// ----------------------------------------------------------------
+// ---------------------------- Inputs ----------------------------
+// ----------------------------------------------------------------
+
+// Collects the '.qasm' files inside \p dir, in a sorted order.
+static std::vector<BenchInput> CollectFiles(const std::string& dir) {
+    std::vector<BenchInput> inputs;
+    DIR* d = opendir(dir.c_str());
+
+    if (d == nullptr) {
+        WAR << "Could not open directory: `" << dir << "`." << std::endl;
+        return inputs;
+    }
+
+    std::vector<std::string> names;
+
+    for (struct dirent* entry = readdir(d); entry != nullptr; entry = readdir(d)) {
+        std::string name = entry->d_name;
+
+        if (name.size() > 5 && name.compare(name.size() - 5, 5, ".qasm") == 0) {
+            names.push_back(name);
+        }
+    }
+
+    closedir(d);
+    std::sort(names.begin(), names.end());
+
+    for (auto& name : names) {
+        inputs.push_back({ name, dir + "/" + name, 0, 0 });
+    }
+
+    return inputs;
+}
+
+// The programs generated for an architecture of \p qubits qubits.
+static std::vector<BenchInput> GetGeneratedInputs(uint32_t qubits) {
+    std::vector<BenchInput> inputs;
+
+    for (uint32_t i = 1; i <= GenPrograms.getVal(); ++i) {
+        uint32_t deps = GenDeps.getVal() * i;
+        uint32_t seed = Seed.getVal() + i;
+
+        inputs.push_back({
+            "gen-prog-q" + std::to_string(qubits) +
+            "-d" + std::to_string(deps) +
+            "-s" + std::to_string(seed),
+            "",
+            deps,
+            seed
+        });
+    }
+
+    return inputs;
+}
+
+// Generates the same kind of program 'gen-prog' does: \p deps CNOTs between
+// distinct qubits, chosen uniformly at random (but from a fixed \p seed).
+static std::string GenerateProgram(uint32_t qubits, uint32_t deps, uint32_t seed) {
+    std::ostringstream ss;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> runit(0, qubits * (qubits - 1) - 1);
+
+    ss << "include \"qelib1.inc\";" << std::endl;
+    ss << "qreg q[" << qubits << "];" << std::endl;
+
+    for (uint32_t i = 0; i < deps; ++i) {
+        uint32_t x = runit(rng);
+        uint32_t u = x / (qubits - 1), v = x % (qubits - 1);
+        if (v >= u) ++v;
+
+        ss << "cx q[" << u << "], q[" << v << "];" << std::endl;
+    }
+
+    return ss.str();
+}
+
+// ----------------------------------------------------------------
+// --------------------------- Running ----------------------------
+// ----------------------------------------------------------------
+
+// Runs in the forked process: compiles \p input and writes
+// 'time cost gates' to \p fd. Never returns.
+static void CompileInChild(const BenchInput& input, ArchGraph::sRef archGraph,
+                           EnumAllocator alloc, int fd) {
+    if (!Verbose.getVal()) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
+
+    alarm(Timeout.getVal());
+
+    auto stats = StatsContext::Create();
+    StatsScope scope(stats.get());
+
+    QModule::uRef qmod = input.mPath.empty() ?
+        QModule::ParseString(GenerateProgram(archGraph->size(), input.mDeps, input.mSeed)) :
+        ParseFile(input.mPath);
+
+    if (qmod.get() == nullptr) _exit(1);
+
+    Compiler compiler(GetSettings(archGraph, alloc));
+    Timer timer;
+
+    timer.start();
+    bool compiled = compiler.compile(qmod.get());
+    timer.stop();
+
+    if (!compiled) _exit(1);
+
+    std::ostringstream ss;
+    ss.precision(10);
+    ss << (double) timer.getMicroseconds() / 1000000.0 << " "
+       << TotalCost.getVal() << " "
+       << (qmod->stmt_end() - qmod->stmt_begin()) << std::endl;
+
+    auto result = ss.str();
+    ssize_t written = write(fd, result.c_str(), result.size());
+    _exit(written == (ssize_t) result.size() ? 0 : 1);
+}
+
+// Compiles \p input 'Runs' times, each in a forked process. So, each one has
+// its own peak RSS, and a crash (or a timeout) does not stop the benchmark.
+static BenchRun Compile(const BenchInput& input, ArchGraph::sRef archGraph,
+                        const std::string& archName, EnumAllocator alloc) {
+    BenchRun run {
+        input.mName,
+        archName,
+        alloc.getStringValue(),
+        "ok",
+        std::numeric_limits<double>::infinity(),
+        0, 0, 0
+    };
+
+    for (uint32_t i = 0; i < Runs.getVal() && run.mStatus == "ok"; ++i) {
+        int fds[2];
+
+        if (pipe(fds) != 0) {
+            ERR << "Could not create a pipe." << std::endl;
+            run.mStatus = "failed";
+            break;
+        }
+
+        pid_t pid = fork();
+
+        if (pid == 0) {
+            close(fds[0]);
+            CompileInChild(input, archGraph, alloc, fds[1]);
+        }
+
+        close(fds[1]);
+
+        if (pid < 0) {
+            ERR << "Could not fork the compilation." << std::endl;
+            close(fds[0]);
+            run.mStatus = "failed";
+            break;
+        }
+
+        std::string output;
+        char buf[256];
+
+        for (ssize_t n; (n = read(fds[0], buf, sizeof(buf))) > 0;) {
+            output.append(buf, n);
+        }
+
+        close(fds[0]);
+
+        int status;
+        struct rusage usage;
+        wait4(pid, &status, 0, &usage);
+
+        if (WIFSIGNALED(status)) {
+            run.mStatus = (WTERMSIG(status) == SIGALRM) ? "timeout" : "crashed";
+            break;
+        }
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            run.mStatus = "failed";
+            break;
+        }
+
+        double time;
+        std::istringstream(output) >> time >> run.mTotalCost >> run.mGates;
+
+        // 'ru_maxrss' is in bytes on macOS, and in KB elsewhere.
+#ifdef __APPLE__
+        double rss = (double) usage.ru_maxrss / 1024.0;
+#else
+        double rss = (double) usage.ru_maxrss;
+#endif
+
+        run.mTime = std::min(run.mTime, time);
+        run.mPeakRSS = std::max(run.mPeakRSS, rss);
+    }
+
+    if (run.mStatus != "ok") run.mTime = 0;
+    return run;
+}
+
+// ----------------------------------------------------------------
+// --------------------------- Results ----------------------------
+// ----------------------------------------------------------------
+
+static std::string GetKey(const BenchRun& run) {
+    return run.mInput + "@" + run.mArch + "@" + run.mAllocator;
+}
+
+// Writes one run per line, so that the files are easily diffed.
+static void WriteRuns(std::ostream& out, const std::vector<BenchRun>& runs) {
+    out.precision(10);
+    out << "{\"runs\":[" << std::endl;
+
+    for (uint32_t i = 0, e = runs.size(); i < e; ++i) {
+        auto& run = runs[i];
+
+        out << "{\"input\":" << ToJSONString(run.mInput)
+            << ",\"arch\":" << ToJSONString(run.mArch)
+            << ",\"allocator\":" << ToJSONString(run.mAllocator)
+            << ",\"status\":" << ToJSONString(run.mStatus)
+            << ",\"time\":" << run.mTime
+            << ",\"peak_rss_kb\":" << run.mPeakRSS
+            << ",\"total_cost\":" << run.mTotalCost
+            << ",\"gates\":" << run.mGates
+            << "}" << ((i + 1 < e) ? "," : "") << std::endl;
+    }
+
+    out << "]}" << std::endl;
+}
+
+// Reads the runs written by \em WriteRuns. Only flat objects (i.e.: the runs)
+// are read: their string and number fields.
+static bool ReadRuns(const std::string& path, std::vector<BenchRun>& runs) {
+    std::ifstream in(path);
+
+    if (!in.is_open()) {
+        ERR << "Could not open baseline: `" << path << "`." << std::endl;
+        return false;
+    }
+
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string json = ss.str();
+
+    for (auto begin = json.find('{'); begin != std::string::npos; begin = json.find('{', begin + 1)) {
+        auto end = json.find_first_of("{}", begin + 1);
+        if (end == std::string::npos || json[end] != '}') continue;
+
+        std::map<std::string, std::string> fields;
+
+        for (auto i = json.find('"', begin); i < end; i = json.find('"', i)) {
+            auto keyEnd = json.find('"', i + 1);
+            auto colon = json.find(':', keyEnd);
+            auto key = json.substr(i + 1, keyEnd - i - 1);
+            auto valBegin = json.find_first_not_of(" \t\n", colon + 1);
+            std::string val;
+
+            if (json[valBegin] == '"') {
+                for (i = valBegin + 1; i < end && json[i] != '"'; ++i) {
+                    if (json[i] == '\\') ++i;
+                    val += json[i];
+                }
+
+                ++i;
+            } else {
+                i = json.find_first_of(",}", valBegin);
+                val = json.substr(valBegin, i - valBegin);
+            }
+
+            fields[key] = val;
+        }
+
+        if (fields.count("input") == 0) continue;
+
+        runs.push_back({
+            fields["input"],
+            fields["arch"],
+            fields["allocator"],
+            fields["status"],
+            std::atof(fields["time"].c_str()),
+            std::atof(fields["peak_rss_kb"].c_str()),
+            std::atof(fields["total_cost"].c_str()),
+            std::atof(fields["gates"].c_str())
+        });
+    }
+
+    return true;
+}
+
+// Prints every regression of \p runs (w.r.t. \p baseline), and returns
+// how many there are.
+static uint32_t CompareWithBaseline(const std::vector<BenchRun>& runs,
+                                    const std::vector<BenchRun>& baseline) {
+    std::map<std::string, const BenchRun*> base;
+    for (auto& run : baseline) base[GetKey(run)] = &run;
+
+    uint32_t regressions = 0, compared = 0;
+    double limit = 1.0 + Threshold.getVal();
+
+    for (auto& run : runs) {
+        auto it = base.find(GetKey(run));
+        if (it == base.end()) continue;
+
+        auto& old = *it->second;
+        ++compared;
+
+        std::vector<std::string> reasons;
+
+        if (old.mStatus == "ok" && run.mStatus != "ok") {
+            reasons.push_back("status: ok -> " + run.mStatus);
+        }
+
+        if (old.mStatus == "ok" && run.mStatus == "ok") {
+            struct { const char* mName; double mOld; double mNew; } metrics[] = {
+                { "time", old.mTime, run.mTime },
+                { "peak_rss_kb", old.mPeakRSS, run.mPeakRSS },
+                { "total_cost", old.mTotalCost, run.mTotalCost },
+                { "gates", old.mGates, run.mGates }
+            };
+
+            for (auto& m : metrics) {
+                if (std::string(m.mName) == "time" && m.mNew < MinTime.getVal()) continue;
+
+                if (m.mNew > m.mOld * limit) {
+                    std::ostringstream ss;
+                    ss << m.mName << ": " << m.mOld << " -> " << m.mNew;
+                    if (m.mOld > 0) ss << " (+" << std::lround((m.mNew / m.mOld - 1.0) * 100) << "%)";
+                    reasons.push_back(ss.str());
+                }
+            }
+        }
+
+        for (auto& reason : reasons) {
+            std::cerr << "REGRESSION " << run.mInput << " " << run.mArch << " "
+                      << run.mAllocator << ": " << reason << std::endl;
+        }
+
+        if (!reasons.empty()) ++regressions;
+    }
+
+    std::cerr << regressions << " regression(s) in " << compared
+              << " run(s) compared with the baseline." << std::endl;
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    InitializeAllQbitAllocators();
+    InitializeAllArchitectures();
+
+    ParseArguments(argc, argv);
+
+    auto allocNames = AllocNames.getVal();
+    auto archNames = ArchNames.getVal();
+
+    if (allocNames.empty()) allocNames = EnumAllocator::List();
+    if (archNames.empty()) archNames = EnumArchitecture::List();
+
+    for (auto& name : allocNames) {
+        if (!EnumAllocator::Has(name)) {
+            ERR << "Allocator: " << name << " not found." << std::endl;
+            return 1;
+        }
+    }
+
+    for (auto& name : archNames) {
+        if (!EnumArchitecture::Has(name)) {
+            ERR << "Architecture: " << name << " not found." << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BenchInput> files;
+    if (!FilesPath.getVal().empty()) files = CollectFiles(FilesPath.getVal());
+
+    std::vector<BenchRun> runs;
+
+    for (auto& archName : archNames) {
+        EnumArchitecture arch(archName);
+        if (!HasArchitecture(arch)) continue;
+
+        ArchGraph::sRef archGraph = CreateArchitecture(arch);
+
+        auto inputs = files;
+        auto generated = GetGeneratedInputs(archGraph->size());
+        inputs.insert(inputs.end(), generated.begin(), generated.end());
+
+        for (auto& allocName : allocNames) {
+            EnumAllocator alloc(allocName);
+
+            if (alloc.getValue() == Allocator::Q_dynprog &&
+                    archGraph->size() > DynprogMaxQubits.getVal()) {
+                continue;
+            }
+
+            for (auto& input : inputs) {
+                runs.push_back(Compile(input, archGraph, archName, alloc));
+
+                auto& run = runs.back();
+                std::cerr << run.mInput << " " << run.mArch << " " << run.mAllocator
+                          << ": " << run.mStatus;
+                if (run.mStatus == "ok") std::cerr << " (" << run.mTime << "s)";
+                std::cerr << std::endl;
+            }
+        }
+    }
+
+    std::ofstream out(OutFilepath.getVal());
+    WriteRuns(out, runs);
+    out.close();
+
+    if (BaselinePath.isParsed()) {
+        std::vector<BenchRun> baseline;
+        if (!ReadRuns(BaselinePath.getVal(), baseline)) return 1;
+        if (CompareWithBaseline(runs, baseline) > 0) return 1;
+    }
+
+    return 0;
+}
@@ -1,29 +1,58 @@
 #include "enfield/Support/CommandLine.h"
 #include "enfield/Transform/QModule.h"
 #include "enfield/Transform/Driver.h"
+#include "enfield/Transform/Compiler.h"
+#include "enfield/Transform/CompilationCache.h"
+#include "enfield/Transform/PassProfiler.h"
 #include "enfield/Transform/Allocators/Allocators.h"
 #include "enfield/Arch/Architectures.h"
 #include "enfield/Support/Stats.h"
+#include "enfield/Support/Timer.h"
+#include "enfield/Support/Tracer.h"
+#include "enfield/Support/MappedFile.h"
+#include "enfield/Support/UnixSocket.h"
+#include "enfield/Support/RTTI.h"
 #include "enfield/Support/Defs.h"
 
 #include <fstream>
+#include <algorithm>
 #include <cassert>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+#include <sstream>
+#include <cstring>
+
+#include <dirent.h>
+#include <sys/stat.h>
 
 using namespace efd;
 
 static Opt<std::string> InFilepath
-("i", "The input file.", "/dev/stdin", true);
+("i", "The input file.", "/dev/stdin", false);
 static Opt<std::string> OutFilepath
 ("o", "The output file.", "/dev/stdout", false);
 static Opt<std::string> ArchFilepath
 ("arch-file", "An input file for using a custom architecture.", "", false);
+static Opt<uint32_t> ParseThreads
+("-parse-threads", "Number of threads used for parsing the input file.", 1, false);
+static Opt<uint32_t> VerifyThreads
+("-verify-threads", "Number of threads used for verifying the architecture constraints.", 1, false);
 
 static Opt<bool> NoPretty
 ("-no-pretty", "Print in a pretty format (negation).", false, false);
 static Opt<bool> ShowStats
 ("stats", "Print statistical data collected.", false, false);
+static Opt<std::string> StatsFormatName
+("stats-format", "Format of the stats printed: 'text' or 'json'.", "text", false);
+static Opt<bool> TimePasses
+("-time-passes", "Print the time (and memory) spent by each pass.", false, false);
+static Opt<std::string> TracePath
+("trace", "Write a trace of the compilation (Chrome trace-event JSON) to this file.", "", false);
 static Opt<bool> Reorder
 ("ord", "Order the program input.", false, false);
+static Opt<bool> Commute
+("commute", "Let gates that commute be reordered.", false, false);
 static Opt<bool> NoVerify
 ("-no-verify", "Verify the compiled code (negation).", false, false);
 static Opt<bool> Force
@@ -35,6 +64,44 @@ static efd::Opt<EnumArchitecture> Arch
 ("arch", "Name of the architechture, or a file with the connectivity graph.",
 Architecture::A_ibmqx2, false);
 
+// The allocator options only fill the defaults of the compilation settings.
+static const AllocatorOptions DefaultOptions;
+
+static Opt<uint32_t> SwapCost
+("-swap-cost", "Cost of using a swap function.", DefaultOptions.swapCost, false);
+static Opt<uint32_t> RevCost
+("-rev-cost", "Cost of using a reverse edge.", DefaultOptions.revCost, false);
+static Opt<uint32_t> LCXCost
+("-lcx-cost", "Cost of using long cnot gate.", DefaultOptions.lcxCost, false);
+static Opt<uint32_t> Seed
+("seed", "Seed to be used in the RandomQbitAllocator.", DefaultOptions.seed, false);
+static Opt<uint32_t> Trials
+("trials", "Number of times that IBMQAllocator should try.", DefaultOptions.trials, false);
+static Opt<uint32_t> MaxChildren
+("-bsi-max-children", "Limits the max number of children per partial solution.",
+ DefaultOptions.maxChildren, false);
+static Opt<uint32_t> MaxPartialSolutions
+("-bsi-max-partial", "Limits the max number of partial solutions per step.",
+ DefaultOptions.maxPartialSolutions, false);
+
+static Opt<std::string> BatchPath
+("batch", "A directory (or a file listing one input per line) to be compiled at once. \
+The outputs mirror it inside the '-o' directory.", "", false);
+static Opt<uint32_t> Jobs
+("j", "Number of files compiled in parallel, in batch mode.", 1, false);
+
+static Opt<std::string> ConnectPath
+("-connect", "Compile through the 'efd-server' listening at this socket.", "", false);
+
+static Opt<uint32_t> ChunkSize
+("-chunk-size", "Only flatten and inline the input (no allocation), reading and writing \
+it in chunks of this many statements.", 0, false);
+
+static Opt<std::string> CacheDir
+("-cache-dir", "Directory where the compiled programs are cached (by contents and settings).", "", false);
+static Opt<uint32_t> CacheSize
+("-cache-size", "Maximum size (in MiB) of the compilation cache.", 256, false);
+
 static Opt<std::string> PrintDepGraphFile
 ("-print-depgraph", "Choose a file to print the dependency graph.", "", false);
 static Opt<std::string> PrintArchGraphFile
@@ -46,62 +113,550 @@ static void DumpToOutFile(QModule* qmod) {
     O.close();
 }
 
-int main(int argc, char** argv) {
-    InitializeAllQbitAllocators();
-    InitializeAllArchitectures();
+static ArchGraph::sRef GetArchGraph() {
+    ArchGraph::sRef archGraph;
 
-    ParseArguments(argc, argv);
-    QModule::uRef qmod = ParseFile(InFilepath.getVal());
-
-    if (qmod.get() != nullptr) {
-        ArchGraph::sRef archGraph;
-        if (!ArchFilepath.isParsed() && HasArchitecture(Arch.getVal())) {
-            archGraph = CreateArchitecture(Arch.getVal());
-        } else if (ArchFilepath.isParsed()) {
-            archGraph = ArchGraph::Read(ArchFilepath.getVal());
-        } else {
-            ERR << "Architecture: " << Arch.getVal().getStringValue()
-                << " not found." << std::endl;
+    if (!ArchFilepath.isParsed() && HasArchitecture(Arch.getVal())) {
+        archGraph = CreateArchitecture(Arch.getVal());
+    } else if (ArchFilepath.isParsed()) {
+        archGraph = ArchGraph::Read(ArchFilepath.getVal());
+    } else {
+        ERR << "Architecture: " << Arch.getVal().getStringValue()
+            << " not found." << std::endl;
+    }
+
+    if (archGraph.get() != nullptr && PrintArchGraphFile.isParsed()) {
+        std::ofstream ofs(PrintArchGraphFile.getVal());
+        ofs << archGraph->dotify() << std::endl;
+        ofs.close();
+    }
+
+    return archGraph;
+}
+
+static StatsFormat GetStatsFormat() {
+    if (StatsFormatName.getVal() == "json") return StatsFormat::JSON;
+
+    if (StatsFormatName.getVal() != "text") {
+        WAR << "Unknown stats format `" << StatsFormatName.getVal()
+            << "`. Using 'text'." << std::endl;
+    }
+
+    return StatsFormat::Text;
+}
+
+static AllocatorOptions GetAllocatorOptions() {
+    AllocatorOptions options;
+    options.swapCost = SwapCost.getVal();
+    options.revCost = RevCost.getVal();
+    options.lcxCost = LCXCost.getVal();
+    options.seed = Seed.getVal();
+    options.trials = Trials.getVal();
+    options.maxChildren = MaxChildren.getVal();
+    options.maxPartialSolutions = MaxPartialSolutions.getVal();
+    return options;
+}
+
+static CompilationSettings GetSettings(ArchGraph::sRef archGraph) {
+    return CompilationSettings {
+        archGraph,
+        Alloc.getVal(),
+        DefaultBasis,
+        Reorder.getVal(),
+        !NoVerify.getVal(),
+        Force.getVal(),
+        VerifyThreads.getVal(),
+        GetAllocatorOptions(),
+        Commute.getVal()
+    };
+}
+
+// ----------------------------------------------------------------
+// -------------------------- Batch Mode --------------------------
+// ----------------------------------------------------------------
+
+namespace {
+    /// \brief One file of the batch: where it is, and where (relative to the
+    /// output directory) its output goes.
+    struct BatchInput {
+        std::string mPath;
+        std::string mRelPath;
+    };
+
+    /// \brief The outcome of compiling one file of the batch.
+    struct BatchResult {
+        enum Status { S_OK, S_PARSE_ERROR, S_FAILED };
+
+        Status mStatus;
+        double mParseTime;
+        double mCompileTime;
+        uint32_t mStmts;
+        StatsContext::sRef mStats;
+    };
+}
+
+static bool IsDirectory(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool EndsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() &&
+        str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Collects every '.qasm' file inside \p dir (recursively), in a sorted order.
+static void CollectDirectory(const std::string& dir, const std::string& rel,
+                             std::vector<BatchInput>& inputs) {
+    DIR* d = opendir(dir.c_str());
+
+    if (d == nullptr) {
+        ERR << "Could not open directory: `" << dir << "`." << std::endl;
+        return;
+    }
+
+    std::vector<std::string> entries;
+
+    for (struct dirent* entry = readdir(d); entry != nullptr; entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") entries.push_back(name);
+    }
+
+    closedir(d);
+    std::sort(entries.begin(), entries.end());
+
+    for (auto& name : entries) {
+        auto path = dir + "/" + name;
+
+        if (IsDirectory(path)) {
+            CollectDirectory(path, rel + name + "/", inputs);
+        } else if (EndsWith(name, ".qasm")) {
+            inputs.push_back({ path, rel + name });
         }
+    }
+}
+
+// Reads one input per line of \p list. Relative paths are mirrored as they are.
+// Absolute paths (or the ones that go up) are put directly in the output directory.
+static void CollectList(const std::string& list, std::vector<BatchInput>& inputs) {
+    std::ifstream in(list);
+
+    for (std::string line; std::getline(in, line);) {
+        if (line.empty()) continue;
 
-        if (PrintArchGraphFile.isParsed()) {
-            std::ofstream ofs(PrintArchGraphFile.getVal());
-            ofs << archGraph->dotify() << std::endl;
-            ofs.close();
+        std::string rel = line;
+        while (rel.compare(0, 2, "./") == 0) rel = rel.substr(2);
+
+        if (rel[0] == '/' || rel.find("..") != std::string::npos) {
+            rel = rel.substr(rel.find_last_of('/') + 1);
+        }
+
+        inputs.push_back({ line, rel });
+    }
+}
+
+// Creates every directory in the path of the file \p filepath.
+static void CreateParentDirectories(const std::string& filepath) {
+    for (auto i = filepath.find('/', 1); i != std::string::npos; i = filepath.find('/', i + 1)) {
+        mkdir(filepath.substr(0, i).c_str(), 0755);
+    }
+}
+
+static BatchResult CompileBatchInput(const BatchInput& input, const std::string& outdir,
+                                     const Compiler& compiler) {
+    BatchResult result { BatchResult::S_OK, 0, 0, 0, StatsContext::Create() };
+    StatsScope scope(result.mStats.get());
+    TraceSpan span(input.mRelPath);
+    Timer timer;
+
+    timer.start();
+    QModule::uRef qmod = ParseFile(input.mPath);
+    timer.stop();
+    result.mParseTime = (double) timer.getMicroseconds() / 1000000.0;
+
+    if (qmod.get() == nullptr) {
+        result.mStatus = BatchResult::S_PARSE_ERROR;
+        return result;
+    }
+
+    timer.start();
+    bool compiled = compiler.compile(qmod.get());
+    timer.stop();
+    result.mCompileTime = (double) timer.getMicroseconds() / 1000000.0;
+
+    if (!compiled) {
+        result.mStatus = BatchResult::S_FAILED;
+        return result;
+    }
+
+    result.mStmts = qmod->stmt_end() - qmod->stmt_begin();
+
+    auto outpath = outdir + "/" + input.mRelPath;
+    CreateParentDirectories(outpath);
+
+    std::ofstream O(outpath);
+    PrintToStream(qmod.get(), O, !NoPretty.getVal());
+    O.close();
+
+    if (ShowStats.getVal()) {
+        std::ofstream S(outpath + ".stats");
+        result.mStats->print(S, GetStatsFormat());
+        S.close();
+    }
+
+    return result;
+}
+
+// Compiles every input of the batch with a pool of 'Jobs' workers, sharing
+// one compiler (i.e.: the architecture and its caches) and the parsed
+// standard library. Writes one line
+// of stats for each of them to '<outdir>/batch.stats', in order.
+//
+// Each file is compiled with its own \em StatsContext. If '-stats' is given,
+// they are written next to each output ('<outdir>/<file>.stats'), and their
+// aggregation is printed in the end.
+//
+// Returns false if any of the inputs could not be compiled.
+static bool CompileBatch(ArchGraph::sRef archGraph) {
+    std::vector<BatchInput> inputs;
+
+    if (IsDirectory(BatchPath.getVal())) {
+        CollectDirectory(BatchPath.getVal(), "", inputs);
+    } else {
+        CollectList(BatchPath.getVal(), inputs);
+    }
+
+    if (!OutFilepath.isParsed()) {
+        ERR << "Batch mode needs an output directory ('-o')." << std::endl;
+        return false;
+    }
+
+    auto outdir = OutFilepath.getVal();
+    mkdir(outdir.c_str(), 0755);
+
+    auto compiler = Compiler::Create(GetSettings(archGraph));
+    uint32_t nofInputs = inputs.size();
+    uint32_t nofWorkers = std::max(1u, std::min(Jobs.getVal(), nofInputs));
+
+    std::vector<BatchResult> results(nofInputs);
+    std::atomic<uint32_t> next(0);
+    std::vector<std::thread> workers;
+
+    for (uint32_t w = 0; w < nofWorkers; ++w) {
+        workers.push_back(std::thread([&, w]() {
+            Tracer::SetThreadName("worker " + std::to_string(w));
+
+            for (uint32_t i = next++; i < nofInputs; i = next++) {
+                results[i] = CompileBatchInput(inputs[i], outdir, *compiler);
+            }
+        }));
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::ofstream O(outdir + "/batch.stats");
+    StatsAggregate aggregate;
+    bool success = true;
+
+    for (uint32_t i = 0; i < nofInputs; ++i) {
+        auto& result = results[i];
+
+        if (result.mStatus == BatchResult::S_OK) {
+            aggregate.add(*result.mStats);
         }
 
-        if (PrintDepGraphFile.isParsed()) {
-            std::ofstream ofs(PrintDepGraphFile.getVal());
-            PrintDependencyGraph(qmod.get(), ofs);
-            ofs.close();
+        switch (result.mStatus) {
+            case BatchResult::S_OK:          O << "OK"; break;
+            case BatchResult::S_PARSE_ERROR: O << "PARSE_ERROR"; break;
+            case BatchResult::S_FAILED:      O << "FAILED"; break;
         }
 
-        CompilationSettings settings {
-            archGraph,
-            Alloc.getVal(),
-            {
-                "intrinsic_swap__",
-                "intrinsic_rev_cx__",
-                "intrinsic_lcx__",
-                "cx",
-                "u1",
-                "u2",
-                "u3",
-                "h"
-            },
-            Reorder.getVal(),
-            !NoVerify.getVal(),
-            Force.getVal()
-        };
+        O << "::" << inputs[i].mRelPath
+          << "::" << result.mParseTime
+          << "::" << result.mCompileTime
+          << "::" << result.mStmts << std::endl;
+
+        if (result.mStatus != BatchResult::S_OK) {
+            ERR << "Could not compile `" << inputs[i].mPath << "`." << std::endl;
+            success = false;
+        }
+    }
+
+    O.close();
+
+    if (ShowStats.getVal())
+        aggregate.print(std::cout, GetStatsFormat());
+
+    return success;
+}
+
+// ----------------------------------------------------------------
+// -------------------------- Cache Mode --------------------------
+// ----------------------------------------------------------------
+
+// Reads the whole file 'filepath' into 'contents'.
+static bool ReadFile(const std::string& filepath, std::string& contents) {
+    auto mapped = MappedFile::Open(filepath);
+    if (mapped.get() == nullptr) return false;
+
+    contents.assign(mapped->data(), mapped->size());
+    return true;
+}
+
+// Compiles the input file, unless the very same program was compiled before
+// with the same settings. In that case, the output (and the stats) are
+// just read from the cache.
+static bool CompileWithCache() {
+    auto cache = CompilationCache::Create(CacheDir.getVal(), (uint64_t) CacheSize.getVal() << 20);
+
+    if (cache.get() == nullptr) {
+        ERR << "Could not create the cache directory `" << CacheDir.getVal() << "`." << std::endl;
+        return false;
+    }
+
+    std::string program;
+
+    if (!ReadFile(InFilepath.getVal(), program)) {
+        ERR << "Could not read `" << InFilepath.getVal() << "`." << std::endl;
+        return false;
+    }
+
+    auto archGraph = GetArchGraph();
+    if (archGraph.get() == nullptr) return false;
+
+    // Regular files are parsed from their path, so that their includes
+    // are still found. Otherwise, they are looked for in the current directory.
+    struct stat st;
+    bool isRegular = stat(InFilepath.getVal().c_str(), &st) == 0 && S_ISREG(st.st_mode);
+
+    std::string path = "./";
+    auto lastslash = InFilepath.getVal().find_last_of('/');
+    if (isRegular && lastslash != std::string::npos) path = InFilepath.getVal().substr(0, lastslash + 1);
+
+    auto settings = GetSettings(archGraph);
+    auto key = CompilationCache::GetKey(program, settings, !NoPretty.getVal(), GetStatsFormat(), path);
+
+    CompilationCache::Entry entry;
+
+    if (!cache->lookup(key, entry)) {
+        auto context = StatsContext::Create();
+        StatsScope scope(context.get());
+
+        auto qmod = isRegular ? ParseFile(InFilepath.getVal(), ParseThreads.getVal())
+                              : QModule::ParseString(program);
+        if (qmod.get() == nullptr) return false;
 
         qmod.reset(Compile(std::move(qmod), settings).release());
+        if (qmod.get() == nullptr) return false;
+
+        std::ostringstream output, stats;
+        PrintToStream(qmod.get(), output, !NoPretty.getVal());
+        context->print(stats, GetStatsFormat());
 
-        if (qmod.get() != nullptr)
-            DumpToOutFile(qmod.get());
+        entry = CompilationCache::Entry { output.str(), stats.str() };
+        cache->store(key, entry);
     }
 
+    std::ofstream O(OutFilepath.getVal());
+    O << entry.mOutput;
+    O.close();
+
     if (ShowStats.getVal())
-        efd::PrintStats();
+        std::cout << entry.mStats;
+
+    return true;
+}
+
+// ----------------------------------------------------------------
+// -------------------------- Client Mode -------------------------
+// ----------------------------------------------------------------
+
+// Sends the input file (and the settings) to the 'efd-server' at 'ConnectPath',
+// and writes what it answered to the output file (see tools/Server.cpp).
+static bool CompileRemotely() {
+    std::string program, archGraph;
+
+    if (!ReadFile(InFilepath.getVal(), program)) {
+        ERR << "Could not read `" << InFilepath.getVal() << "`." << std::endl;
+        return false;
+    }
+
+    if (ArchFilepath.isParsed() && !ReadFile(ArchFilepath.getVal(), archGraph)) {
+        ERR << "Could not read `" << ArchFilepath.getVal() << "`." << std::endl;
+        return false;
+    }
+
+    auto settings = GetSettings(nullptr);
+    auto& options = settings.allocatorOptions;
+
+    std::ostringstream request;
+    request << "arch " << Arch.getVal().getStringValue() << "\n"
+            << "alloc " << settings.allocator.getStringValue() << "\n"
+            << "reorder " << settings.reorder << "\n"
+            << "commute " << settings.commute << "\n"
+            << "verify " << settings.verify << "\n"
+            << "force " << settings.force << "\n"
+            << "pretty " << !NoPretty.getVal() << "\n"
+            << "verify-threads " << settings.verifyThreads << "\n"
+            << "swap-cost " << options.swapCost << "\n"
+            << "rev-cost " << options.revCost << "\n"
+            << "lcx-cost " << options.lcxCost << "\n"
+            << "seed " << options.seed << "\n"
+            << "trials " << options.trials << "\n"
+            << "bsi-max-children " << options.maxChildren << "\n"
+            << "bsi-max-partial " << options.maxPartialSolutions << "\n"
+            << "basis ";
+
+    for (uint32_t i = 0, e = settings.basis.size(); i < e; ++i) {
+        request << (i ? "," : "") << settings.basis[i];
+    }
+
+    auto conn = UnixSocket::Connect(ConnectPath.getVal());
+
+    if (conn.get() == nullptr) {
+        ERR << "Could not connect to `" << ConnectPath.getVal() << "`: "
+            << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::string status, output;
+
+    if (!conn->send(request.str()) || !conn->send(archGraph) || !conn->send(program) ||
+        !conn->receive(status) || !conn->receive(output)) {
+        ERR << "Connection to `" << ConnectPath.getVal() << "` was lost." << std::endl;
+        return false;
+    }
+
+    if (status != "OK") {
+        ERR << output << std::endl;
+        return false;
+    }
+
+    std::ofstream O(OutFilepath.getVal());
+    O << output;
+    O.close();
+
+    return true;
+}
+
+// ----------------------------------------------------------------
+// -------------------------- Chunk Mode --------------------------
+// ----------------------------------------------------------------
+
+// Flattens and inlines the input 'ChunkSize' top-level statements at a time
+// (see ProcessFileInChunks), writing each chunk as soon as it is done. So,
+// the whole program is never in memory.
+static bool FlattenInChunks() {
+    std::ofstream O(OutFilepath.getVal());
+    bool pretty = !NoPretty.getVal();
+
+    // Every chunk sees all the declarations so far. Only the new ones are
+    // written, before the statements that need them.
+    uint32_t includes = 0, regs = 0;
+    std::unordered_set<std::string> gates;
+
+    auto qmod = ProcessFileInChunks(InFilepath.getVal(), ChunkSize.getVal(),
+            DefaultBasis, [&](QModule::Ref chunk) {
+        for (auto it = chunk->include_begin() + includes, e = chunk->include_end();
+                it != e; ++it, ++includes) {
+            O << (*it)->toString(pretty);
+        }
+
+        for (auto it = chunk->stmt_begin(), e = chunk->stmt_end(); it != e; ++it) {
+            auto qop = dynCast<NDQOp>(it->get());
+
+            if (auto ifstmt = dynCast<NDIfStmt>(it->get())) {
+                qop = ifstmt->getQOp();
+            }
+
+            if (qop == nullptr || !qop->isGeneric()) continue;
+
+            auto id = qop->getId()->getVal();
+            auto gate = chunk->getQGate(id);
+
+            if (!gate->isInInclude() && gates.insert(id).second) {
+                O << gate->toString(pretty);
+            }
+        }
+
+        for (auto it = chunk->reg_begin() + regs, e = chunk->reg_end();
+                it != e; ++it, ++regs) {
+            O << (*it)->toString(pretty);
+        }
+
+        for (auto it = chunk->stmt_begin(), e = chunk->stmt_end(); it != e; ++it) {
+            O << (*it)->toString(pretty);
+        }
+    });
+
+    return qmod.get() != nullptr;
+}
+
+int main(int argc, char** argv) {
+    InitializeAllQbitAllocators();
+    InitializeAllArchitectures();
+
+    ParseArguments(argc, argv);
+
+    if (ConnectPath.isParsed()) {
+        return CompileRemotely() ? 0 : 1;
+    }
+
+    if (TimePasses.getVal())
+        PassProfiler::Enable();
+
+    if (TracePath.isParsed()) {
+        Tracer::Enable();
+        Tracer::SetThreadName("main");
+    }
+
+    // Whether every input was compiled (i.e.: the exit status).
+    bool success = false;
+
+    if (ChunkSize.getVal() > 0) {
+        success = FlattenInChunks();
+
+    } else if (BatchPath.isParsed()) {
+        auto archGraph = GetArchGraph();
+        if (archGraph.get() != nullptr) success = CompileBatch(archGraph);
+
+    // The dependency graph comes from the source program, which is not cached.
+    } else if (CacheDir.isParsed() && !PrintDepGraphFile.isParsed()) {
+        success = CompileWithCache();
+
+    } else {
+        QModule::uRef qmod = ParseFile(InFilepath.getVal(), ParseThreads.getVal());
+
+        if (qmod.get() != nullptr) {
+            ArchGraph::sRef archGraph = GetArchGraph();
+
+            if (PrintDepGraphFile.isParsed()) {
+                std::ofstream ofs(PrintDepGraphFile.getVal());
+                PrintDependencyGraph(qmod.get(), ofs);
+                ofs.close();
+            }
+
+            qmod.reset(Compile(std::move(qmod), GetSettings(archGraph)).release());
+
+            if (qmod.get() != nullptr) {
+                DumpToOutFile(qmod.get());
+                success = true;
+            }
+        }
+
+        if (ShowStats.getVal())
+            efd::PrintStats(std::cout, GetStatsFormat());
+    }
+
+    if (TimePasses.getVal())
+        PassProfiler::Print();
+
+    if (TracePath.isParsed() && !Tracer::Write(TracePath.getVal())) {
+        ERR << "Could not write the trace to `" << TracePath.getVal() << "`." << std::endl;
+        success = false;
+    }
 
-    return 0;
+    return success ? 0 : 1;
 }
@@ -0,0 +1,345 @@
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Transform/QModule.h"
+#include "enfield/Transform/Driver.h"
+#include "enfield/Transform/Compiler.h"
+#include "enfield/Transform/Allocators/Allocators.h"
+#include "enfield/Arch/Architectures.h"
+#include "enfield/Support/UnixSocket.h"
+#include "enfield/Support/Stats.h"
+#include "enfield/Support/uRefCast.h"
+#include "enfield/Support/Defs.h"
+
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <csignal>
+#include <list>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include <unistd.h>
+
+// Serves compilation requests over a Unix domain socket, keeping everything
+// that does not depend on the program (architectures, the standard library
+// and the allocators' tables) in memory between them.
+//
+// Every message is length prefixed (see UnixSocket). A request is made of
+// three messages:
+//     1. the settings: one 'key value' per line (see ParseRequest);
+//     2. the architecture graph (as in '-arch-file'), or an empty message;
+//     3. the program.
+// And the answer of two:
+//     1. the status: either 'OK' or 'ERROR';
+//     2. the compiled program, or the reason it failed.
+// A connection may send any number of requests, one after the other.
+
+using namespace efd;
+
+static Opt<std::string> SocketPath
+("socket", "Path of the Unix domain socket to listen at.", "/tmp/efd.sock", false);
+static Opt<uint32_t> Jobs
+("j", "Number of connections served in parallel.",
+ std::max(1u, std::thread::hardware_concurrency()), false);
+static Opt<uint32_t> MaxArchs
+("-max-archs", "Number of architectures whose caches are kept in memory.", 16, false);
+
+namespace {
+    /// \brief The settings of one compilation request.
+    struct Request {
+        std::string mArch;
+        std::string mArchGraph;
+        std::string mAlloc;
+        std::vector<std::string> mBasis;
+        bool mReorder;
+        bool mCommute;
+        bool mVerify;
+        bool mForce;
+        bool mPretty;
+        uint32_t mVerifyThreads;
+        AllocatorOptions mOptions;
+    };
+
+    /// \brief Caches of the architectures used by the latest requests.
+    ///
+    /// Only the \em ArchCache is worth keeping: a \em Compiler is just the
+    /// settings of one request and the cache. As a request may bring its own
+    /// architecture graph, at most \em mMaxSize caches are kept, evicting the
+    /// least recently used one.
+    class ArchCachePool {
+        private:
+            typedef std::pair<std::string, ArchCache::sRef> Entry;
+
+            std::mutex mMutex;
+            uint32_t mMaxSize;
+            std::list<Entry> mEntries;
+            std::unordered_map<std::string, std::list<Entry>::iterator> mIndex;
+
+        public:
+            ArchCachePool(uint32_t maxSize);
+
+            /// \brief Returns the cache of the architecture of \p request (or
+            /// nullptr, setting \p error).
+            ArchCache::sRef get(const Request& request, std::string& error);
+    };
+
+    /// \brief Connections waiting for a worker.
+    class ConnectionQueue {
+        private:
+            std::mutex mMutex;
+            std::condition_variable mCondition;
+            std::deque<UnixSocket::uRef> mQueue;
+
+        public:
+            void push(UnixSocket::uRef conn);
+            UnixSocket::uRef pop();
+    };
+}
+
+ArchCachePool::ArchCachePool(uint32_t maxSize) : mMaxSize(std::max(1u, maxSize)) {
+}
+
+ArchCache::sRef ArchCachePool::get(const Request& request, std::string& error) {
+    auto key = request.mArchGraph.empty() ? "arch:" + request.mArch
+                                          : "graph:" + request.mArchGraph;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mIndex.find(key);
+        if (it != mIndex.end()) {
+            mEntries.splice(mEntries.begin(), mEntries, it->second);
+            return it->second->second;
+        }
+    }
+
+    ArchGraph::sRef archGraph;
+
+    if (!request.mArchGraph.empty()) {
+        archGraph = toShared(ArchGraph::ReadString(request.mArchGraph));
+    } else if (EnumArchitecture::Has(request.mArch) &&
+               HasArchitecture(EnumArchitecture(request.mArch))) {
+        archGraph = CreateArchitecture(EnumArchitecture(request.mArch));
+    }
+
+    if (archGraph.get() == nullptr || archGraph->size() == 0) {
+        error = "Architecture: " + request.mArch + " not found.";
+        return nullptr;
+    }
+
+    auto cache = ArchCache::Create(archGraph);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Another request may have created it meanwhile.
+    auto it = mIndex.find(key);
+    if (it != mIndex.end()) {
+        mEntries.splice(mEntries.begin(), mEntries, it->second);
+        return it->second->second;
+    }
+
+    mEntries.push_front(Entry(key, cache));
+    mIndex[key] = mEntries.begin();
+
+    // The requests still using an evicted cache keep it alive.
+    if (mEntries.size() > mMaxSize) {
+        mIndex.erase(mEntries.back().first);
+        mEntries.pop_back();
+    }
+
+    return cache;
+}
+
+void ConnectionQueue::push(UnixSocket::uRef conn) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueue.push_back(std::move(conn));
+    }
+
+    mCondition.notify_one();
+}
+
+UnixSocket::uRef ConnectionQueue::pop() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]() { return !mQueue.empty(); });
+
+    auto conn = std::move(mQueue.front());
+    mQueue.pop_front();
+    return conn;
+}
+
+static uint32_t ToUInt(const std::string& value) {
+    return std::strtoul(value.c_str(), nullptr, 10);
+}
+
+// Reads the 'key value' lines of the settings message. Missing keys keep
+// the same defaults as efd.
+static bool ParseRequest(const std::string& settings, Request& request, std::string& error) {
+    request = Request { "A_ibmqx2", "", "Q_dynprog", DefaultBasis, false, false, true, false, true, 1,
+                        AllocatorOptions() };
+
+    auto& options = request.mOptions;
+
+    std::istringstream in(settings);
+    std::string line;
+
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+
+        auto space = line.find(' ');
+        auto key = line.substr(0, space);
+        auto value = (space == std::string::npos) ? "" : line.substr(space + 1);
+
+        if (key == "arch") request.mArch = value;
+        else if (key == "alloc") request.mAlloc = value;
+        else if (key == "reorder") request.mReorder = (value == "1");
+        else if (key == "commute") request.mCommute = (value == "1");
+        else if (key == "verify") request.mVerify = (value == "1");
+        else if (key == "force") request.mForce = (value == "1");
+        else if (key == "pretty") request.mPretty = (value == "1");
+        else if (key == "verify-threads") request.mVerifyThreads = ToUInt(value);
+        else if (key == "swap-cost") options.swapCost = ToUInt(value);
+        else if (key == "rev-cost") options.revCost = ToUInt(value);
+        else if (key == "lcx-cost") options.lcxCost = ToUInt(value);
+        else if (key == "seed") options.seed = ToUInt(value);
+        else if (key == "trials") options.trials = ToUInt(value);
+        else if (key == "bsi-max-children") options.maxChildren = ToUInt(value);
+        else if (key == "bsi-max-partial") options.maxPartialSolutions = ToUInt(value);
+        else if (key == "basis") {
+            std::istringstream gates(value);
+            request.mBasis.clear();
+            for (std::string gate; std::getline(gates, gate, ',');) {
+                request.mBasis.push_back(gate);
+            }
+        } else {
+            error = "Unknown setting `" + key + "`.";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Compiles 'program' with the settings in 'request', setting 'output' to
+// either the compiled program or the error. The stats of each request are
+// collected apart, so that concurrent requests do not mix them.
+static bool Compile(ArchCachePool& pool, const Request& request,
+                    const std::string& program, std::string& output) {
+    auto context = StatsContext::Create();
+    StatsScope scope(context.get());
+
+    if (!EnumAllocator::Has(request.mAlloc) ||
+        !HasAllocator(EnumAllocator(request.mAlloc))) {
+        output = "Allocator: " + request.mAlloc + " not found.";
+        return false;
+    }
+
+    auto cache = pool.get(request, output);
+    if (cache.get() == nullptr) return false;
+
+    CompilationSettings settings {
+        cache->getArchGraph(),
+        EnumAllocator(request.mAlloc),
+        request.mBasis,
+        request.mReorder,
+        request.mVerify,
+        request.mForce,
+        request.mVerifyThreads,
+        request.mOptions,
+        request.mCommute
+    };
+
+    auto compiler = Compiler::Create(settings, cache);
+
+    auto qmod = QModule::ParseString(program);
+
+    if (qmod.get() == nullptr) {
+        output = "Could not parse the program.";
+        return false;
+    }
+
+    if (!compiler->compile(qmod.get())) {
+        output = "Compilation failed.";
+        return false;
+    }
+
+    std::ostringstream ss;
+    PrintToStream(qmod.get(), ss, request.mPretty);
+    output = ss.str();
+    return true;
+}
+
+static void Serve(UnixSocket::Ref conn, ArchCachePool& pool) {
+    std::string settings, archGraph, program;
+
+    while (conn->receive(settings) && conn->receive(archGraph) && conn->receive(program)) {
+        Request request;
+        std::string output;
+
+        bool success = ParseRequest(settings, request, output);
+
+        if (success) {
+            request.mArchGraph = archGraph;
+            success = Compile(pool, request, program, output);
+        }
+
+        if (!conn->send(success ? "OK" : "ERROR") || !conn->send(output)) {
+            break;
+        }
+    }
+}
+
+// Removes the socket file before leaving.
+static char SocketFile[4096];
+
+static void HandleSignal(int) {
+    unlink(SocketFile);
+    _exit(0);
+}
+
+int main(int argc, char** argv) {
+    InitializeAllQbitAllocators();
+    InitializeAllArchitectures();
+
+    ParseArguments(argc, argv);
+
+    auto listener = UnixSocket::Listen(SocketPath.getVal());
+
+    if (listener.get() == nullptr) {
+        ERR << "Could not listen at `" << SocketPath.getVal() << "`: "
+            << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    std::strncpy(SocketFile, SocketPath.getVal().c_str(), sizeof(SocketFile) - 1);
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+
+    ArchCachePool pool(MaxArchs.getVal());
+    ConnectionQueue queue;
+    std::vector<std::thread> workers;
+
+    for (uint32_t i = 0, e = std::max(1u, Jobs.getVal()); i < e; ++i) {
+        workers.push_back(std::thread([&]() {
+            while (true) {
+                auto conn = queue.pop();
+                Serve(conn.get(), pool);
+            }
+        }));
+    }
+
+    while (true) {
+        auto conn = listener->accept();
+
+        if (conn.get() == nullptr) {
+            ERR << "Could not accept connection: " << std::strerror(errno) << std::endl;
+            continue;
+        }
+
+        queue.push(std::move(conn));
+    }
+
+    return 0;
+}